@@ -11,10 +11,15 @@
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_BEpsilonTreeReaderWriter.h"
+#include "MyDB_ConcurrentBPlusTreeReaderWriter.h"
 #include "MyDB_Schema.h"
 #include "QUnit.h"
 #include "Sorting.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 int main () {
 
@@ -93,6 +98,405 @@ int main () {
 			}
 		}
 	}
+
+	{
+		// build the same tree twice: once a record at a time, and once with a bulk load
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter heapTable (make_shared <MyDB_Table> ("heap", "heap.bin", mySchema), myMgr);
+		heapTable.loadFromTextFile ("supplierBig.tbl");
+
+		MyDB_BPlusTreeReaderWriter appended ("suppkey", make_shared <MyDB_Table> ("appended", "appended.bin", mySchema), myMgr);
+		MyDB_BPlusTreeReaderWriter bulk ("suppkey", make_shared <MyDB_Table> ("bulk", "bulk.bin", mySchema), myMgr);
+
+		auto start = chrono :: steady_clock :: now ();
+		MyDB_RecordPtr temp = heapTable.getEmptyRecord ();
+		MyDB_RecordIteratorAltPtr myIter = heapTable.getIteratorAlt ();
+		while (myIter->advance ()) {
+			myIter->getCurrent (temp);
+			appended.append (temp);
+		}
+		auto middle = chrono :: steady_clock :: now ();
+		bulk.bulkLoad (heapTable, 64, 0.7);
+		auto end = chrono :: steady_clock :: now ();
+		cout << "appends took " << chrono :: duration <double> (middle - start).count () << " secs; bulk load took " 
+			<< chrono :: duration <double> (end - middle).count () << " secs\n";
+
+		// the records in both trees come back in order, just by walking the chain of leaves
+		MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal> ();
+		low->set (0);
+		MyDB_IntAttValPtr high = make_shared <MyDB_IntAttVal> ();
+		high->set (10000);
+		for (MyDB_BPlusTreeReaderWriter *tree : {&appended, &bulk}) {
+			myIter = tree->getSortedRangeIteratorAlt (low, high);
+			int counter = 0;
+			int last = -1;
+			bool inOrder = true;
+			while (myIter->advance ()) {
+				myIter->getCurrent (temp);
+				if (temp->getAtt (0)->toInt () < last)
+					inOrder = false;
+				last = temp->getAtt (0)->toInt ();
+				counter++;
+			}
+			QUNIT_IS_EQUAL (counter, 320000);
+			QUNIT_IS_TRUE (inOrder);
+		}
+
+		// the two trees answer range queries the same way, before and after more records are appended
+		for (int time = 0; time < 2; time++) {
+			for (int i = 0; i < 50; i++) {
+				srand48 (i);
+				int lowBound = lrand48 () % 10000;
+				int highBound = lowBound + lrand48 () % 100;
+				low->set (lowBound);
+				high->set (highBound);
+
+				int counts[2] = {0, 0};
+				MyDB_BPlusTreeReaderWriter *trees[2] = {&appended, &bulk};
+				for (int which = 0; which < 2; which++) {
+					myIter = trees[which]->getRangeIteratorAlt (low, high);
+					while (myIter->advance ()) 
+						counts[which]++;
+				}
+				QUNIT_IS_EQUAL (counts[0], counts[1]);
+				QUNIT_IS_EQUAL (counts[1], (32 + time) * (highBound - lowBound + 1));
+			}
+
+			if (time == 0) {
+				for (int i = 0; i < 10000; i++) {
+					temp->getAtt (0)->fromInt (i);
+					temp->recordContentHasChanged ();
+					appended.append (temp);
+					bulk.append (temp);
+				}
+			}
+		}
+
+		// point lookups find every record with the key, and nothing for a key that is not there
+		MyDB_IntAttValPtr key = make_shared <MyDB_IntAttVal> ();
+		int numRight = 0;
+		auto start2 = chrono :: steady_clock :: now ();
+		for (int i = 0; i < 10000; i++) {
+			srand48 (i);
+			int whichKey = lrand48 () % 10002 - 1;
+			key->set (whichKey);
+			vector <char> found;
+			size_t numFound = bulk.lookup (key, found);
+			bool allMatch = true;
+			for (char *rec = found.data (); rec != found.data () + found.size (); rec += *((short *) rec)) {
+				temp->fromBinary (rec);
+				allMatch = allMatch && temp->getAtt (0)->toInt () == whichKey;
+			}
+			size_t numExpected = (whichKey < 0 || whichKey >= 10000) ? 0 : 33;
+			if (allMatch && numFound == numExpected && bulk.contains (key) == (numExpected != 0) && 
+				appended.lookup (key, found) == numExpected)
+				numRight++;
+		}
+		auto end2 = chrono :: steady_clock :: now ();
+		cout << "10000 lookups took " << chrono :: duration <double> (end2 - start2).count () << " secs\n";
+		QUNIT_IS_EQUAL (numRight, 10000);
+	}
+
+	{
+		// appends and range scans on a concurrent tree, from several threads at once; the pages are small, so
+		// that there are lots of splits, and the buffer is too small for the whole tree
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (4096, 256, "tempFile", true);
+		MyDB_ConcurrentBPlusTreeReaderWriter tree ("suppkey", make_shared <MyDB_Table> ("concurrent", "concurrent.bin", 
+			mySchema), myMgr);
+
+		auto makeRecord = [&] () {
+			MyDB_RecordPtr rec = tree.getEmptyRecord ();
+			vector <string> atts {"0", "Supplier#000000000", "some address", "7", "12-345-678-9012", "1234.56", 
+				"a comment that makes the record a bit longer"};
+			for (size_t i = 0; i < atts.size (); i++)
+				rec->getAtt (i)->fromString (atts[i]);
+			return rec;
+		};
+		auto setKey = [] (MyDB_RecordPtr rec, int key) {
+			rec->getAtt (0)->fromInt (key);
+			rec->recordContentHasChanged ();
+		};
+
+		// the even keys are all there, twice, before anything else starts
+		MyDB_RecordPtr temp = makeRecord ();
+		for (int time = 0; time < 2; time++) {
+			for (int i = 0; i < 10000; i += 2) {
+				setKey (temp, i);
+				tree.append (temp);
+			}
+		}
+
+		// the writers append odd keys, while the readers check that each of the even keys is seen just as
+		// many times as it should be, and that everything comes back in order
+		atomic <int> numBadScans (0), numBadLookups (0);
+		vector <thread> threads;
+		for (int t = 0; t < 4; t++) {
+			threads.push_back (thread ([&, t] {
+				MyDB_RecordPtr rec = makeRecord ();
+				srand48 (t);
+				for (int i = 0; i < 5000; i++) {
+					setKey (rec, 2 * (lrand48 () % 5000) + 1);
+					tree.append (rec);
+				}
+			}));
+			threads.push_back (thread ([&, t] {
+				MyDB_RecordPtr rec = makeRecord ();
+				MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal> ();
+				MyDB_IntAttValPtr high = make_shared <MyDB_IntAttVal> ();
+				srand48 (100 + t);
+				for (int i = 0; i < 200; i++) {
+					int lowBound = lrand48 () % 10000;
+					int highBound = lowBound + lrand48 () % 500;
+					low->set (lowBound);
+					high->set (highBound);
+					MyDB_RecordIteratorAltPtr myIter = tree.getSortedRangeIteratorAlt (low, high);
+					int numEven = 0, last = lowBound;
+					bool good = true;
+					while (myIter->advance ()) {
+						myIter->getCurrent (rec);
+						int key = rec->getAtt (0)->toInt ();
+						good = good && key >= last && key <= highBound;
+						last = key;
+						numEven += key % 2 == 0;
+					}
+					int expected = 0;
+					for (int key = lowBound; key <= highBound && key < 10000; key++)
+						expected += key % 2 == 0 ? 2 : 0;
+					if (!good || numEven != expected)
+						numBadScans++;
+
+					vector <char> found;
+					low->set (lowBound - lowBound % 2);
+					if (tree.lookup (low, found) != 2 || !tree.contains (low))
+						numBadLookups++;
+				}
+			}));
+		}
+		for (thread &t : threads)
+			t.join ();
+		cout << "the concurrent tree had to start over " << tree.getNumRestarts () << " times\n";
+		QUNIT_IS_EQUAL (numBadScans, 0);
+		QUNIT_IS_EQUAL (numBadLookups, 0);
+
+		// afterward, the tree is well formed, and has all of the records
+		size_t numRecs;
+		QUNIT_IS_TRUE (tree.checkInvariants (numRecs));
+		QUNIT_IS_EQUAL (numRecs, 30000);
+
+		MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal> ();
+		low->set (0);
+		MyDB_IntAttValPtr high = make_shared <MyDB_IntAttVal> ();
+		high->set (10000);
+		MyDB_RecordIteratorAltPtr myIter = tree.getSortedRangeIteratorAlt (low, high);
+		int counter = 0;
+		while (myIter->advance ())
+			counter++;
+		QUNIT_IS_EQUAL (counter, 30000);
+	}
+
+	{
+		// trees on a string key, where the separators are cut down and each directory page takes off the prefix
+		// that its keys share; the pages are small, so that the directory has a few levels
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (4096, 256, "tempFile");
+		MyDB_TableReaderWriter heapTable (make_shared <MyDB_Table> ("heap", "heap.bin", mySchema), myMgr);
+		heapTable.loadFromTextFile ("supplierBig.tbl");
+
+		MyDB_BPlusTreeReaderWriter appended ("name", make_shared <MyDB_Table> ("nameAppended", "nameAppended.bin", 
+			mySchema), myMgr);
+		MyDB_BPlusTreeReaderWriter bulk ("name", make_shared <MyDB_Table> ("nameBulk", "nameBulk.bin", mySchema), myMgr);
+		MyDB_RecordPtr temp = heapTable.getEmptyRecord ();
+		MyDB_RecordIteratorAltPtr myIter = heapTable.getIteratorAlt ();
+		while (myIter->advance ()) {
+			myIter->getCurrent (temp);
+			appended.append (temp);
+		}
+		bulk.bulkLoad (heapTable, 64, 0.7);
+
+		// a full-length key with two bytes of length takes 29 bytes in an internal node record, so no more than
+		// 140 of them fit on a page; the compressed directory pages hold more than that
+		const char *names[2] = {"appended", "bulk loaded"};
+		MyDB_BPlusTreeReaderWriter *trees[2] = {&appended, &bulk};
+		for (int which = 0; which < 2; which++) {
+			int height;
+			size_t numDirPages;
+			double fanOut;
+			trees[which]->getShape (height, numDirPages, fanOut);
+			cout << "the " << names[which] << " tree on name has height " << height << ", with " << numDirPages 
+				<< " directory pages and a fan-out of " << fanOut << "\n";
+			QUNIT_IS_TRUE (fanOut > 140);
+		}
+
+		// the trees find the same records as before: range scans come back in order, and lookups of a key that
+		// is only a prefix of the names (which is what a separator can be) find nothing
+		auto name = [] (int i) {
+			char buf[32];
+			sprintf (buf, "Supplier#%09d", i);
+			return string (buf);
+		};
+		MyDB_StringAttValPtr low = make_shared <MyDB_StringAttVal> ();
+		MyDB_StringAttValPtr high = make_shared <MyDB_StringAttVal> ();
+		int numRight = 0;
+		for (int i = 0; i < 100; i++) {
+			srand48 (i);
+			int lowBound = lrand48 () % 10000;
+			int highBound = lowBound + lrand48 () % 100;
+			low->set (name (lowBound));
+			high->set (name (highBound));
+			for (MyDB_BPlusTreeReaderWriter *tree : trees) {
+				myIter = tree->getSortedRangeIteratorAlt (low, high);
+				int counter = 0;
+				string last;
+				bool inOrder = true;
+				while (myIter->advance ()) {
+					myIter->getCurrent (temp);
+					inOrder = inOrder && last <= temp->getAtt (1)->toString ();
+					last = temp->getAtt (1)->toString ();
+					counter++;
+				}
+
+				vector <char> found;
+				low->set (name (lowBound).substr (0, 16));
+				bool prefixFound = tree->contains (low);
+				low->set (name (lowBound));
+				if (inOrder && counter == 32 * (min (highBound, 9999) - lowBound + 1) && !prefixFound && 
+					tree->lookup (low, found) == 32)
+					numRight++;
+			}
+		}
+		QUNIT_IS_EQUAL (numRight, 200);
+	}
+
+	{
+		// appends in random order to a B+-Tree and to a B-epsilon tree, each ten times the size of its buffer; the
+		// B-epsilon tree writes its pages a batch of records at a time, so it should do much less I/O
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		MyDB_BufferManagerPtr heapMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter heapTable (make_shared <MyDB_Table> ("heap", "heap.bin", mySchema), heapMgr);
+		heapTable.loadFromTextFile ("supplierBig.tbl");
+
+		MyDB_BufferManagerPtr bplusMgr = make_shared <MyDB_BufferManager> (4096, 1024, "tempFile");
+		MyDB_BPlusTreeReaderWriter bplus ("suppkey", make_shared <MyDB_Table> ("bplus", "bplus.bin", mySchema), bplusMgr);
+		MyDB_BufferManagerPtr bepsMgr = make_shared <MyDB_BufferManager> (4096, 1024, "tempFile");
+		MyDB_BEpsilonTreeReaderWriter beps ("suppkey", make_shared <MyDB_Table> ("beps", "beps.bin", mySchema, 
+			"bepsilontree", "suppkey"), bepsMgr);
+
+		MyDB_RecordPtr temp = heapTable.getEmptyRecord ();
+		MyDB_BPlusTreeReaderWriter *trees[2] = {&bplus, &beps};
+		MyDB_BufferManagerPtr mgrs[2] = {bplusMgr, bepsMgr};
+		const char *names[2] = {"B+-Tree", "B-epsilon tree"};
+		size_t numIOs[2];
+		for (int which = 0; which < 2; which++) {
+			auto start = chrono :: steady_clock :: now ();
+			MyDB_RecordIteratorAltPtr myIter = heapTable.getIteratorAlt ();
+			while (myIter->advance ()) {
+				myIter->getCurrent (temp);
+				trees[which]->append (temp);
+			}
+			auto end = chrono :: steady_clock :: now ();
+			double secs = chrono :: duration <double> (end - start).count ();
+			numIOs[which] = mgrs[which]->getNumReads () + mgrs[which]->getNumWrites ();
+			cout << "the " << names[which] << " took " << 320000 / secs << " appends/sec, over " 
+				<< trees[which]->getNumPages () << " pages, with " << mgrs[which]->getNumReads () << " reads and " 
+				<< mgrs[which]->getNumWrites () << " writes\n";
+		}
+		QUNIT_IS_TRUE (numIOs[1] < numIOs[0]);
+
+		// all of the records are there, whether they are in a leaf or still in a buffer
+		MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal> ();
+		MyDB_IntAttValPtr high = make_shared <MyDB_IntAttVal> ();
+		low->set (0);
+		high->set (10000);
+		MyDB_RecordIteratorAltPtr myIter = beps.getSortedRangeIteratorAlt (low, high);
+		int counter = 0, last = -1;
+		bool inOrder = true;
+		while (myIter->advance ()) {
+			myIter->getCurrent (temp);
+			inOrder = inOrder && temp->getAtt (0)->toInt () >= last;
+			last = temp->getAtt (0)->toInt ();
+			counter++;
+		}
+		QUNIT_IS_EQUAL (counter, 320000);
+		QUNIT_IS_TRUE (inOrder);
+
+		counter = 0;
+		myIter = beps.getIteratorAlt ();
+		while (myIter->advance ())
+			counter++;
+		QUNIT_IS_EQUAL (counter, 320000);
+
+		// and the two trees answer range queries and lookups the same way
+		int numRight = 0;
+		for (int i = 0; i < 100; i++) {
+			srand48 (i);
+			int lowBound = lrand48 () % 10000;
+			int highBound = lowBound + lrand48 () % 100;
+			low->set (lowBound);
+			high->set (highBound);
+
+			int counts[2] = {0, 0};
+			for (int which = 0; which < 2; which++) {
+				myIter = trees[which]->getRangeIteratorAlt (low, high);
+				while (myIter->advance ()) 
+					counts[which]++;
+			}
+
+			// getRangePages (which is how a BPlusSelection finds its records) includes the buffers
+			int numOnPages = 0;
+			function <bool ()> inRange = beps.buildRangeCheck (temp, low, high);
+			for (MyDB_PageReaderWriter &page : beps.getRangePages (low, high)) {
+				MyDB_RecordIteratorAltPtr pageIter = page.getIteratorAlt ();
+				while (pageIter->advance ()) {
+					pageIter->getCurrent (temp);
+					numOnPages += inRange ();
+				}
+			}
+
+			vector <char> found;
+			low->set (lowBound);
+			int expected = 32 * (min (highBound, 9999) - lowBound + 1);
+			if (counts[0] == expected && counts[1] == expected && numOnPages == expected && 
+				beps.lookup (low, found) == 32 && beps.contains (low))
+				numRight++;
+		}
+		QUNIT_IS_EQUAL (numRight, 100);
+		low->set (10000);
+		QUNIT_IS_TRUE (!beps.contains (low));
+	}
 }
 
 #endif
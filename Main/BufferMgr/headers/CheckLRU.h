@@ -17,7 +17,7 @@
 class CheckLRU {
 
 public:
-	bool operator() (const MyDB_PagePtr lhs, const MyDB_PagePtr rhs) const {
+	bool operator() (const MyDB_PagePtr &lhs, const MyDB_PagePtr &rhs) const {
 		return lhs->timeTick < rhs->timeTick;
 	}
 };
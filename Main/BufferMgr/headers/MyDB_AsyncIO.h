@@ -0,0 +1,63 @@
+
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sys/types.h>
+#include <thread>
+
+using namespace std;
+
+// a background thread that reads and writes pages for the buffer manager, so that it can keep going while
+// the disk works.  Requests are done one at a time, in the order that they are made; each one gets a ticket,
+// and waitFor (ticket) returns once that request (and so every request before it) is done.  Only the
+// syscalls are done by the background thread; all of the buffer manager's bookkeeping stays with its caller
+class MyDB_AsyncIO {
+
+public:
+
+	MyDB_AsyncIO ();
+
+	// waits for all of the requests to be done, and then stops the background thread
+	~MyDB_AsyncIO ();
+
+	// reads (or writes) len bytes at the given offset in the file, into (or out of) the given memory, which
+	// must not be touched until the request is done; returns the ticket for the request
+	size_t read (int fd, void *bytes, size_t len, off_t offset);
+	size_t write (int fd, void *bytes, size_t len, off_t offset);
+
+	// waits until the request with the given ticket is done
+	void waitFor (size_t ticket);
+
+	// waits until all of the requests made so far are done
+	void waitForAll ();
+
+private:
+
+	struct Request {
+		bool isWrite;
+		int fd;
+		void *bytes;
+		size_t len;
+		off_t offset;
+	};
+
+	size_t submit (Request request);
+	void run ();
+
+	// these are all protected by lock
+	mutex lock;
+	condition_variable requestReady;
+	condition_variable requestDone;
+	deque <Request> requests;
+	size_t lastTicket;
+	size_t doneTicket;
+	bool done;
+
+	// the thread is started when the first request is made
+	thread worker;
+};
+
+#endif
@@ -15,10 +15,12 @@
 
 #include "CheckLRU.h"
 #include <map>
+#include "MyDB_AsyncIO.h"
 #include <memory>
 #include "MyDB_Page.h"
 #include "MyDB_PageHandle.h"
 #include "MyDB_Table.h"
+#include <mutex>
 #include "PageCompare.h"
 #include <queue>
 #include "TableCompare.h"
@@ -58,11 +60,24 @@ public:
 	// un-pins the specified page
 	void unpin (MyDB_PagePtr unpinMe);
 
+	// starts reading the specified page in the background, if it is not buffered, so that it is (or soon
+	// will be) there when it is accessed.  This is only a hint: it does nothing if a quarter of the buffer
+	// is already taken up by pages that were read ahead and have not yet been accessed
+	void prefetch (MyDB_PagePtr readMe);
+
+	// starts writing the specified page back in the background, if it is dirty, so that it is clean by the
+	// time that it is kicked out.  The page must not be written to again until it has been accessed
+	void writeBehind (MyDB_PagePtr writeMe);
+
 	// creates an LRU buffer manager... params are as follows:
 	// 1) the size of each page is pageSize 
 	// 2) the number of pages managed by the buffer manager is numPages;
 	// 3) temporary pages are written to the file tempFile
-	MyDB_BufferManager (size_t pageSize, size_t numPages, string tempFile);
+	// 4) if threadSafe is true, then the buffer manager (and the pages and handles that it gives out)
+	//    can be used by several threads at once; each call holds a lock while it runs.  Note that the
+	//    address returned by getBytes () on a page that is not pinned can be made no good by another
+	//    thread at any time, so threads that share a buffer manager should only ever use pinned pages
+	MyDB_BufferManager (size_t pageSize, size_t numPages, string tempFile, bool threadSafe = false);
 	
 	// when the buffer manager is destroyed, all of the dirty pages need to be
 	// written back to disk, and any temporary files need to be deleted
@@ -70,6 +85,14 @@ public:
 
 	// returns the page size
 	size_t getPageSize ();
+
+	// returns true if the buffer manager can be used by several threads at once
+	bool isThreadSafe ();
+
+	// the number of pages read from and written to files so far, counting the ones read ahead and
+	// written behind
+	size_t getNumReads ();
+	size_t getNumWrites ();
 	
 	// kills the indicated table, so that no pages will ever be written back to it
 	// also removes the physical file from disk, and gets rid of the FD
@@ -107,8 +130,24 @@ private:
 	// the number of buffer pages
 	size_t numPages;
 
+	// the number of pages that have been read ahead, but not yet accessed
+	size_t numPrefetched;
+
+	// the number of pages read and written so far
+	size_t numReads;
+	size_t numWrites;
+
+	// does the reads and writes started by prefetch and writeBehind
+	MyDB_AsyncIO asyncIO;
+
+	// if the buffer manager is thread safe, this is held by each call into it (and into its pages); it
+	// is recursive, since some calls make others
+	bool threadSafe;
+	recursive_mutex bufferLock;
+
 	// so that the page can access these private methods
 	friend class MyDB_Page;
+	friend class MyDB_BufferGuard;
 	friend class SortMergeJoin;
 
 	// kick out the LRU page
@@ -120,6 +159,31 @@ private:
 	// removes all traces of the page from the buffer manager
 	void killPage (MyDB_PagePtr killMe);
 
+	// waits for any background read or write of the page to finish; if the page had been read ahead, it
+	// no longer counts as such
+	void finishIO (MyDB_PagePtr page);
+
+};
+
+// holds the lock of the buffer manager for as long as it exists, if the buffer manager is thread safe
+class MyDB_BufferGuard {
+
+public:
+
+	MyDB_BufferGuard (MyDB_BufferManager &mgr) {
+		lock = mgr.threadSafe ? &mgr.bufferLock : nullptr;
+		if (lock != nullptr)
+			lock->lock ();
+	}
+
+	~MyDB_BufferGuard () {
+		if (lock != nullptr)
+			lock->unlock ();
+	}
+
+private:
+
+	recursive_mutex *lock;
 };
 
 #endif
@@ -34,6 +34,10 @@ public:
 	// let the page know that we have written to the bytes
 	void wroteBytes ();
 
+	// start reading the page in, or writing it back, in the background
+	void prefetch (MyDB_PagePtr me);
+	void writeBehind (MyDB_PagePtr me);
+
 	// there are no more references to this page when this is called...
 	// if the page owns any RAM, it should give it back to the parent
 	// buffer manager
@@ -48,17 +52,10 @@ public:
 	void setBytes (void *bytes, size_t numBytes);
 
 	// decrements the ref count
-	inline void decRefCount (MyDB_PagePtr me) {
-		refCount--;
-		if (refCount == 0) {
-			killpage (me);
-		}
-	}
+	void decRefCount (MyDB_PagePtr me);
 
 	// increments the ref count
-	inline void incRefCount () {
-		refCount++;
-	}
+	void incRefCount ();
 
 	// get the parent
 	MyDB_BufferManager& getParent ();
@@ -94,6 +91,11 @@ private:
 	// the number of references
 	int refCount;
 
+	// the ticket for the background read or write of this page (zero if there is none), and whether
+	// the page was read ahead and has not been accessed since
+	size_t ioTicket;
+	bool prefetched;
+
 	// kill the page
 	void killpage (MyDB_PagePtr me);
 };
@@ -40,6 +40,16 @@ public:
 		page->wroteBytes ();
 	}
 
+	// hints to the buffer manager that the page will soon be read, or that it will not be written
+	// again for a while; see MyDB_BufferManager :: prefetch and writeBehind
+	void prefetch () {
+		page->prefetch (page);
+	}
+
+	void writeBehind () {
+		page->writeBehind (page);
+	}
+
 	// There are no more references to the handle when this is called...
 	// this should decrmeent a reference count to the number of handles
 	// to the particular page that it references.  If the number of 
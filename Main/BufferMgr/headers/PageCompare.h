@@ -22,15 +22,13 @@ public:
 
 	bool operator() (const pair <MyDB_TablePtr, size_t>& lhs, const pair <MyDB_TablePtr, size_t>& rhs) const {
 
-		TableCompare temp;
-		if (temp (lhs.first, rhs.first))
-			return true;
-
-		if (temp (rhs.first, lhs.first))
-			return false;
+		// the page numbers are compared first, since that is cheap and usually settles it
+		if (lhs.second != rhs.second)
+			return lhs.second < rhs.second;
 
-		// in this case, the tables are the same
-		return lhs.second < rhs.second;
+		// in this case, the page numbers are the same
+		TableCompare temp;
+		return temp (lhs.first, rhs.first);
 	}
 };
 
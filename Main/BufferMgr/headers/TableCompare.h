@@ -19,7 +19,7 @@ struct TableCompare {
 
 public:
 
-	bool operator() (const MyDB_TablePtr lhs, const MyDB_TablePtr rhs) const {
+	bool operator() (const MyDB_TablePtr &lhs, const MyDB_TablePtr &rhs) const {
 
 		// deal with the null case
 		if (lhs == nullptr && rhs != nullptr) {
@@ -0,0 +1,92 @@
+
+#ifndef ASYNC_IO_C
+#define ASYNC_IO_C
+
+#include <iostream>
+#include "MyDB_AsyncIO.h"
+#include <unistd.h>
+
+using namespace std;
+
+MyDB_AsyncIO :: MyDB_AsyncIO () {
+	lastTicket = 0;
+	doneTicket = 0;
+	done = false;
+}
+
+MyDB_AsyncIO :: ~MyDB_AsyncIO () {
+	if (!worker.joinable ())
+		return;
+
+	{
+		lock_guard <mutex> guard (lock);
+		done = true;
+	}
+	requestReady.notify_one ();
+	worker.join ();
+}
+
+size_t MyDB_AsyncIO :: read (int fd, void *bytes, size_t len, off_t offset) {
+	return submit ({false, fd, bytes, len, offset});
+}
+
+size_t MyDB_AsyncIO :: write (int fd, void *bytes, size_t len, off_t offset) {
+	return submit ({true, fd, bytes, len, offset});
+}
+
+size_t MyDB_AsyncIO :: submit (Request request) {
+
+	if (!worker.joinable ())
+		worker = thread (&MyDB_AsyncIO :: run, this);
+
+	size_t ticket;
+	{
+		lock_guard <mutex> guard (lock);
+		requests.push_back (request);
+		ticket = ++lastTicket;
+	}
+	requestReady.notify_one ();
+	return ticket;
+}
+
+void MyDB_AsyncIO :: waitFor (size_t ticket) {
+	unique_lock <mutex> guard (lock);
+	requestDone.wait (guard, [&] {return doneTicket >= ticket;});
+}
+
+void MyDB_AsyncIO :: waitForAll () {
+	unique_lock <mutex> guard (lock);
+	requestDone.wait (guard, [&] {return doneTicket == lastTicket;});
+}
+
+void MyDB_AsyncIO :: run () {
+
+	while (true) {
+
+		// get the next request; the queue is drained before the thread stops
+		Request next;
+		{
+			unique_lock <mutex> guard (lock);
+			requestReady.wait (guard, [&] {return done || !requests.empty ();});
+			if (requests.empty ())
+				return;
+			next = requests.front ();
+		}
+
+		// pread and pwrite do not use the offset of the file, so the buffer manager can keep using the
+		// same file descriptors while this runs
+		ssize_t res = next.isWrite ? pwrite (next.fd, next.bytes, next.len, next.offset) :
+			pread (next.fd, next.bytes, next.len, next.offset);
+		if (res < 0)
+			cout << "Background " << (next.isWrite ? "write" : "read") << " of a page failed.\n";
+
+		{
+			lock_guard <mutex> guard (lock);
+			requests.pop_front ();
+			doneTicket++;
+		}
+		requestDone.notify_all ();
+	}
+}
+
+#endif
@@ -28,7 +28,22 @@ size_t MyDB_BufferManager :: getPageSize () {
 	return pageSize;
 }
 
+bool MyDB_BufferManager :: isThreadSafe () {
+	return threadSafe;
+}
+
+size_t MyDB_BufferManager :: getNumReads () {
+	MyDB_BufferGuard guard (*this);
+	return numReads;
+}
+
+size_t MyDB_BufferManager :: getNumWrites () {
+	MyDB_BufferGuard guard (*this);
+	return numWrites;
+}
+
 MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i) {
+	MyDB_BufferGuard guard (*this);
 		
 	// open the file, if it is not open
 	if (fds.count (whichTable) == 0) {
@@ -43,8 +58,9 @@ MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i)
 	}
 	
 	// next, see if the page is already in existence
-	pair <MyDB_TablePtr, long> whichPage = make_pair (whichTable, i);
-	if (allPages.count (whichPage) == 0) {
+	pair <MyDB_TablePtr, size_t> whichPage = make_pair (whichTable, i);
+	auto found = allPages.find (whichPage);
+	if (found == allPages.end ()) {
 
 		// it is not there, so create a page
 		MyDB_PagePtr returnVal = make_shared <MyDB_Page> (whichTable, i, *this);
@@ -53,10 +69,11 @@ MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i)
 	}
 
 	// it is there, so return it
-	return make_shared <MyDB_PageHandleBase> (allPages [whichPage]);
+	return make_shared <MyDB_PageHandleBase> (found->second);
 }
 
 MyDB_PageHandle MyDB_BufferManager :: getPage () {
+	MyDB_BufferGuard guard (*this);
 
 	// open the file, if it is not open
 	if (fds.count (nullptr) == 0) {
@@ -86,6 +103,9 @@ void MyDB_BufferManager :: kickOutPage () {
 	if (lastUsed.size () == 0)
 		cout << "Bad: all buffer memory is exhausted!";
 
+	// its RAM cannot be reused while it is being read or written in the background
+	finishIO (page);
+
 	// make sure we don't have a null pointer
 	if (page->bytes == nullptr) {
 		cout << "Bad!! Kicking out a page with no RAM.";
@@ -97,6 +117,7 @@ void MyDB_BufferManager :: kickOutPage () {
 		if (fds.count (page->myTable) > 0) {
 			lseek (fds[page->myTable], page->pos * pageSize, SEEK_SET);
 			write (fds[page->myTable], page->bytes, pageSize);
+			numWrites++;
 		}
 		page->isDirty = false;
 	}
@@ -115,6 +136,8 @@ void MyDB_BufferManager :: kickOutPage () {
 
 void MyDB_BufferManager :: killPage (MyDB_PagePtr killMe) {
 	
+	// neither its RAM nor its spot in the temp file can be reused while it is being read or written
+	finishIO (killMe);
 
 	// if this is an anon page...
 	if (killMe->myTable == nullptr) {
@@ -145,6 +168,9 @@ void MyDB_BufferManager :: killPage (MyDB_PagePtr killMe) {
 
 void MyDB_BufferManager :: access (MyDB_PagePtr updateMe) {
 	
+	// if the page is being read or written in the background, wait for that to finish
+	finishIO (updateMe);
+
 	// if this page was just accessed, get outta here
 	if (updateMe->timeTick > lastTimeTick - (numPages / 2) && updateMe->bytes != nullptr) {
 		return;
@@ -180,6 +206,7 @@ void MyDB_BufferManager :: access (MyDB_PagePtr updateMe) {
 		if (fds.count (updateMe->myTable) > 0) {
 			lseek (fds[updateMe->myTable], updateMe->pos * pageSize, SEEK_SET);
 			read (fds[updateMe->myTable], updateMe->bytes, pageSize);
+			numReads++;
 		} else {
 			cout << "Trying to read a page from a file that does not exist.\n";
 		}
@@ -190,6 +217,7 @@ void MyDB_BufferManager :: access (MyDB_PagePtr updateMe) {
 }
 
 MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, long i) {
+	MyDB_BufferGuard guard (*this);
 
 	// open the file, if it is not open
 	if (fds.count (whichTable) == 0) {
@@ -204,11 +232,12 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, l
 	}
 
 	// first, see if the page is there in the buffer
-	pair <MyDB_TablePtr, long> whichPage = make_pair (whichTable, i);
+	pair <MyDB_TablePtr, size_t> whichPage = make_pair (whichTable, i);
 	MyDB_PagePtr returnVal;
 
 	// see if we already know him
-	if (allPages.count (whichPage) == 0) {
+	auto found = allPages.find (whichPage);
+	if (found == allPages.end ()) {
 
 		// in this case, we do not
 		returnVal = make_shared <MyDB_Page> (whichTable, i, *this);
@@ -218,7 +247,8 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, l
 	} else {
 
 		// get him out of the LRU list if he is there
-		returnVal = allPages [whichPage];
+		returnVal = found->second;
+		finishIO (returnVal);
 		if (lastUsed.count (returnVal) != 0) {
 			auto page = *(lastUsed.find (returnVal));
 	       		lastUsed.erase (page);
@@ -245,6 +275,7 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, l
 		if (fds.count (returnVal->myTable) > 0) {
 			lseek (fds[returnVal->myTable], returnVal->pos * pageSize, SEEK_SET);
 			read (fds[returnVal->myTable], returnVal->bytes, pageSize);
+			numReads++;
 		} else {
 			cout << "This is bad: you are reading a page that no longer exists.\n";
 		}
@@ -256,6 +287,7 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, l
 }
 
 MyDB_PageHandle MyDB_BufferManager :: getPinnedPage () {
+	MyDB_BufferGuard guard (*this);
 
 	// see if there is space to make a pinned page
 	if (availableRam.size () == 0)
@@ -276,11 +308,65 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage () {
 }
 
 void MyDB_BufferManager :: unpin (MyDB_PagePtr unpinMe) {
+	MyDB_BufferGuard guard (*this);
 	unpinMe->timeTick = ++lastTimeTick;
 	lastUsed.insert (unpinMe);
 }
 
-MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn, string tempFileIn) {
+void MyDB_BufferManager :: prefetch (MyDB_PagePtr readMe) {
+	MyDB_BufferGuard guard (*this);
+
+	// nothing to do if the page is here already, or if enough pages have been read ahead
+	if (readMe->bytes != nullptr || numPrefetched >= numPages / 4 || fds.count (readMe->myTable) == 0)
+		return;
+
+	// get some RAM for the page, if there is any that is not pinned
+	if (availableRam.size () == 0) {
+		if (lastUsed.size () == 0)
+			return;
+		kickOutPage ();
+	}
+	readMe->bytes = availableRam[availableRam.size () - 1];
+	readMe->numBytes = pageSize;
+	availableRam.pop_back ();
+
+	// start reading it, and put it in the LRU list, so that it can be kicked out like any other page
+	readMe->ioTicket = asyncIO.read (fds[readMe->myTable], readMe->bytes, pageSize, readMe->pos * pageSize);
+	readMe->prefetched = true;
+	numPrefetched++;
+	numReads++;
+	readMe->timeTick = ++lastTimeTick;
+	lastUsed.insert (readMe);
+}
+
+void MyDB_BufferManager :: writeBehind (MyDB_PagePtr writeMe) {
+	MyDB_BufferGuard guard (*this);
+
+	if (writeMe->bytes == nullptr || !writeMe->isDirty || fds.count (writeMe->myTable) == 0)
+		return;
+
+	// the page is clean as soon as the write is started; if it is accessed before the write is done,
+	// the access waits for it
+	finishIO (writeMe);
+	writeMe->ioTicket = asyncIO.write (fds[writeMe->myTable], writeMe->bytes, pageSize, writeMe->pos * pageSize);
+	writeMe->isDirty = false;
+	numWrites++;
+}
+
+void MyDB_BufferManager :: finishIO (MyDB_PagePtr page) {
+
+	if (page->ioTicket != 0) {
+		asyncIO.waitFor (page->ioTicket);
+		page->ioTicket = 0;
+	}
+
+	if (page->prefetched) {
+		page->prefetched = false;
+		numPrefetched--;
+	}
+}
+
+MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn, string tempFileIn, bool threadSafeIn) {
 
 	// remember the inputs
 	pageSize = pageSizeIn;
@@ -296,6 +382,10 @@ MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn,
 
 	// the number of pages
 	numPages = numPagesIn;
+	numPrefetched = 0;
+	numReads = 0;
+	numWrites = 0;
+	threadSafe = threadSafeIn;
 
 	// create all of the RAM
 	for (size_t i = 0; i < numPages; i++) {
@@ -304,7 +394,11 @@ MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn,
 }
 
 void MyDB_BufferManager :: killTable (MyDB_TablePtr killMe) {
+	MyDB_BufferGuard guard (*this);
 	
+	// nothing can still be reading or writing the file when it is closed
+	asyncIO.waitForAll ();
+
 	// remove from the table of FDs
 	if (fds.count (killMe) > 0) {
 		close (fds[killMe]);
@@ -315,6 +409,9 @@ void MyDB_BufferManager :: killTable (MyDB_TablePtr killMe) {
 
 MyDB_BufferManager :: ~MyDB_BufferManager () {
 	
+	// all of the background reads and writes have to finish before the RAM is freed
+	asyncIO.waitForAll ();
+
 	for (auto page : allPages) {
 
 		if (page.second->bytes != nullptr) {
@@ -17,14 +17,37 @@
 #include "MyDB_Table.h"
 
 void *MyDB_Page :: getBytes (MyDB_PagePtr me) {
+	MyDB_BufferGuard guard (parent);
 	parent.access (me);	
 	return bytes;
 }
 
 void MyDB_Page :: wroteBytes () {
+	MyDB_BufferGuard guard (parent);
 	isDirty = true;
 }
 
+void MyDB_Page :: decRefCount (MyDB_PagePtr me) {
+	MyDB_BufferGuard guard (parent);
+	refCount--;
+	if (refCount == 0) {
+		killpage (me);
+	}
+}
+
+void MyDB_Page :: incRefCount () {
+	MyDB_BufferGuard guard (parent);
+	refCount++;
+}
+
+void MyDB_Page :: prefetch (MyDB_PagePtr me) {
+	parent.prefetch (me);
+}
+
+void MyDB_Page :: writeBehind (MyDB_PagePtr me) {
+	parent.writeBehind (me);
+}
+
 MyDB_Page :: ~MyDB_Page () {}
 
 MyDB_Page :: MyDB_Page (MyDB_TablePtr myTableIn, size_t iin, MyDB_BufferManager &parentIn) : 
@@ -33,6 +56,8 @@ MyDB_Page :: MyDB_Page (MyDB_TablePtr myTableIn, size_t iin, MyDB_BufferManager
 	isDirty = false;	
 	refCount = 0;
 	timeTick = -1;
+	ioTicket = 0;
+	prefetched = false;
 }
 
 void MyDB_Page :: killpage (MyDB_PagePtr me) {
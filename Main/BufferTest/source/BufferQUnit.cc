@@ -271,6 +271,54 @@ int main () {
 	}
 	cout << "COMPLETE" << endl << flush;
 	QUNIT_IS_TRUE(flag9);
+
+	// pages written back and read ahead in the background
+	bool flag10 = true;
+	cout << "TEST 10..." << flush;
+	{
+		cout << "create manager..." << flush;
+		MyDB_BufferManager myMgr(64, 16, "tempDSFSD");
+		MyDB_TablePtr table1 = make_shared <MyDB_Table>("table1", "file1");
+		cout << "write bytes..." << flush;
+		for (int i = 0; i < 200; i++) {
+			MyDB_PageHandle page = myMgr.getPage(table1, i);
+			memset(page->getBytes(), (char)('A' + i % 26), 64);
+			page->wroteBytes();
+			page->writeBehind();
+		}
+		vector<MyDB_PageHandle> temps(50);
+		for (int i = 0; i < 50; i++) {
+			temps[i] = myMgr.getPage();
+			memset(temps[i]->getBytes(), (char)('a' + i % 26), 64);
+			temps[i]->wroteBytes();
+			temps[i]->writeBehind();
+		}
+		cout << "read bytes..." << flush;
+		vector<MyDB_PageHandle> pages(200);
+		for (int i = 0; i < 200; i++)
+			pages[i] = myMgr.getPage(table1, i);
+		for (int i = 0; i < 200; i++) {
+			if (i + 1 < 200)
+				pages[i + 1]->prefetch();
+			char *bytes = (char *)pages[i]->getBytes();
+			for (int j = 0; j < 64; j++) {
+				if (bytes[j] != (char)('A' + i % 26)) flag10 = false;
+			}
+		}
+		for (int i = 0; i < 50; i++) {
+			if (i + 1 < 50)
+				temps[i + 1]->prefetch();
+			char *bytes = (char *)temps[i]->getBytes();
+			for (int j = 0; j < 64; j++) {
+				if (bytes[j] != (char)('a' + i % 26)) flag10 = false;
+			}
+		}
+		if (flag10) cout << "correct..." << flush;
+		else cout << "INCORRECT..." << flush;
+		cout << "shutdown manager..." << flush;
+	}
+	cout << "COMPLETE" << endl << flush;
+	QUNIT_IS_TRUE(flag10);
 }
 
 #endif
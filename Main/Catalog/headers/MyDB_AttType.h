@@ -24,6 +24,8 @@ public:
 	virtual MyDB_AttValPtr createAttMax () = 0;
 	virtual string toString () = 0;
 	virtual bool isBool () = 0;
+	virtual bool isDate () = 0;
+	virtual bool isDecimal () = 0;
 };
 
 class MyDB_IntAttType : public MyDB_AttType {
@@ -50,6 +52,14 @@ public:
 		return false;
 	}
 
+	bool isDate () {
+		return false;
+	}
+
+	bool isDecimal () {
+		return false;
+	}
+
 	MyDB_AttValPtr createAtt () {
 		return make_shared <MyDB_IntAttVal> ();
 	}	
@@ -86,6 +96,14 @@ public:
 		return false;
 	}
 
+	bool isDate () {
+		return false;
+	}
+
+	bool isDecimal () {
+		return false;
+	}
+
 	MyDB_AttValPtr createAtt () {
 		return make_shared <MyDB_DoubleAttVal> ();
 	}	
@@ -117,6 +135,14 @@ public:
 		return false;
 	}
 
+	bool isDate () {
+		return false;
+	}
+
+	bool isDecimal () {
+		return false;
+	}
+
 	string toString () {
 		return "string";
 	}
@@ -152,6 +178,14 @@ public:
 		return true;
 	}
 
+	bool isDate () {
+		return false;
+	}
+
+	bool isDecimal () {
+		return false;
+	}
+
 	string toString () {
 		return "bool";
 	}
@@ -167,4 +201,111 @@ public:
 	}	
 };
 
+// a date is stored as an int (the number of days since 1970-01-01), so it can be promoted to an int
+class MyDB_DateAttType : public MyDB_AttType {
+
+public: 
+	
+	bool promotableToInt () {
+		return true;
+	}
+
+	bool promotableToDouble () {
+		return true;
+	}
+
+	bool promotableToString () {
+		return true;
+	}
+
+	bool isBool () {
+		return false;
+	}
+
+	bool isDate () {
+		return true;
+	}
+
+	bool isDecimal () {
+		return false;
+	}
+
+	string toString () {
+		return "date";
+	}
+
+	MyDB_AttValPtr createAtt () {
+		return make_shared <MyDB_DateAttVal> ();
+	}	
+
+	MyDB_AttValPtr createAttMax () {
+		MyDB_DateAttValPtr retVal = make_shared <MyDB_DateAttVal> ();
+		retVal->set (INT_MAX);
+		return retVal;	
+	}	
+};
+
+// a DECIMAL (precision, scale): a number with precision digits, scale of which are after the decimal point,
+// stored as an integer scaled by 10^scale.  Arithmetic over decimals is exact
+class MyDB_DecimalAttType : public MyDB_AttType {
+
+public: 
+
+	MyDB_DecimalAttType (int precisionIn, int scaleIn) {
+		precision = precisionIn;
+		scale = scaleIn;
+	}
+	
+	bool promotableToInt () {
+		return false;
+	}
+
+	bool promotableToDouble () {
+		return true;
+	}
+
+	bool promotableToString () {
+		return true;
+	}
+
+	bool isBool () {
+		return false;
+	}
+
+	bool isDate () {
+		return false;
+	}
+
+	bool isDecimal () {
+		return true;
+	}
+
+	int getPrecision () {
+		return precision;
+	}
+
+	int getScale () {
+		return scale;
+	}
+
+	string toString () {
+		return "decimal(" + to_string (precision) + "," + to_string (scale) + ")";
+	}
+
+	MyDB_AttValPtr createAtt () {
+		return make_shared <MyDB_DecimalAttVal> (scale, precision > MyDB_MAX_NARROW_DIGITS);
+	}	
+
+	MyDB_AttValPtr createAttMax () {
+		MyDB_DecimalAttValPtr retVal = make_shared <MyDB_DecimalAttVal> (scale, precision > MyDB_MAX_NARROW_DIGITS);
+		retVal->set (MyDB_Decimal (LLONG_MAX, scale));
+		return retVal;	
+	}	
+
+private:
+
+	int precision;
+	int scale;
+};
+
 #endif
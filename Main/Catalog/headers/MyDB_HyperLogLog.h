@@ -0,0 +1,60 @@
+
+#ifndef HYPER_LOG_LOG_H
+#define HYPER_LOG_LOG_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the number of bits of each hash used to pick a register; there are 2^this many registers, and
+// the standard error of an estimate is about 1.04 / sqrt (2^this), or 1.6%
+#define HLL_PRECISION 12
+#define HLL_NUM_REGISTERS (1 << HLL_PRECISION)
+
+// a HyperLogLog sketch, used to estimate the number of distinct values of an attribute.  The top
+// bits of each hash pick a register, and the register remembers the longest run of leading zeros
+// seen in the rest of the hash.  Two sketches over different sets of values can be merged, and
+// the result is exactly the sketch over the union of the two sets, so the sketches for a table
+// can be kept in the catalog and added to when more records are appended.
+class MyDB_HyperLogLog {
+
+public:
+
+	// creates an empty sketch
+	MyDB_HyperLogLog ();
+
+	// adds the hash of a value to the sketch; the hash is remixed first, since the estimate relies on
+	// the top bits and the leading zeros being unbiased even for hashes of consecutive keys
+	inline void add (uint64_t hash) {
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ULL;
+		hash ^= hash >> 33;
+		uint64_t rest = (hash << HLL_PRECISION) | (1ULL << (HLL_PRECISION - 1));
+		uint8_t rank = __builtin_clzll (rest) + 1;
+		uint8_t &reg = registers[hash >> (64 - HLL_PRECISION)];
+		if (rank > reg)
+			reg = rank;
+	}
+
+	// puts all of the values in the other sketch into this one
+	void merge (MyDB_HyperLogLog &fromMe);
+
+	// estimates the number of distinct values that have been added
+	size_t estimate ();
+
+	// writes the sketch out as a string (one character per register), suitable for the catalog
+	string toString ();
+
+	// reads the sketch from a string written by toString; returns false if it is not a sketch
+	bool fromString (string &fromMe);
+
+private:
+
+	vector <uint8_t> registers;
+};
+
+#endif
@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include "MyDB_Catalog.h"
+#include "MyDB_HyperLogLog.h"
 #include "MyDB_Schema.h"
 #include "MyDB_Table.h"
 #include <memory>
@@ -74,7 +75,7 @@ public:
 	// the sort att
 	string &getSortAtt ();
 
-	// the file type (ex: "heap" or "bplustree")
+	// the file type (ex: "heap", "bplustree", or "bepsilontree")
 	string &getFileType ();
 
 	// get/set the root location
@@ -88,6 +89,13 @@ public:
         // set the distinct value count for all attributes
         void setDistinctValues (vector <size_t> &toMe);
 
+        // set the distinct value counts for all attributes from a sketch of each of them; the
+        // sketches are remembered (and saved in the catalog) so that they can be added to later
+        void setDistinctValues (vector <MyDB_HyperLogLog> &toMe);
+
+        // merge sketches of newly appended records into the remembered ones, and update the counts
+        void addDistinctValues (vector <MyDB_HyperLogLog> &toMe);
+
         // get/set the number of tuples in the relation
         void setTupleCount (size_t toMe);
         size_t getTupleCount ();
@@ -100,6 +108,9 @@ private:
 	// the distinct value counts
 	vector <size_t> allCounts;
 
+	// the sketches that the distinct value counts came from (empty if the counts were set directly)
+	vector <MyDB_HyperLogLog> allSketches;
+
 	// the number of tuples
 	int count;
 
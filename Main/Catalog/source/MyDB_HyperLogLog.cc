@@ -0,0 +1,59 @@
+
+#ifndef HYPER_LOG_LOG_C
+#define HYPER_LOG_LOG_C
+
+#include <math.h>
+#include "MyDB_HyperLogLog.h"
+
+MyDB_HyperLogLog :: MyDB_HyperLogLog () : registers (HLL_NUM_REGISTERS, 0) {}
+
+void MyDB_HyperLogLog :: merge (MyDB_HyperLogLog &fromMe) {
+	for (size_t i = 0; i < HLL_NUM_REGISTERS; i++) {
+		if (fromMe.registers[i] > registers[i])
+			registers[i] = fromMe.registers[i];
+	}
+}
+
+size_t MyDB_HyperLogLog :: estimate () {
+
+	// the raw estimate is a bias-corrected harmonic mean over the registers
+	double m = HLL_NUM_REGISTERS;
+	double sum = 0;
+	size_t numZeros = 0;
+	for (uint8_t reg : registers) {
+		sum += ldexp (1.0, -reg);
+		if (reg == 0)
+			numZeros++;
+	}
+	double est = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+
+	// for small counts, linear counting over the empty registers is more accurate
+	if (est <= 2.5 * m && numZeros != 0)
+		est = m * log (m / numZeros);
+
+	return (size_t) (est + 0.5);
+}
+
+string MyDB_HyperLogLog :: toString () {
+
+	// a register never holds more than 65 - HLL_PRECISION, so 'A' + the register stays a
+	// letter or punctuation character that the catalog is happy with
+	string res (HLL_NUM_REGISTERS, 'A');
+	for (size_t i = 0; i < HLL_NUM_REGISTERS; i++)
+		res[i] += registers[i];
+	return res;
+}
+
+bool MyDB_HyperLogLog :: fromString (string &fromMe) {
+	if (fromMe.size () != HLL_NUM_REGISTERS)
+		return false;
+	for (size_t i = 0; i < HLL_NUM_REGISTERS; i++) {
+		if (fromMe[i] < 'A' || fromMe[i] > 'A' + 65 - HLL_PRECISION)
+			return false;
+	}
+	for (size_t i = 0; i < HLL_NUM_REGISTERS; i++)
+		registers[i] = fromMe[i] - 'A';
+	return true;
+}
+
+#endif
@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include "MyDB_Schema.h"
+#include <stdio.h>
 
 using namespace std;
 
@@ -63,6 +64,15 @@ void MyDB_Schema :: fromCatalog (string tableName, MyDB_CatalogPtr catalog) {
 			allAtts.push_back (make_pair (s, make_shared <MyDB_StringAttType> ()));
 		} else if (attType == "bool") {
 			allAtts.push_back (make_pair (s, make_shared <MyDB_BoolAttType> ()));
+		} else if (attType == "date") {
+			allAtts.push_back (make_pair (s, make_shared <MyDB_DateAttType> ()));
+		} else if (attType.compare (0, 8, "decimal(") == 0) {
+			int precision, scale;
+			if (sscanf (attType.c_str (), "decimal(%d,%d)", &precision, &scale) != 2) {
+				cout << "Bad decimal type for attribute " << s << ": " << attType << "\n";
+				exit (1);
+			}
+			allAtts.push_back (make_pair (s, make_shared <MyDB_DecimalAttType> (precision, scale)));
 		} else {
 			cout << "Bad att type for attribute " << s << ": " << attType << "\n";
 			exit (1);
@@ -27,6 +27,7 @@ MyDB_TablePtr MyDB_Table :: alias (string toMe) {
 
 MyDB_Table :: MyDB_Table (MyDB_Table &toMe) {
 	allCounts = toMe.allCounts;
+	allSketches = toMe.allSketches;
 	count = toMe.count;
 	sortAtt = toMe.sortAtt;
 	fileType = toMe.fileType;
@@ -80,6 +81,29 @@ size_t MyDB_Table :: getDistinctValues (int forMe) {
 
 void MyDB_Table :: setDistinctValues (vector <size_t> &toMe) {
         allCounts = toMe;
+        allSketches.clear ();
+}
+
+void MyDB_Table :: setDistinctValues (vector <MyDB_HyperLogLog> &toMe) {
+	allSketches = toMe;
+	allCounts.clear ();
+	for (auto &a : allSketches)
+		allCounts.push_back (a.estimate ());
+}
+
+void MyDB_Table :: addDistinctValues (vector <MyDB_HyperLogLog> &toMe) {
+
+	// if we have nothing to merge into, then the new sketches are all we know about
+	if (allSketches.size () != toMe.size ()) {
+		setDistinctValues (toMe);
+		return;
+	}
+
+	allCounts.clear ();
+	for (size_t i = 0; i < allSketches.size (); i++) {
+		allSketches[i].merge (toMe[i]);
+		allCounts.push_back (allSketches[i].estimate ());
+	}
 }
 
 void MyDB_Table :: setTupleCount (size_t toMe) {
@@ -170,6 +194,21 @@ bool MyDB_Table :: fromCatalog (string tableNameIn, MyDB_CatalogPtr catalog) {
 	for (auto a : temp)
 		allCounts.push_back (stoull(a));
 
+	// and the sketches they came from, if there are any
+	allSketches.clear ();
+	temp.clear ();
+	catalog->getStringList (tableName + ".valSketches", temp);
+	for (auto a : temp) {
+		MyDB_HyperLogLog sketch;
+		if (!sketch.fromString (a)) {
+			allSketches.clear ();
+			break;
+		}
+		allSketches.push_back (sketch);
+	}
+	if (allSketches.size () != allCounts.size ())
+		allSketches.clear ();
+
 	// get the number of tuples
 	catalog->getInt (tableName + ".numTuples", count);
 
@@ -209,6 +248,12 @@ void MyDB_Table :: putInCatalog (MyDB_CatalogPtr catalog) {
 		temp.push_back (to_string(a));
 	catalog->putStringList (tableName + ".valCounts", temp);
 
+	// and the sketches they came from
+	temp.clear ();
+	for (auto &a : allSketches)
+		temp.push_back (a.toString ());
+	catalog->putStringList (tableName + ".valSketches", temp);
+
 	// remember the number of tuples
 	catalog->putInt (tableName + ".numTuples", count);
 
@@ -0,0 +1,99 @@
+
+#ifndef BEPSILON_H
+#define BEPSILON_H
+
+#include <functional>
+#include <memory>
+#include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_PageReaderWriter.h"
+#include <vector>
+
+// the most children that a directory page of a B-epsilon tree has, unless it is told otherwise
+#define BEPSILON_FAN_OUT 16
+
+// the number of pages in the buffer of each directory page of a B-epsilon tree; since the buffers are laid out
+// in the file, this cannot change once a tree has been created
+#define BEPSILON_BUFFER_PAGES 16
+
+using namespace std;
+class MyDB_BEpsilonTreeReaderWriter;
+typedef shared_ptr <MyDB_BEpsilonTreeReaderWriter> MyDB_BEpsilonTreeReaderWriterPtr;
+
+// a write-optimized B+-Tree (a B-epsilon tree), for tables that are appended to all of the time; its file type
+// is "bepsilontree".  The leaves and directory pages are just like the ones of a MyDB_BPlusTreeReaderWriter,
+// except that each directory page has a buffer: a run of BEPSILON_BUFFER_PAGES pages of records that are on
+// their way down.  The number of the first one is kept as the next page of the directory page (which a directory
+// page does not otherwise use), and the next page of the first one says which of them is being filled, counting
+// from zero.  An append just goes into the buffer of the root.  Once a buffer is full, all of its records are flushed down at once, into
+// the buffers of the children of its page (flushing those first, if they fill up) or, at the bottom, into the
+// leaves.  So rather than each append writing a leaf somewhere in the tree, a page is written once for each
+// batch of records that gets to it.  The directory pages have at most maxFanOut children, which keeps the
+// batches big.  Lookups and range iterators see the records in the buffers as well as the ones in the leaves
+class MyDB_BEpsilonTreeReaderWriter : public MyDB_BPlusTreeReaderWriter {
+
+public:
+
+	// create a B-epsilon tree over the given table
+	MyDB_BEpsilonTreeReaderWriter (string nameOfAttToOrderOn, MyDB_TablePtr forMe, MyDB_BufferManagerPtr myBuffer,
+		size_t maxFanOut = BEPSILON_FAN_OUT);
+
+	// append a record to the tree
+	void append (MyDB_RecordPtr appendMe) override;
+
+	// these are just like the ones in MyDB_BPlusTreeReaderWriter, except that the records in the buffers are
+	// found as well; the ones in range are sorted and merged with the ones from the leaves
+	size_t lookup (MyDB_AttValPtr key, vector <char> &intoMe) override;
+	bool contains (MyDB_AttValPtr key) override;
+	MyDB_RecordIteratorAltPtr getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) override;
+
+	// gets the leaf pages that might have records with a key value in the range [low, high], along with the
+	// buffers that might
+	vector <MyDB_PageReaderWriter> getRangePages (MyDB_AttValPtr low, MyDB_AttValPtr high) override;
+
+private:
+
+	// a child of a directory page whose buffer is being flushed: the key and page number of its entry, and a
+	// test of whether the key of the record being flushed is below the key
+	struct Child {
+		MyDB_AttValPtr key;
+		int page;
+		function <bool ()> recBelowKey;
+	};
+
+	// gets the page number of the first page of the buffer of the given directory page, giving it one if it has none
+	int getBuffer (int whichPage);
+
+	// appends a record (in binary form, len bytes long) to the buffer of the given directory page; returns false
+	// if the buffer is full
+	bool appendToBuffer (int whichPage, char *rec, size_t len);
+
+	// gets the pages of the buffer of the given directory page that are in use, in order
+	vector <MyDB_PageReaderWriter> getBufferPages (int whichPage);
+
+	// flushes the buffer of the root; if the root splits, a new root goes on top of it
+	void flushRoot ();
+
+	// flushes the buffer of the given directory page down to its children.  leftOfMe is the root of the subtree
+	// just to the left of this one, or -1 if there is none.  If the page ends up with too many children, it is
+	// split: the new pages hold the lower ones, and a (key, ptr) pair for each of them is put on pieces, in order
+	void flush (int whichPage, int leftOfMe, vector <pair <MyDB_AttValPtr, int>> &pieces);
+
+	// writes the given children onto the directory page (which has the given buffer), using as many new pages
+	// as it takes to keep to maxFanOut children on a page; the new pages are listed in pieces, as above
+	void writeNode (int whichPage, int bufferLoc, vector <pair <MyDB_AttValPtr, int>> &children,
+		vector <pair <MyDB_AttValPtr, int>> &pieces);
+
+	// calls visit on the buffer of each directory page (in the subtree rooted at the given page) that might have
+	// records with a key value in the range [low, high].  Returns false if the page is a leaf
+	bool forEachBuffer (int whichPage, MyDB_AttValPtr low, MyDB_AttValPtr high,
+		function <void (MyDB_PageReaderWriter &)> &visit);
+
+	// appends the records in the buffers that have a key value in the range [low, high] to intoMe, sorted, in
+	// binary form (one after another), returning how many there were
+	size_t getBuffered (MyDB_AttValPtr low, MyDB_AttValPtr high, vector <char> &intoMe);
+
+	// the most children that a directory page can have
+	size_t maxFanOut;
+};
+
+#endif
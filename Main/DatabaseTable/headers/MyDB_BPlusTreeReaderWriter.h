@@ -4,6 +4,7 @@
 #ifndef BPLUS_H
 #define BPLUS_H
 
+#include <atomic>
 #include <memory>
 #include <functional>
 #include "MyDB_BufferManager.h"
@@ -14,6 +15,12 @@
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
 
+// the fraction of each page that a bulk load fills, leaving the rest for later appends
+#define BPLUS_FILL_FACTOR 0.9
+
+// the run size of the sort used to bulk load a tree from a text file
+#define BPLUS_LOAD_RUN_SIZE 64
+
 // create a smart pointer for the catalog
 using namespace std;
 class MyDB_PageReaderWriter;
@@ -30,20 +37,59 @@ public:
         // gets an instance of an alternate iterator over the table... this is an
         // iterator that has the alternate getCurrent ()/advance () interface
 	// return all records with a key value in the range [low, high], inclusive
-        MyDB_RecordIteratorAltPtr getRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high);
+        virtual MyDB_RecordIteratorAltPtr getRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high);
 	
         // gets an instance of an alternate iterator over the table... this is an
         // iterator that has the alternate getCurrent ()/advance () interface... returned records must be sorted
 	// return all records with a key value in the range [low, high], inclusive
-        MyDB_RecordIteratorAltPtr getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high);
+        virtual MyDB_RecordIteratorAltPtr getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high);
 	
+	// appends the records with the given key to intoMe, in binary form (one after another, as they are
+	// written by MyDB_Record :: toBinary), returning how many there were.  Each page on the way down is
+	// binary searched right on its bytes, so this is much cheaper than a range iterator over [key, key]
+	virtual size_t lookup (MyDB_AttValPtr key, vector <char> &intoMe);
+
+	// returns true if there is a record with the given key
+	virtual bool contains (MyDB_AttValPtr key);
+
+	// gets the list of leaf pages that might have records with a key value in the range [low, high]
+	virtual vector <MyDB_PageReaderWriter> getRangePages (MyDB_AttValPtr low, MyDB_AttValPtr high);
+
+	// builds a function that returns true if the key of the given data record is in the range [low, high],
+	// inclusive; this does not touch the buffer manager, so a worker thread can use it to filter the records
+	// from the pages returned by getRangePages
+	function <bool ()> buildRangeCheck (MyDB_RecordPtr forMe, MyDB_AttValPtr low, MyDB_AttValPtr high);
+
+	// gets the name of the attribute that the tree is ordered on
+	string getOrderingAtt ();
+
 	// append a record to the B+-Tree
 	void append (MyDB_RecordPtr appendMe);
 
+	// replaces the contents of the tree with the records of fromMe (which has the same schema as the tree,
+	// and is in no particular order).  The records are sorted with a TPMMS using runs of runSize pages,
+	// packed into leaves that are filled to fillFactor of a page, and then the directory is built on top
+	// of the leaves a level at a time, so no page is ever split
+	void bulkLoad (MyDB_TableReaderWriter &fromMe, int runSize, double fillFactor = BPLUS_FILL_FACTOR);
+
+	// just like the above, except that the records come from an iterator; they are written out to a
+	// scratch table so that they can be sorted
+	void bulkLoad (MyDB_RecordIteratorAltPtr fromMe, int runSize, double fillFactor = BPLUS_FILL_FACTOR);
+
+	// loads the text file into a scratch table, and then bulk loads the tree from it
+	pair <vector <MyDB_HyperLogLog>, size_t> loadFromTextFile (string fromMe) override;
+
 	// print the contents of the tree to the screen
 	void printTree ();
 
-private:
+	// gets the shape of the tree: its height (the number of levels, counting the leaves), the number of
+	// directory pages, and the average number of entries on a directory page (its fan-out)
+	void getShape (int &height, size_t &numDirPages, double &fanOut);
+
+protected:
+
+	// the records have to go into the tree one at a time, so that each one ends up in the right leaf
+	void appendBinary (vector <char> &recs) override;
 
 	// gets a list of pages that might have data for an iterator... any leaf page that can possibly
 	// have a value in the range [low, high], inclusive should be returned from this call
@@ -52,13 +98,84 @@ private:
 
 	// appends a record to the named page; if there is a split, then an MyDB_INRecordPtr is returned that
 	// points to the record holding the (key, ptr) pair pointing to the new page.  Note that the new page
-	// always holds the lower 1/2 of the records on the page; the upper 1/2 remains in the original page
-	MyDB_RecordPtr append (int whichPage, MyDB_RecordPtr appendMe);
+	// always holds the lower 1/2 of the records on the page; the upper 1/2 remains in the original page.
+	// leftOfMe is the root of the subtree just to the left of the one rooted at whichPage (its last leaf
+	// comes right before the first leaf of this subtree in the chain of leaves), or -1 if there is none
+	MyDB_RecordPtr append (int whichPage, MyDB_RecordPtr appendMe, int leftOfMe);
 
-	// splits the given page (plus the record andMe) around the median.  A MyDB_INRecordPtr is returned that
-	// points to the record holding the (key, ptr) pair pointing to the new page.  Note that the new page
-	// always holds the lower 1/2 of the records on the page; the upper 1/2 remains in the original page
-	MyDB_RecordPtr split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe);
+	// splits the given page (plus the record andMe, which goes in at the given offset to keep the records in
+	// order) around the median.  A MyDB_INRecordPtr is returned that points to the record holding the (key, ptr)
+	// pair pointing to the new page.  Note that the new page always holds the lower 1/2 of the records on the
+	// page; the upper 1/2 remains in the original page
+	MyDB_RecordPtr split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe, size_t offset);
+
+	// finds the first leaf that can have a record with a key of low or more
+	int findLeaf (MyDB_AttValPtr low);
+
+	// does lookup () and contains (); if intoMe is nullptr, this stops at the first record with the key
+	size_t findKey (MyDB_AttValPtr key, vector <char> *intoMe);
+
+	// binary searches the (ordered) records on the page with the given bytes, loading the key of each record
+	// looked at into probe.  Returns the offset of the first record for which isAtOrPast returns true, or the
+	// end of the records if there is none; offsets is used as scratch space.  The offset is never past the
+	// end of the page, even if the page is being changed while this runs (as a reader of a concurrent tree
+	// may see it), as long as internal node records are the same size whenever keyIsFixedSize is true
+	size_t findFirst (char *bytes, bool isDirectory, MyDB_AttValPtr probe, function <bool ()> &isAtOrPast,
+		vector <size_t> &offsets);
+
+	// gets the address of the key (in binary form) in the internal node record or data record at the given address
+	char *getKeyBytes (char *rec, bool isDirectory);
+
+	// gets the page number in the internal node record at the given address
+	int getPtr (char *rec);
+
+	// on a directory page of a tree with string keys, the first record is not an entry: its key is the prefix that
+	// all of the keys on the page share, and the entries after it have their keys with that prefix taken off.  The
+	// rest of these get at the entries of a directory page no matter how they are stored.  getFirstEntry gives the
+	// offset of the first entry, and getPreviousEntry the offset of the one before the entry at the given offset
+	size_t getFirstEntry (char *bytes);
+	size_t getPreviousEntry (char *bytes, size_t offset);
+
+	// loads the key of the record at the given offset on a page into intoMe; on a directory page, the prefix is
+	// put back on, using scratch
+	void loadKey (char *bytes, size_t offset, bool isDirectory, MyDB_AttValPtr intoMe, string &scratch);
+
+	// gets the (key, ptr) pairs on a directory page, in order; the keys are copies, so they stay good after
+	// the page is changed or swapped out
+	vector <pair <MyDB_AttValPtr, int>> getEntries (MyDB_PageReaderWriter page);
+
+	// appends the entries on a directory page to intoMe, as internal node records with their whole keys (one after
+	// another); andMe, unless it is nullptr, goes in with them at the given offset on the page
+	void copyEntries (char *bytes, vector <char> &intoMe, size_t offset, MyDB_RecordPtr andMe);
+
+	// appends the internal node record to intoMe, in binary form
+	void appendEntry (vector <char> &intoMe, MyDB_RecordPtr appendMe);
+
+	// the number of bytes that a directory page holding the given entries takes up; they are internal node records
+	// with whole keys, one after another, and the last one is at lastEntry
+	size_t getDirectorySize (char *entries, size_t numBytes, size_t lastEntry, size_t numEntries);
+
+	// replaces the contents of the page with a directory page holding the given entries (as above), taking off the
+	// prefix that they share; returns false, leaving the page alone, if they do not fit
+	bool writeEntries (MyDB_PageReaderWriter page, char *entries, size_t numBytes);
+
+	// puts the internal node record in at the given offset on a directory page; returns false, leaving the page
+	// alone, if it does not fit
+	bool insertEntry (MyDB_PageReaderWriter page, size_t offset, MyDB_RecordPtr insertMe);
+
+	// the length of the prefix that the keys of two internal node records (with whole keys) share; this is zero
+	// unless the keys are strings
+	size_t getCommonPrefix (char *lhs, char *rhs);
+
+	// gets a key to put in the directory between a leaf whose largest key is low and the leaf after it, whose
+	// smallest key is high.  For string keys, this is the shortest prefix of high that is past low
+	MyDB_AttValPtr getSeparator (MyDB_AttValPtr low, MyDB_AttValPtr high);
+
+	// finds the last leaf in the subtree rooted at the given page
+	int getRightmostLeaf (int whichPage);
+
+	// builds the tree out of records that come from the iterator in sorted order
+	void buildFromSorted (MyDB_RecordIteratorAltPtr sorted, double fillFactor);
 
 	// constructs and returns an empty internal node record for this particular tree
 	MyDB_INRecordPtr getINRecord ();
@@ -69,13 +186,20 @@ private:
 	// recurive helper for printing the file
 	void printTree (int whichPage, int depth);
 
+	// recursive helper for getShape; numEntries is the number of entries on all of the directory pages
+	void getShape (int whichPage, int depth, int &height, size_t &numDirPages, size_t &numEntries);
+
 	// constructs an returns a comparator for the two records given... both must either be IN records for this particular
 	// tree, or they must be LN records for this tree, or a combination.  The resulting comparator returns true if and
 	// only if the first record has a key value less than the second record
 	function <bool ()> buildComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
 
-	// the location (page number) of the root in the tree
-	int rootLocation;
+	// like the above, but compares two key values directly
+	function <bool ()> buildComparator (MyDB_AttValPtr lhAtt, MyDB_AttValPtr rhAtt);
+
+	// the location (page number) of the root in the tree; it is atomic, so that a concurrent tree can move it
+	// while other threads are reading it
+	atomic <int> rootLocation;
 
 	// the type of the attribute that we are ordering on
 	MyDB_AttTypePtr orderingAttType;
@@ -83,6 +207,14 @@ private:
 	// the number of the attribute that we are ordering on, in the data records
 	int whichAttIsOrdering;
 
+	// true if every key takes up the same number of bytes, so every internal node record does too; if so,
+	// this is the size of an internal node record.  The only keys that are not fixed size are strings
+	bool keyIsFixedSize;
+	size_t inRecSize;
+
+	// the page size
+	size_t pageSize;
+
 };
 
 #endif
@@ -0,0 +1,135 @@
+
+#ifndef CONCURRENT_BPLUS_H
+#define CONCURRENT_BPLUS_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_PageReaderWriter.h"
+#include <stdint.h>
+#include <vector>
+
+// the version counters of the nodes are allocated in chunks of this many, as the tree grows
+#define CONCURRENT_BPLUS_CHUNK_SIZE 4096
+
+// and there are at most this many chunks, so a concurrent tree can have up to 16M pages
+#define CONCURRENT_BPLUS_MAX_CHUNKS 4096
+
+// the bit of a version counter that is set while the node is locked; unlocking adds this in again, which
+// clears the bit and counts one more version at the same time
+#define CONCURRENT_BPLUS_LOCKED 2
+
+using namespace std;
+class MyDB_ConcurrentBPlusTreeReaderWriter;
+typedef shared_ptr <MyDB_ConcurrentBPlusTreeReaderWriter> MyDB_ConcurrentBPlusTreeReaderWriterPtr;
+
+// a B+-Tree that any number of threads can append to and read from at the same time, using optimistic lock
+// coupling.  Each node has a version counter, with a lock bit.  Readers never lock anything: they note the
+// version of a node before looking at it, and once they have noted the version of the next node they go to,
+// they check that the first one has not changed; if it has, they start over from the root.  The records on a
+// leaf (and the records on a directory page, unless they are all the same size) are copied out before they
+// are looked at, so that a reader never trusts anything it has not checked.  An append locks only the leaf
+// that the record goes on.  A leaf that is full is split while holding a latch on the whole tree (so only
+// splits ever change directory pages), and each page that the split changes is locked until it is done.
+//
+// The buffer manager must be thread safe, and every page is used pinned, so it needs enough pages for each
+// thread to pin a few at once (and a split to pin its whole path from the root)
+class MyDB_ConcurrentBPlusTreeReaderWriter : public MyDB_BPlusTreeReaderWriter {
+
+public:
+
+	// create a concurrent B+-Tree over the given table
+	MyDB_ConcurrentBPlusTreeReaderWriter (string nameOfAttToOrderOn, MyDB_TablePtr forMe, MyDB_BufferManagerPtr myBuffer);
+
+	~MyDB_ConcurrentBPlusTreeReaderWriter ();
+
+	// append a record to the tree; this can be called by any number of threads at once
+	void append (MyDB_RecordPtr appendMe) override;
+
+	// these are just like the ones in MyDB_BPlusTreeReaderWriter, except that they can run while other threads
+	// append to the tree.  A range iterator hands out copies of the records, a leaf at a time; if a leaf it is
+	// on changes, it picks up again right after the last record that it handed out, so each record that was in
+	// the tree for the whole scan comes out once, in order
+	size_t lookup (MyDB_AttValPtr key, vector <char> &intoMe) override;
+	bool contains (MyDB_AttValPtr key) override;
+        MyDB_RecordIteratorAltPtr getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) override;
+        MyDB_RecordIteratorAltPtr getRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) override;
+
+	// checks that the tree is well formed: no node is locked, the records on each page are in order, each key
+	// is within the bounds given by the directory above it, all of the leaves are at the same depth, and the
+	// chain of leaves goes through every leaf, in order.  Prints what is wrong and returns false if it is not;
+	// otherwise, numRecs is set to the number of records in the tree.  No other thread can be using the tree
+	bool checkInvariants (size_t &numRecs);
+
+	// the number of times that a reader or an append has had to start over since the tree was created
+	size_t getNumRestarts ();
+
+private:
+
+	// where a range scan is in the leaves; see getSortedRangeIteratorAlt
+	struct ScanState;
+
+	// gets the given page, pinned
+	MyDB_PageReaderWriter getNode (int whichPage);
+
+	// the version counter of the given page
+	atomic <uint64_t> &getVersion (int whichPage);
+
+	// notes the version of the given page; returns false (and the reader has to start over) if it is locked
+	bool readLock (int whichPage, uint64_t &version);
+
+	// returns false (and the reader has to start over) if the page is no longer at the given version
+	bool validate (int whichPage, uint64_t version);
+
+	// locks the page if it is still at the given version, returning false otherwise
+	bool upgradeLock (int whichPage, uint64_t version);
+
+	// waits for the page to be unlocked, and locks it
+	void writeLock (int whichPage);
+
+	// unlocks the page; the version goes up, unless the page was not changed
+	void writeUnlock (int whichPage);
+	void writeUnlockUnchanged (int whichPage, uint64_t version);
+
+	// the reading half of optimistic lock coupling: goes down from the root to the leaf that isAtOrPast (a test
+	// of the key loaded into probe) picks, and sets leaf and version to it.  Returns false if it has to start over
+	bool findLeafOptimistic (MyDB_AttValPtr probe, function <bool ()> &isAtOrPast, vector <char> &scratch,
+		vector <size_t> &offsets, int &leaf, uint64_t &version);
+
+	// copies the used part of the page (at the given version) into intoMe; returns false if the page changed
+	bool copyNode (int whichPage, uint64_t version, vector <char> &intoMe);
+
+	// one try at lookup () and contains (); returns false if it has to start over
+	bool tryFindKey (MyDB_AttValPtr key, vector <char> *intoMe, size_t &numFound);
+
+	// copies the records in range from the next leaf of the scan into intoMe; returns false if it has to start over
+	bool tryScan (ScanState &scan, vector <char> &intoMe);
+
+	// the slow half of an append, when the leaf is full: splits the leaf (and as much of the path above it as
+	// it takes) while holding splitLatch
+	void splitAndAppend (MyDB_RecordPtr appendMe);
+
+	// creates the root and the first leaf of a tree that has never had anything in it
+	void createRoot ();
+
+	// finds the last leaf in the subtree rooted at the given page; the directory pages cannot change, since
+	// this is only called while holding splitLatch
+	int getRightmostLeaf (int whichPage);
+
+	// the recursive part of checkInvariants; low and high are the bounds on the keys in the subtree (either can
+	// be nullptr, for no bound), and the leaves are listed in leaves
+	bool checkInvariants (int whichPage, MyDB_AttValPtr low, MyDB_AttValPtr high, int depth, int &leafDepth,
+		vector <int> &leaves, size_t &numRecs);
+
+	// the version counters, a chunk at a time; a chunk is created by whichever thread needs it first
+	atomic <atomic <uint64_t> *> versions[CONCURRENT_BPLUS_MAX_CHUNKS];
+
+	// held while splitting, so that there is only ever one split going on
+	mutex splitLatch;
+
+	atomic <size_t> numRestarts;
+};
+
+#endif
@@ -0,0 +1,128 @@
+
+#ifndef LEAF_CHAIN_ITER_ALT_H
+#define LEAF_CHAIN_ITER_ALT_H
+
+#include <functional>
+#include "MyDB_RecordIteratorAlt.h"
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_Record.h"
+
+using namespace std;
+
+// iterates through the records in a range of keys, over a chain of pages whose records are in order (the
+// leaves of a B+-Tree).  The chain is followed one page at a time, so only the page being looked at (plus
+// the next one, which is prefetched) is ever needed; the iteration stops at the first record past the range
+class MyDB_LeafChainIteratorAlt : public MyDB_RecordIteratorAlt {
+
+public:
+
+        // load the current record into the parameter
+        void getCurrent (MyDB_RecordPtr intoMe) override {
+		myIter->getCurrent (intoMe);
+	}
+
+        // after a call to advance (), a call to getCurrentPointer () will get the address
+        // of the record.  At a later time, it is then possible to reconstitute the record
+        // by calling MyDB_Record.fromBinary (obtainedPointer)... ASSUMING that the page that
+        // the record is located on has not been swapped out
+        void *getCurrentPointer () {
+		return myIter->getCurrentPointer ();
+	}
+
+        // advance to the next record... returns true if there is a next record, and
+        // false if there are no more records to iterate over.  Not that this cannot
+        // be called until after getCurrent () has been called
+        bool advance () override {
+		while (!done) {
+			if (myIter->advance ()) {
+				myIter->getCurrent (myRec);
+				if (inRange ())
+					return true;
+			} else if (!nextPage ()) {
+				done = true;
+			}
+		}
+		return false;
+	}
+
+        // fill the batch with the records in range that come after the current one; the records are handed
+        // out a page at a time, right where they are on the page
+        bool nextBatch (MyDB_RecordBatch &intoMe) override {
+		while (!done) {
+			if (myIter->nextBatch (intoMe)) {
+
+				// keep just the records that are in range
+				size_t numKept = 0;
+				for (size_t i = 0; i < intoMe.size () && !done; i++) {
+					myRec->fromBinary (intoMe[i]);
+					if (inRange ())
+						intoMe[numKept++] = intoMe[i];
+				}
+				intoMe.truncate (numKept);
+				if (numKept != 0)
+					return true;
+			} else if (!nextPage ()) {
+				done = true;
+			}
+		}
+		intoMe.clear ();
+		return false;
+	}
+
+	// getPage gets a page in the chain from its number, and the iteration starts at firstPage (or is empty,
+	// if that is -1).  The records are loaded into myRec; lowComparator returns true if it is below the range
+	// and highComparator returns true if it is above the range
+	MyDB_LeafChainIteratorAlt (function <MyDB_PageReaderWriter (int)> getPageIn, int firstPage,
+		MyDB_RecordPtr myRecIn, function <bool ()> lowComparatorIn, function <bool ()> highComparatorIn) {
+
+		getPage = getPageIn;
+		myRec = myRecIn;
+		lowComparator = lowComparatorIn;
+		highComparator = highComparatorIn;
+		pastLow = false;
+		nextPageNum = firstPage;
+		done = !nextPage ();
+	}
+
+	~MyDB_LeafChainIteratorAlt () {}
+
+private:
+
+	// checks the record in myRec; once a record is past the range, so are all of the ones after it
+	bool inRange () {
+		if (!pastLow) {
+			if (lowComparator ())
+				return false;
+			pastLow = true;
+		}
+		if (highComparator ()) {
+			done = true;
+			return false;
+		}
+		return true;
+	}
+
+	// moves on to the next page in the chain, returning false if there is not one
+	bool nextPage () {
+		if (nextPageNum == -1)
+			return false;
+		curPage = getPage (nextPageNum);
+		nextPageNum = curPage.getNextPage ();
+		if (nextPageNum != -1)
+			getPage (nextPageNum).prefetch ();
+		myIter = curPage.getIteratorAlt ();
+		return true;
+	}
+
+	function <MyDB_PageReaderWriter (int)> getPage;
+	MyDB_PageReaderWriter curPage;
+	MyDB_RecordIteratorAltPtr myIter;
+	int nextPageNum;
+	MyDB_RecordPtr myRec;
+	function <bool ()> lowComparator;
+	function <bool ()> highComparator;
+	bool pastLow;
+	bool done;
+};
+
+#endif
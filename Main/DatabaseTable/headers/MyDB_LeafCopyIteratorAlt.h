@@ -0,0 +1,88 @@
+
+#ifndef LEAF_COPY_ITER_ALT_H
+#define LEAF_COPY_ITER_ALT_H
+
+#include <functional>
+#include "MyDB_RecordIteratorAlt.h"
+#include "MyDB_Record.h"
+#include <vector>
+
+using namespace std;
+
+// iterates through records that are copied out of a chain of leaves, one leaf at a time, by a function.  Since
+// the records are copies, they stay good no matter what happens to the pages (or who else is changing them)
+// until the next leaf is copied; this is how the records in a concurrent B+-Tree are scanned
+class MyDB_LeafCopyIteratorAlt : public MyDB_RecordIteratorAlt {
+
+public:
+
+	// load the current record into the parameter
+	void getCurrent (MyDB_RecordPtr intoMe) override {
+		intoMe->fromBinary (recs.data () + pos);
+	}
+
+	// the address of the current record, which is good until the next leaf is copied
+	void *getCurrentPointer () override {
+		return recs.data () + pos;
+	}
+
+	// advance to the next record... returns true if there is a next record, and
+	// false if there are no more records to iterate over
+	bool advance () override {
+		if (done)
+			return false;
+		if (started)
+			pos += *((short *) (recs.data () + pos));
+		started = true;
+		while (pos == recs.size ()) {
+			if (!copyNext ())
+				return false;
+		}
+		return true;
+	}
+
+	// fill the batch with the records that come after the current one; they are handed out right where they
+	// are in the copy of the leaf, so the batch never spans leaves
+	bool nextBatch (MyDB_RecordBatch &intoMe) override {
+		intoMe.clear ();
+		if (!advance ())
+			return false;
+		while (true) {
+			intoMe.append (recs.data () + pos);
+			size_t next = pos + *((short *) (recs.data () + pos));
+			if (intoMe.full () || next == recs.size ())
+				return true;
+			pos = next;
+		}
+	}
+
+	// nextRecords copies the next run of records (in binary form, one after another) into its argument,
+	// returning false once there are no more
+	MyDB_LeafCopyIteratorAlt (function <bool (vector <char> &)> nextRecordsIn) {
+		nextRecords = nextRecordsIn;
+		pos = 0;
+		started = false;
+		done = false;
+	}
+
+	~MyDB_LeafCopyIteratorAlt () {}
+
+private:
+
+	bool copyNext () {
+		if (done || !nextRecords (recs)) {
+			done = true;
+			recs.clear ();
+		}
+		pos = 0;
+		return !done;
+	}
+
+	function <bool (vector <char> &)> nextRecords;
+	vector <char> recs;
+	size_t pos;
+	bool started;
+	bool done;
+};
+
+#endif
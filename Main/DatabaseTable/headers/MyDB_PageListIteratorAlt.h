@@ -39,15 +39,21 @@ public:
         // be called until after getCurrent () has been called
         bool advance () override;
 
+        // fill the batch with the records that come after the current one; see MyDB_RecordIteratorAlt
+        bool nextBatch (MyDB_RecordBatch &intoMe) override;
+
 	// destructor and contructor
 	MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUs);
 	~MyDB_PageListIteratorAlt ();
 
 private:
 
+	// the next page is read in the background while the current one is iterated over
+	void prefetchNext ();
+
 	MyDB_RecordIteratorAltPtr myIter;
 	vector <MyDB_PageReaderWriter> forUs;
-	int curPage;
+	size_t curPage;
 };
 
 #endif
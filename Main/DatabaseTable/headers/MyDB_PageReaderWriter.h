@@ -67,12 +67,36 @@ public:
 	// a nullptr
 	void *appendAndReturnLocation (MyDB_RecordPtr appendMe);
 
+	// appends a run of records that are already in binary form (one after another, as they
+	// are written by MyDB_Record :: toBinary) to this page... as many of them as fit are
+	// copied over, and the number of bytes copied is returned
+	size_t appendBinary (char *fromHere, size_t numBytes);
+
+	// appends the records on this page, in binary form (one after another), to the given vector
+	void copyRecords (vector <char> &appendToMe);
+
 	// gets the type of this page... this is just a value from an ennumeration
 	// that is stored within the page
 	MyDB_PageType getType ();
 
 	// sets the type of the page
 	void setType (MyDB_PageType toMe);
+
+	// gets (or sets) the number of the page that follows this one in a chain of pages, such as the
+	// leaves of a B+-Tree; this is -1 if there is no next page, as it is after a call to clear ()
+	int getNextPage ();
+	void setNextPage (int toMe);
+
+	// for a page whose records are in order: finds where a record has to go to keep them in order,
+	// using a binary search.  The comparator must return true if the record being placed comes
+	// before the record loaded into onPage (which is used to load the records on this page).  The
+	// offset returned is that of the first record that the new one comes before, or the end of the
+	// records, so a record is placed after any that it is equal to
+	size_t findInsertPoint (function <bool ()> comparator, MyDB_RecordPtr onPage);
+
+	// puts the record at the given offset (the offset of a record on the page, or the end of the
+	// records), moving the records after it back... returns false if there is not enough room
+	bool insertAt (size_t offset, MyDB_RecordPtr insertMe);
 	
 	// sorts the contents of the page... the boolean lambda that is sent into
 	// this function must check to see if the contents of the record pointed to
@@ -89,6 +113,12 @@ public:
 	// returns the actual bytes
 	void *getBytes ();
 
+	// starts reading this page into the buffer in the background, if it is not there already
+	void prefetch ();
+
+	// starts writing this page back in the background; it should not be appended to after this
+	void writeBehind ();
+
 private:
 
 	// this is the page that we are messing with
@@ -35,6 +35,9 @@ public:
         // be called until after getCurrent () has been called
         bool advance () override;
 
+        // fill the batch with the records that come after the current one; see MyDB_RecordIteratorAlt
+        bool nextBatch (MyDB_RecordBatch &intoMe) override;
+
 	// destructor and contructor
 	MyDB_PageRecIteratorAlt (MyDB_PageHandle myPageIn); 
 	~MyDB_PageRecIteratorAlt ();
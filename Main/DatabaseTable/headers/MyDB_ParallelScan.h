@@ -0,0 +1,57 @@
+#ifndef PARALLEL_SCAN_H
+#define PARALLEL_SCAN_H
+
+#include <functional>
+#include <memory>
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_TableReaderWriter.h"
+#include <vector>
+
+using namespace std;
+
+// a parallel scan cuts its input into morsels of this many pages
+#define MORSEL_PAGES 16
+
+// and it copies out this many morsels per worker thread at a time; while the workers process one
+// batch of morsels, the next batch is copied out of the buffer manager
+#define MORSELS_PER_THREAD 4
+
+// a run of pages from the input of a parallel scan.  The records on the pages are copied out of the
+// buffer manager (which is not thread safe) into this morsel, so that a worker thread can process them;
+// the worker writes its output records (in binary form, one after another) into the morsel as well
+struct MyDB_Morsel {
+	vector <char> records;
+	vector <char> output;
+};
+
+// the pipeline that a worker thread runs over each of its morsels
+typedef function <void (MyDB_Morsel &)> MyDB_MorselPipeline;
+
+// a morsel-driven parallel scan.  The calling thread copies the pages out of the buffer manager a batch
+// of morsels at a time, and hands each worker thread its share of the batch; a worker that runs out of
+// morsels steals them from the back of another worker's queue.  When a batch is done, the output from
+// each of its morsels is appended to the output table, in the order of the input pages, so the output
+// is the same as if the scan had been run on one thread.
+class MyDB_ParallelScan {
+
+public:
+
+	// a scan over all of the pages in the given table
+	MyDB_ParallelScan (MyDB_TableReaderWriter &input);
+
+	// a scan over the given list of pages
+	MyDB_ParallelScan (vector <MyDB_PageReaderWriter> &pages);
+
+	// runs the scan, writing the results to output.  Each worker thread calls buildPipeline once, to set
+	// up its own copy of the pipeline (its own records, compiled computations, and so on); these must not
+	// touch the buffer manager.  If numThreads is zero, one thread per core is used
+	void run (function <MyDB_MorselPipeline ()> buildPipeline, MyDB_TableReaderWriter &output, size_t numThreads = 0);
+
+private:
+
+	// the number of pages in the input, and a function that gets the i^th one
+	size_t numPages;
+	function <MyDB_PageReaderWriter (size_t)> getPage;
+};
+
+#endif
@@ -4,8 +4,68 @@
 
 #include <memory>
 #include "MyDB_Record.h"
+#include <vector>
 using namespace std;
 
+// the most records that nextBatch will put into a batch
+#define RECORD_BATCH_SIZE 256
+
+// a batch of records, filled in by a call to MyDB_RecordIteratorAlt.nextBatch ().  Each entry is
+// the address of a record in binary form, which can be loaded with MyDB_Record.fromBinary ().  Just
+// as with getCurrentPointer (), an address is good ASSUMING that the page that the record is located
+// on has not been swapped out... the iterators that have to step through records one at a time put
+// a copy of each record into the batch, and those addresses are good until the next call
+class MyDB_RecordBatch {
+
+public:
+
+	MyDB_RecordBatch () : copies (RECORD_BATCH_SIZE) {
+		recs.reserve (RECORD_BATCH_SIZE);
+	}
+
+	// the number of records in the batch
+	inline size_t size () {
+		return recs.size ();
+	}
+
+	// the address of the i^th record in the batch
+	inline void *&operator [] (size_t i) {
+		return recs[i];
+	}
+
+	inline bool full () {
+		return recs.size () == RECORD_BATCH_SIZE;
+	}
+
+	inline void clear () {
+		recs.clear ();
+	}
+
+	// keep only the first numRecs records
+	inline void truncate (size_t numRecs) {
+		recs.resize (numRecs);
+	}
+
+	// add the record at the given address
+	inline void append (void *rec) {
+		recs.push_back (rec);
+	}
+
+	// add a copy of the record at the given address
+	inline void appendCopy (void *rec) {
+		vector <char> &copy = copies[recs.size ()];
+		copy.assign ((char *) rec, ((char *) rec) + *((short *) rec));
+		recs.push_back (copy.data ());
+	}
+
+private:
+
+	vector <void *> recs;
+
+	// the space for the copies, which is reused from one batch to the next
+	vector <vector <char>> copies;
+};
+
 // This pure virtual class is used to iterate through the records in a page or file
 // Instances of this class will be created via calls to MyDB_PageReaderWriter.getIteratorAlt ()
 // or MyDB_FileReaderWriter.getIteratorAlt ().  
@@ -31,6 +91,18 @@ public:
 	// be called until after getCurrent () has been called
 	virtual bool advance () = 0;
 
+	// fill the batch with (up to RECORD_BATCH_SIZE of) the records that come after the current one...
+	// returns true if it got any, and false if there are no more records to iterate over.  This is
+	// used in place of advance () and getCurrent (), to pay for the calls once per batch rather than
+	// once per record.  The default steps through the records one at a time, copying each of them;
+	// the iterators over pages and tables override it to hand out the records right where they are
+	virtual bool nextBatch (MyDB_RecordBatch &intoMe) {
+		intoMe.clear ();
+		while (!intoMe.full () && advance ())
+			intoMe.appendCopy (getCurrentPointer ());
+		return intoMe.size () != 0;
+	}
+
 	// destructor and contructor
 	MyDB_RecordIteratorAlt () {};
 	virtual ~MyDB_RecordIteratorAlt () {};
@@ -13,12 +13,12 @@
 #ifndef RUN_Q_ITER_ALT_H
 #define RUN_Q_ITER_ALT_H
 
-#include "IteratorComparator.h"
+#include <functional>
 #include "MyDB_RecordIteratorAlt.h"
-#include "MyDB_RunQueueIteratorAlt.h"
 #include "MyDB_PageRecIteratorAlt.h"
 #include "MyDB_PageReaderWriter.h"
 #include "MyDB_Record.h"
+#include "MyDB_SortKey.h"
 #include <vector>
 
 using namespace std;
@@ -46,17 +46,42 @@ public:
 	// build an iterator that uses the given comparator, over the two records
 	MyDB_RunQueueIteratorAlt (function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
 
-	// get access to the internal queue, for building it up
-	inline priority_queue <MyDB_RecordIteratorAltPtr,
-        vector <MyDB_RecordIteratorAltPtr>, IteratorComparator> &getQ () {
-        	return pq;
-	}
+	// add a sorted run to the merge; advance () must already have been called on the run, and
+	// returned true.  All of the runs have to be added before the first call to advance ()
+	void addRun (MyDB_RecordIteratorAltPtr run);
 
 	~MyDB_RunQueueIteratorAlt ();
 
 private:
 
-	priority_queue <MyDB_RecordIteratorAltPtr, vector <MyDB_RecordIteratorAltPtr>, IteratorComparator> pq;
+	// true if the current record in run a comes before the current record in run b
+	bool before (int a, int b);
+
+	// copies the current record in the given run into its cache, or marks the run as done
+	void cacheCurrent (int run, bool hasRecord);
+
+	// sets up the tree, once all of the runs are in
+	void build ();
+
+	// the runs being merged, and a copy of the current record (in binary form) in each of them,
+	// so that comparing against a run never has to go back to its page; a run that is out of
+	// records has an empty copy, and loses to every other run
+	vector <MyDB_RecordIteratorAltPtr> runs;
+	vector <vector <char>> current;
+
+	// if the comparator came from buildRecordComparator, the key of the current record in each run;
+	// runs are compared on their keys, and their records are only compared if the keys are the same
+	MyDB_SortKeyPtr sortKey;
+	vector <uint64_t> keys;
+
+	// a tournament (loser) tree over the runs.  With k runs, entries 1 through k - 1 are the
+	// internal nodes, each of which holds the run that lost the match played there, and run i
+	// sits at leaf k + i.  Entry 0 holds the overall winner, whose record is the current one
+	vector <int> tree;
+
+	function <bool ()> comparator;
+	MyDB_RecordPtr lhs;
+	MyDB_RecordPtr rhs;
 	bool firstTime;
 };
 
@@ -0,0 +1,107 @@
+
+#ifndef SORT_KEY_H
+#define SORT_KEY_H
+
+#include <functional>
+#include <memory>
+#include "MyDB_Record.h"
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+// sortRecords uses a radix sort on exact keys when there are at least this many records
+#define RADIX_SORT_MIN 64
+
+// the number of records that the radix sort buffers for each bucket before writing them out
+#define RADIX_BUFFER 8
+
+// a record (in binary form) along with its normalized sort key
+struct MyDB_KeyedRecord {
+	uint64_t key;
+	void *rec;
+};
+
+class MyDB_SortKey;
+typedef shared_ptr <MyDB_SortKey> MyDB_SortKeyPtr;
+
+// encodes the value that a sort compares records on into a normalized key: eight bytes, held in a uint64_t
+// so that comparing two keys as unsigned ints gives the same answer as memcmp on their bytes (big endian).
+// Ints, dates, bools, doubles and narrow decimals are encoded exactly, so records with the same key are
+// equal; strings (the first eight bytes) and wide decimals (as doubles) only keep the order, so records with
+// the same key have to be compared in full.  A key for a descending sort is the complement of the key for
+// the ascending one
+class MyDB_SortKey {
+
+public:
+
+	// builds the keys for the given computation, over records with the given schema
+	MyDB_SortKey (MyDB_SchemaPtr mySchema, string computation, bool descending);
+
+	// builds the keys that order records the same way as the given comparator, over records with the
+	// given schema; if the comparator was not built by buildRecordComparator, this returns nullptr
+	static MyDB_SortKeyPtr forComparator (function <bool ()> &comparator, MyDB_SchemaPtr mySchema);
+
+	// the key for the record at the given address
+	uint64_t encode (void *rec);
+
+	// true if two records with the same key are always equal under the comparator
+	bool isExact ();
+
+private:
+
+	enum KeyType {IntKey, BoolKey, DoubleKey, DecimalKey, StringKey};
+
+	// the record that is loaded to encode a key, narrowed to what the computation needs, and the computation
+	MyDB_RecordPtr myRec;
+	func keyFunc;
+
+	KeyType keyType;
+	bool exact;
+
+	// the scale of a decimal key
+	int scale;
+	bool descending;
+};
+
+// a comparator over keyed records: the keys are compared first, and only if they are the same (and the
+// keys are not exact) are the records themselves compared, using comparator, lhs and rhs
+class MyDB_KeyedComparator {
+
+public:
+
+	MyDB_KeyedComparator (bool exactIn, function <bool ()> comparatorIn, MyDB_RecordPtr lhsIn, MyDB_RecordPtr rhsIn) {
+		exact = exactIn;
+		comparator = comparatorIn;
+		lhs = lhsIn;
+		rhs = rhsIn;
+	}
+
+	bool operator () (const MyDB_KeyedRecord &left, const MyDB_KeyedRecord &right) const {
+		if (left.key != right.key)
+			return left.key < right.key;
+		if (exact)
+			return false;
+		lhs->fromBinary (left.rec);
+		rhs->fromBinary (right.rec);
+		return comparator ();
+	}
+
+private:
+
+	bool exact;
+	function <bool ()> comparator;
+	MyDB_RecordPtr lhs;
+	MyDB_RecordPtr rhs;
+};
+
+// a stable LSD radix sort of the records on their keys, one byte at a time; bytes that are the same in
+// every key (such as the low four bytes of an int key) are skipped
+void radixSort (vector <MyDB_KeyedRecord> &recs);
+
+// stable sorts the records at the given addresses, using comparator, lhs and rhs; if the comparator was
+// built by buildRecordComparator, the key of each record is computed once and the sort is done on the keys
+// (with a radix sort, if the type of the key lets it be encoded exactly)
+void sortRecords (vector <void *> &positions, function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
+
+#endif
@@ -45,6 +45,11 @@ public:
 	// append a record to the table
 	virtual void append (MyDB_RecordPtr appendMe);
 
+	// appends a run of records that are already in binary form (one after another, as they are
+	// written by MyDB_Record :: toBinary) to the end of the table, a page full at a time; a table
+	// that keeps its records organized (such as a B+-Tree) puts each one where it belongs
+	virtual void appendBinary (vector <char> &recs);
+
 	// return an itrator over this table... each time returnVal->next () is
 	// called, the resulting record will be placed into the record pointed to
 	// by iterateIntoMe
@@ -60,10 +65,14 @@ public:
 	MyDB_RecordIteratorAltPtr getIteratorAlt (int lowPage, int highPage);
 
 	// load a text file into this table... this returns a pair where the first
-	// entry is a list of (approximate) distinct value counts for each of the
-	// attributes in the table, and the second entry is the number of tuples that
+	// entry is a list of sketches giving the (approximate) distinct value counts for
+	// each of the attributes in the table, and the second entry is the number of tuples that
 	// have been loaded into the table
-	pair <vector <size_t>, size_t> loadFromTextFile (string fromMe);
+	//
+	// the file is mapped into memory and cut into chunks at line boundaries; the
+	// chunks are parsed in parallel by worker threads, and the resulting records are
+	// then copied onto the table's pages in order, a page full at a time
+	virtual pair <vector <MyDB_HyperLogLog>, size_t> loadFromTextFile (string fromMe);
 
 	// dump the contents of this table into a text file
 	void writeIntoTextFile (string toMe);
@@ -96,7 +105,7 @@ private:
 	MyDB_TablePtr forMe;
 	MyDB_BufferManagerPtr myBuffer;
 	shared_ptr <MyDB_PageReaderWriter> lastPage;
-	
+
 };
 
 #endif
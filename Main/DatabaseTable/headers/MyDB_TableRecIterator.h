@@ -14,6 +14,7 @@
 #define TABLE_REC_ITER_H
 
 #include "MyDB_RecordIterator.h"
+#include "MyDB_PageReaderWriter.h"
 #include "MyDB_Record.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Table.h"
@@ -44,6 +45,9 @@ private:
 
 	MyDB_RecordIteratorPtr myIter;
 	int curPage;
+
+	// the type of the current page; remembered so that we need not go back to the buffer manager for every record
+	MyDB_PageType curPageType;
 	
 	MyDB_TableReaderWriter &myParent;
 	MyDB_TablePtr myTable;
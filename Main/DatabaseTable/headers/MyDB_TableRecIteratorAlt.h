@@ -14,6 +14,7 @@
 #define TABLE_REC_ITER_ALT_H
 
 #include "MyDB_RecordIteratorAlt.h"
+#include "MyDB_PageReaderWriter.h"
 #include "MyDB_Record.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Table.h"
@@ -36,6 +37,9 @@ public:
         // be called until after getCurrent () has been called
         bool advance () override;
 
+        // fill the batch with the records that come after the current one; see MyDB_RecordIteratorAlt
+        bool nextBatch (MyDB_RecordBatch &intoMe) override;
+
 	// destructor and contructor
 	MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn);
 	~MyDB_TableRecIteratorAlt ();
@@ -43,9 +47,14 @@ public:
 
 private:
 
+	// the iterator over the current page; the page is pinned while we are on it, so that the records
+	// handed out by nextBatch stay put
 	MyDB_RecordIteratorAltPtr myIter;
 	int curPage;
 	int highPage;	
+
+	// the type of the current page; remembered so that we need not go back to the buffer manager for every record
+	MyDB_PageType curPageType;
 	MyDB_TableReaderWriter &myParent;
 	MyDB_TablePtr myTable;
 };
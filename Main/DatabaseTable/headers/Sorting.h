@@ -7,11 +7,32 @@
 #include "MyDB_TableReaderWriter.h"
 #include "IteratorComparator.h"
 
+// how the first phase of a TPMMS builds its sorted runs.  LoadSort reads runSize pages at a time and sorts
+// them, giving runs of runSize pages; ReplacementSelection keeps a heap of runSize pages worth of records,
+// always writing out the smallest one that can still go into the current run, which gives runs about twice
+// as long on random input (and a single run on input that is already close to sorted).  Automatic uses
+// replacement selection when runs of runSize pages would be too many to merge with runSize pages of memory
+enum MyDB_RunGeneration {Automatic, LoadSort, ReplacementSelection};
+
+// counters kept by the sorts, for checking how they went
+struct MyDB_SortCounters {
+
+	// the number of sorted runs built by the first phase of all of the sorts
+	size_t runsBuilt = 0;
+
+	// the number of sorts that built their runs using replacement selection
+	size_t replacementSelections = 0;
+};
+
+// gets the counters for all of the sorts run so far; they can be zeroed by assigning MyDB_SortCounters ()
+MyDB_SortCounters &getSortCounters ();
+
 // performs a TPMMS of the table sortMe.  The results are written to sortIntoMe.  The run 
 // size for the first phase of the TPMMS is given by runSize.  Comparisons are performed 
 // using comparator, lhs, rhs
 void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe,
-        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
+        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs,
+        MyDB_RunGeneration how = MyDB_RunGeneration :: Automatic);
 
 // Accepts the input file sortMe, and then uses the specified comparator over the records lhs 
 // and rhs to sort the file into a set of sorted runs of length at most runSize.  It then
@@ -23,7 +44,8 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 // just like the above, except that in addition, the specified selection predicates are run
 // over the input records so that only the records matching the selection predicates is sorted
 MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
-        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred);
+        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred,
+        MyDB_RunGeneration how = MyDB_RunGeneration :: Automatic);
 
 // helper function.  Gets two iterators, leftIter and rightIter.  It is assumed that these are iterators over
 // sorted lists of records.  This function then merges all of those records into a list of anonymous pages,
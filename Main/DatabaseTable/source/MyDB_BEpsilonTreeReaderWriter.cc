@@ -0,0 +1,346 @@
+
+#ifndef BEPSILON_C
+#define BEPSILON_C
+
+#include <algorithm>
+#include <iostream>
+#include "MyDB_BEpsilonTreeReaderWriter.h"
+#include "MyDB_INRecord.h"
+#include "MyDB_LeafCopyIteratorAlt.h"
+#include "MyDB_RunQueueIteratorAlt.h"
+
+MyDB_BEpsilonTreeReaderWriter :: MyDB_BEpsilonTreeReaderWriter (string orderOnAttName, MyDB_TablePtr forMe,
+	MyDB_BufferManagerPtr myBuffer, size_t maxFanOutIn) : MyDB_BPlusTreeReaderWriter (orderOnAttName, forMe, myBuffer) {
+
+	// a directory page has to be able to split in two
+	maxFanOut = max ((size_t) 2, maxFanOutIn);
+}
+
+void MyDB_BEpsilonTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
+
+	// an empty tree starts out just like a B+-Tree, with a root and one leaf, which gets the record
+	if (getNumPages () <= 1) {
+		MyDB_BPlusTreeReaderWriter :: append (appendMe);
+		return;
+	}
+
+	// otherwise, the record goes into the buffer of the root, which is flushed first if it is full
+	vector <char> rec (appendMe->getBinarySize ());
+	appendMe->toBinary (rec.data ());
+	if (appendToBuffer (rootLocation, rec.data (), rec.size ()))
+		return;
+	flushRoot ();
+	if (!appendToBuffer (rootLocation, rec.data (), rec.size ())) {
+		cout << "Record is too big for a page.\n";
+		exit (1);
+	}
+}
+
+int MyDB_BEpsilonTreeReaderWriter :: getBuffer (int whichPage) {
+
+	MyDB_PageReaderWriter page = (*this)[whichPage];
+	int bufferLoc = page.getNextPage ();
+	if (bufferLoc == -1) {
+
+		// all of the pages are cleared now, so that a scan of the whole file never sees anything left over in them
+		bufferLoc = getTable ()->lastPage () + 1;
+		getTable ()->setLastPage (bufferLoc + BEPSILON_BUFFER_PAGES - 1);
+		for (int i = 0; i < BEPSILON_BUFFER_PAGES; i++)
+			(*this)[bufferLoc + i].clear ();
+		(*this)[bufferLoc].setNextPage (0);
+		page.setNextPage (bufferLoc);
+	}
+	return bufferLoc;
+}
+
+bool MyDB_BEpsilonTreeReaderWriter :: appendToBuffer (int whichPage, char *rec, size_t len) {
+
+	int bufferLoc = getBuffer (whichPage);
+	MyDB_PageReaderWriter firstPage = (*this)[bufferLoc];
+	int current = firstPage.getNextPage ();
+	if ((*this)[bufferLoc + current].appendBinary (rec, len) == len)
+		return true;
+
+	// go on to the next page of the buffer, if there is one
+	if (current + 1 == BEPSILON_BUFFER_PAGES)
+		return false;
+	firstPage.setNextPage (current + 1);
+	return (*this)[bufferLoc + current + 1].appendBinary (rec, len) == len;
+}
+
+vector <MyDB_PageReaderWriter> MyDB_BEpsilonTreeReaderWriter :: getBufferPages (int whichPage) {
+
+	vector <MyDB_PageReaderWriter> pages;
+	int bufferLoc = (*this)[whichPage].getNextPage ();
+	if (bufferLoc == -1)
+		return pages;
+
+	int numInUse = (*this)[bufferLoc].getNextPage () + 1;
+	for (int i = 0; i < numInUse; i++)
+		pages.push_back ((*this)[bufferLoc + i]);
+	return pages;
+}
+
+void MyDB_BEpsilonTreeReaderWriter :: flushRoot () {
+
+	vector <pair <MyDB_AttValPtr, int>> pieces;
+	flush (rootLocation, -1, pieces);
+
+	// if the root split, its pieces and what is left of it go under a new root (which can have too many children
+	// itself, if the root split into lots of pieces); the old root keeps the largest possible key
+	while (pieces.size () != 0) {
+		vector <pair <MyDB_AttValPtr, int>> children;
+		children.swap (pieces);
+		children.push_back (make_pair (orderingAttType->createAttMax (), (int) rootLocation));
+
+		int newRootLoc = getTable ()->lastPage () + 1;
+		getTable ()->setLastPage (newRootLoc);
+		writeNode (newRootLoc, -1, children, pieces);
+		rootLocation = newRootLoc;
+		getTable ()->setRootLocation (rootLocation);
+	}
+}
+
+void MyDB_BEpsilonTreeReaderWriter :: flush (int whichPage, int leftOfMe, vector <pair <MyDB_AttValPtr, int>> &pieces) {
+
+	// take the records out of the buffer
+	vector <char> recs;
+	vector <MyDB_PageReaderWriter> bufferPages = getBufferPages (whichPage);
+	for (MyDB_PageReaderWriter &bufferPage : bufferPages)
+		bufferPage.copyRecords (recs);
+	if (recs.size () == 0)
+		return;
+	for (MyDB_PageReaderWriter &bufferPage : bufferPages)
+		bufferPage.clear ();
+	bufferPages[0].setNextPage (0);
+	MyDB_PageReaderWriter page = (*this)[whichPage];
+	int bufferLoc = page.getNextPage ();
+
+	// get the children, with a test of whether each record goes to the left of each of them
+	MyDB_RecordPtr rec = getEmptyRecord ();
+	MyDB_AttValPtr recKey = rec->getAtt (whichAttIsOrdering);
+	auto makeChild = [&] (MyDB_AttValPtr key, int childLoc) {
+		return Child {key, childLoc, buildComparator (recKey, key)};
+	};
+	vector <Child> children;
+	for (auto &entry : getEntries (page))
+		children.push_back (makeChild (entry.first, entry.second));
+	bool toLeaves = (*this)[children[0].page].getType () == MyDB_PageType :: RegularPage;
+
+	// send each record down, in the order that they were appended in, so records with the same key stay in order
+	MyDB_RecordPtr onPage = getEmptyRecord ();
+	function <bool ()> recBelowOnPage = buildComparator (rec, onPage);
+	bool changed = false;
+	for (size_t pos = 0; pos != recs.size (); ) {
+		char *bytes = recs.data () + pos;
+		size_t len = *((short *) bytes);
+		rec->fromBinary (bytes);
+
+		// the record goes to the first child whose key it is below, just as in a B+-Tree
+		size_t low = 0, high = children.size () - 1;
+		while (low < high) {
+			size_t mid = (low + high) / 2;
+			if (children[mid].recBelowKey ())
+				high = mid;
+			else
+				low = mid + 1;
+		}
+		int leftOfChild = low == 0 ? leftOfMe : children[low - 1].page;
+
+		// into the buffer of a directory page; if it is full, it is flushed first (which leaves it empty, so the
+		// record fits next time), and since that may have split the child, the record is sent down again
+		if (!toLeaves) {
+			if (appendToBuffer (children[low].page, bytes, len)) {
+				pos += len;
+				continue;
+			}
+
+			vector <pair <MyDB_AttValPtr, int>> childPieces;
+			flush (children[low].page, leftOfChild, childPieces);
+			for (size_t i = 0; i < childPieces.size (); i++)
+				children.insert (children.begin () + low + i, makeChild (childPieces[i].first, childPieces[i].second));
+			changed = changed || childPieces.size () != 0;
+			continue;
+		}
+
+		// into a leaf; if it is full, it is split just as in a B+-Tree, and the new page goes into the chain of
+		// leaves right before it
+		MyDB_PageReaderWriter leaf = (*this)[children[low].page];
+		size_t offset = leaf.findInsertPoint (recBelowOnPage, onPage);
+		if (!leaf.insertAt (offset, rec)) {
+			MyDB_INRecordPtr res = static_pointer_cast <MyDB_INRecord> (split (leaf, rec, offset));
+			(*this)[res->getPtr ()].setNextPage (children[low].page);
+			if (leftOfChild != -1)
+				(*this)[getRightmostLeaf (leftOfChild)].setNextPage (res->getPtr ());
+			children.insert (children.begin () + low, makeChild (res->getKey (), res->getPtr ()));
+			changed = true;
+		}
+		pos += len;
+	}
+
+	// the page only has to be written again if it got new children
+	if (!changed)
+		return;
+	vector <pair <MyDB_AttValPtr, int>> entries;
+	for (Child &child : children)
+		entries.push_back (make_pair (child.key, child.page));
+	writeNode (whichPage, bufferLoc, entries, pieces);
+}
+
+void MyDB_BEpsilonTreeReaderWriter :: writeNode (int whichPage, int bufferLoc, vector <pair <MyDB_AttValPtr, int>> &children,
+	vector <pair <MyDB_AttValPtr, int>> &pieces) {
+
+	// the entries, as internal node records
+	vector <char> entries;
+	vector <size_t> starts;
+	MyDB_INRecordPtr inRec = getINRecord ();
+	for (auto &child : children) {
+		starts.push_back (entries.size ());
+		inRec->setKey (child.first);
+		inRec->setPtr (child.second);
+		appendEntry (entries, inRec);
+	}
+	starts.push_back (entries.size ());
+
+	// split them evenly over as few pages as it takes for each page to have at most maxFanOut of them, and for
+	// each page to fit them
+	size_t numEntries = children.size ();
+	size_t numPages = (numEntries + maxFanOut - 1) / maxFanOut;
+	auto pieceStart = [&] (size_t i) {return i * numEntries / numPages;};
+	while (numPages < numEntries) {
+		bool fits = true;
+		for (size_t i = 0; i < numPages && fits; i++) {
+			size_t first = starts[pieceStart (i)], end = starts[pieceStart (i + 1)];
+			fits = getDirectorySize (entries.data () + first, end - first, starts[pieceStart (i + 1) - 1] - first,
+				pieceStart (i + 1) - pieceStart (i)) <= pageSize;
+		}
+		if (fits)
+			break;
+		numPages++;
+	}
+
+	// the lower pieces go on new pages, and the page itself keeps the last one, since its key is the largest
+	for (size_t i = 0; i < numPages; i++) {
+		int pageLoc = whichPage, pageBuffer = bufferLoc;
+		if (i + 1 < numPages) {
+			pageLoc = getTable ()->lastPage () + 1;
+			getTable ()->setLastPage (pageLoc);
+			pageBuffer = -1;
+			pieces.push_back (make_pair (children[pieceStart (i + 1) - 1].first, pageLoc));
+		}
+
+		MyDB_PageReaderWriter page = (*this)[pageLoc];
+		size_t first = starts[pieceStart (i)];
+		writeEntries (page, entries.data () + first, starts[pieceStart (i + 1)] - first);
+		page.setNextPage (pageBuffer);
+	}
+}
+
+bool MyDB_BEpsilonTreeReaderWriter :: forEachBuffer (int whichPage, MyDB_AttValPtr low, MyDB_AttValPtr high,
+	function <void (MyDB_PageReaderWriter &)> &visit) {
+
+	MyDB_PageReaderWriter page = (*this)[whichPage];
+	if (page.getType () == MyDB_PageType :: RegularPage)
+		return false;
+
+	for (MyDB_PageReaderWriter &bufferPage : getBufferPages (whichPage))
+		visit (bufferPage);
+
+	// go on to the subtrees that can have keys in the range, just as discoverPages does; if the children are
+	// leaves, there are no more buffers
+	for (auto &entry : getEntries (page)) {
+		if (!buildComparator (entry.first, low) () && !forEachBuffer (entry.second, low, high, visit))
+			break;
+		if (buildComparator (high, entry.first) ())
+			break;
+	}
+	return true;
+}
+
+size_t MyDB_BEpsilonTreeReaderWriter :: getBuffered (MyDB_AttValPtr low, MyDB_AttValPtr high, vector <char> &intoMe) {
+
+	if (rootLocation == -1)
+		return 0;
+
+	// find the records in range
+	vector <char> found;
+	vector <size_t> offsets;
+	MyDB_RecordPtr lhs = getEmptyRecord ();
+	MyDB_RecordPtr rhs = getEmptyRecord ();
+	function <bool ()> inRange = buildRangeCheck (lhs, low, high);
+	function <void (MyDB_PageReaderWriter &)> visit = [&] (MyDB_PageReaderWriter &buffer) {
+		MyDB_RecordIteratorAltPtr temp = buffer.getIteratorAlt ();
+		while (temp->advance ()) {
+			temp->getCurrent (lhs);
+			if (inRange ()) {
+				char *rec = (char *) temp->getCurrentPointer ();
+				offsets.push_back (found.size ());
+				found.insert (found.end (), rec, rec + *((short *) rec));
+			}
+		}
+	};
+	forEachBuffer (rootLocation, low, high, visit);
+
+	// and sort them
+	function <bool ()> comparator = buildComparator (lhs, rhs);
+	stable_sort (offsets.begin (), offsets.end (), [&] (size_t a, size_t b) {
+		lhs->fromBinary (found.data () + a);
+		rhs->fromBinary (found.data () + b);
+		return comparator ();
+	});
+	for (size_t offset : offsets)
+		intoMe.insert (intoMe.end (), found.data () + offset, found.data () + offset + *((short *) (found.data () + offset)));
+	return offsets.size ();
+}
+
+size_t MyDB_BEpsilonTreeReaderWriter :: lookup (MyDB_AttValPtr key, vector <char> &intoMe) {
+	size_t numFound = MyDB_BPlusTreeReaderWriter :: lookup (key, intoMe);
+	return numFound + getBuffered (key, key, intoMe);
+}
+
+bool MyDB_BEpsilonTreeReaderWriter :: contains (MyDB_AttValPtr key) {
+	if (MyDB_BPlusTreeReaderWriter :: contains (key))
+		return true;
+	vector <char> found;
+	return getBuffered (key, key, found) != 0;
+}
+
+MyDB_RecordIteratorAltPtr MyDB_BEpsilonTreeReaderWriter :: getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
+
+	MyDB_RecordIteratorAltPtr fromLeaves = MyDB_BPlusTreeReaderWriter :: getSortedRangeIteratorAlt (low, high);
+	shared_ptr <vector <char>> buffered = make_shared <vector <char>> ();
+	if (getBuffered (low, high, *buffered) == 0)
+		return fromLeaves;
+
+	// the records from the buffers are handed out all at once, merged with the ones from the leaves
+	MyDB_RecordIteratorAltPtr fromBuffers = make_shared <MyDB_LeafCopyIteratorAlt> (
+		[buffered] (vector <char> &intoMe) {
+			if (buffered->size () == 0)
+				return false;
+			intoMe.swap (*buffered);
+			buffered->clear ();
+			return true;
+		});
+
+	MyDB_RecordPtr lhs = getEmptyRecord ();
+	MyDB_RecordPtr rhs = getEmptyRecord ();
+	MyDB_RunQueueIteratorAltPtr merged = make_shared <MyDB_RunQueueIteratorAlt> (buildComparator (lhs, rhs), lhs, rhs);
+	fromBuffers->advance ();
+	merged->addRun (fromBuffers);
+	if (fromLeaves->advance ())
+		merged->addRun (fromLeaves);
+	return merged;
+}
+
+vector <MyDB_PageReaderWriter> MyDB_BEpsilonTreeReaderWriter :: getRangePages (MyDB_AttValPtr low, MyDB_AttValPtr high) {
+
+	vector <MyDB_PageReaderWriter> list = MyDB_BPlusTreeReaderWriter :: getRangePages (low, high);
+	function <void (MyDB_PageReaderWriter &)> visit = [&] (MyDB_PageReaderWriter &buffer) {
+		list.push_back (buffer);
+	};
+	if (rootLocation != -1)
+		forEachBuffer (rootLocation, low, high, visit);
+	return list;
+}
+
+#endif
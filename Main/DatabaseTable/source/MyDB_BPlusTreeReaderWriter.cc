@@ -5,8 +5,8 @@
 #include "MyDB_INRecord.h"
 #include "MyDB_BPlusTreeReaderWriter.h"
 #include "MyDB_PageReaderWriter.h"
-#include "MyDB_PageListIteratorSelfSortingAlt.h"
-#include "RecordComparator.h"
+#include "MyDB_LeafChainIteratorAlt.h"
+#include "Sorting.h"
 #include <algorithm>
 
 MyDB_BPlusTreeReaderWriter :: MyDB_BPlusTreeReaderWriter (string orderOnAttName, MyDB_TablePtr forMe, 
@@ -18,6 +18,10 @@ MyDB_BPlusTreeReaderWriter :: MyDB_BPlusTreeReaderWriter (string orderOnAttName,
 	// remember information about the ordering attribute
 	orderingAttType = res.second;
 	whichAttIsOrdering = res.first;
+	keyIsFixedSize = orderingAttType->promotableToInt () || orderingAttType->promotableToDouble () || 
+		orderingAttType->isBool ();
+	inRecSize = keyIsFixedSize ? getINRecord ()->getBinarySize () : 0;
+	pageSize = myBuffer->getPageSize ();
 
 	// and the root location
 	rootLocation = getTable ()->getRootLocation ();
@@ -25,56 +29,50 @@ MyDB_BPlusTreeReaderWriter :: MyDB_BPlusTreeReaderWriter (string orderOnAttName,
 
 MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
 
-	// this is the list of pages that we need to iterate over
-	vector <MyDB_PageReaderWriter> list;
-
-	// fill up this list of pages
-	discoverPages (rootLocation, list, low, high);
-
-	// for various comparisons
-	MyDB_RecordPtr lhs = getEmptyRecord ();
-	MyDB_RecordPtr rhs = getEmptyRecord ();
+	// for the comparisons against the range
 	MyDB_RecordPtr myRec = getEmptyRecord ();
 	MyDB_INRecordPtr llow = getINRecord ();
 	llow->setKey (low);
 	MyDB_INRecordPtr hhigh = getINRecord ();
 	hhigh->setKey (high);
-
-	// build the comparison functions
-	function <bool ()> comparator = buildComparator (lhs, rhs);
 	function <bool ()> lowComparator = buildComparator (myRec, llow);	
 	function <bool ()> highComparator = buildComparator (hhigh, myRec);	
 
-	// and build the iterator
-	return make_shared <MyDB_PageListIteratorSelfSortingAlt> (list, lhs, rhs, comparator, myRec, lowComparator, highComparator, true);	
+	// the leaves are in order, so the records are found by walking the leaves from the first one that can
+	// have a record in the range, until a record past the range turns up
+	int firstLeaf = rootLocation == -1 ? -1 : findLeaf (low);
+	return make_shared <MyDB_LeafChainIteratorAlt> ([this] (int i) {return (*this)[i];}, firstLeaf, myRec, 
+		lowComparator, highComparator);
 }
 
 MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
 
-	// this is the list of pages that we need to iterate over
-	vector <MyDB_PageReaderWriter> list;
+	// since the leaves are kept in order, walking them is as cheap as any other way to find the records
+	return getSortedRangeIteratorAlt (low, high);
+}
 
-	// fill up this list of pages
+vector <MyDB_PageReaderWriter> MyDB_BPlusTreeReaderWriter :: getRangePages (MyDB_AttValPtr low, MyDB_AttValPtr high) {
+	vector <MyDB_PageReaderWriter> list;
 	discoverPages (rootLocation, list, low, high);
+	return list;
+}
+
+function <bool ()> MyDB_BPlusTreeReaderWriter :: buildRangeCheck (MyDB_RecordPtr forMe, MyDB_AttValPtr low, MyDB_AttValPtr high) {
 
-	// for various comparisons
-	MyDB_RecordPtr lhs = getEmptyRecord ();
-	MyDB_RecordPtr rhs = getEmptyRecord ();
-	MyDB_RecordPtr myRec = getEmptyRecord ();
 	MyDB_INRecordPtr llow = getINRecord ();
 	llow->setKey (low);
 	MyDB_INRecordPtr hhigh = getINRecord ();
 	hhigh->setKey (high);
 
-	// build the comparison functions
-	function <bool ()> comparator = buildComparator (lhs, rhs);
-	function <bool ()> lowComparator = buildComparator (myRec, llow);	
-	function <bool ()> highComparator = buildComparator (hhigh, myRec);	
-
-	// and build the iterator
-	return make_shared <MyDB_PageListIteratorSelfSortingAlt> (list, lhs, rhs, comparator, myRec, lowComparator, highComparator, false);	
+	// the record is in range if it is not below low, and high is not below it
+	function <bool ()> lowComparator = buildComparator (forMe, llow);	
+	function <bool ()> highComparator = buildComparator (hhigh, forMe);	
+	return [=] {return !lowComparator () && !highComparator ();};
 }
 
+string MyDB_BPlusTreeReaderWriter :: getOrderingAtt () {
+	return getTable ()->getSchema ()->getAtts ()[whichAttIsOrdering].first;
+}
 
 bool MyDB_BPlusTreeReaderWriter :: discoverPages (int whichPage, vector <MyDB_PageReaderWriter> &list,
 	MyDB_AttValPtr low, MyDB_AttValPtr high) {
@@ -91,40 +89,26 @@ bool MyDB_BPlusTreeReaderWriter :: discoverPages (int whichPage, vector <MyDB_Pa
 	// we have an internal node, so find the subtrees to seach
 	} else {
 
-		// iterate through the various subtrees
-		MyDB_RecordIteratorAltPtr temp = pageToSearch.getIteratorAlt ();
-
-		// set up all of the comparisons that we need
-		MyDB_INRecordPtr otherRec = getINRecord ();
-		MyDB_INRecordPtr llow = getINRecord ();
-		llow->setKey (low);
-		MyDB_INRecordPtr hhigh = getINRecord ();
-		hhigh->setKey (high);
-		function <bool ()> comparatorLow = buildComparator (otherRec, llow);
-		function <bool ()> comparatorHigh = buildComparator (hhigh, otherRec);
-
 		// if the low bound and the high bound are both engaged, then we are discovering records
 		bool lowEngaged = false;
 		bool highEngaged = true;
 		bool foundLeaf = false;
-		while (temp->advance ()) {
+		for (auto &entry : getEntries (pageToSearch)) {
 			
-			temp->getCurrent (otherRec);
-
-			if (!comparatorLow ()) 
+			if (!buildComparator (entry.first, low) ()) 
 				lowEngaged = true;
 
 			// see if the new key is less than the key in the directory record
 			if (lowEngaged && highEngaged) {
 				if (foundLeaf) {
-					list.push_back ((*this)[otherRec->getPtr ()]);
+					list.push_back ((*this)[entry.second]);
 
 				} else {
-					foundLeaf = discoverPages (otherRec->getPtr (), list, low, high);	
+					foundLeaf = discoverPages (entry.second, list, low, high);	
 				}
 			}
 
-			if (comparatorHigh ())
+			if (buildComparator (high, entry.first) ())
 				highEngaged = false;
 		}
 		return false;
@@ -134,6 +118,341 @@ bool MyDB_BPlusTreeReaderWriter :: discoverPages (int whichPage, vector <MyDB_Pa
 	return false;
 }
 
+int MyDB_BPlusTreeReaderWriter :: findLeaf (MyDB_AttValPtr low) {
+
+	MyDB_AttValPtr probe = orderingAttType->createAtt ();
+	function <bool ()> probeBelowLow = buildComparator (probe, low);
+	function <bool ()> notBelowLow = [&] {return !probeBelowLow ();};
+	vector <size_t> offsets;
+
+	// go down to the first subtree whose key is not below low, until we hit a leaf; there is always one,
+	// since the last key on each directory page is the largest possible key
+	int whichPage = rootLocation;
+	while (true) {
+		MyDB_PageReaderWriter page = (*this)[whichPage];
+		if (page.getType () == MyDB_PageType :: RegularPage)
+			return whichPage;
+
+		char *bytes = (char *) page.getBytes ();
+		whichPage = getPtr (bytes + findFirst (bytes, true, probe, notBelowLow, offsets));
+	}
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: lookup (MyDB_AttValPtr key, vector <char> &intoMe) {
+	return findKey (key, &intoMe);
+}
+
+bool MyDB_BPlusTreeReaderWriter :: contains (MyDB_AttValPtr key) {
+	return findKey (key, nullptr) != 0;
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: findKey (MyDB_AttValPtr key, vector <char> *intoMe) {
+
+	if (rootLocation == -1)
+		return 0;
+
+	MyDB_AttValPtr probe = orderingAttType->createAtt ();
+	function <bool ()> probeBelowKey = buildComparator (probe, key);
+	function <bool ()> keyBelowProbe = buildComparator (key, probe);
+	function <bool ()> notBelowKey = [&] {return !probeBelowKey ();};
+	vector <size_t> offsets;
+
+	// find the first record on the leaf that is not below the key
+	MyDB_PageReaderWriter page = (*this)[findLeaf (key)];
+	char *bytes = (char *) page.getBytes ();
+	size_t pos = findFirst (bytes, false, probe, notBelowKey, offsets);
+
+	// and take records until one is past the key; records with the same key can go on to the next leaves
+	size_t numFound = 0;
+	while (true) {
+		size_t bytesUsed = *((size_t *) (bytes + sizeof (size_t)));
+		for (; pos != bytesUsed; pos += *((short *) (bytes + pos))) {
+			probe->fromBinary (getKeyBytes (bytes + pos, false));
+			if (keyBelowProbe ())
+				return numFound;
+			numFound++;
+			if (intoMe == nullptr)
+				return numFound;
+			intoMe->insert (intoMe->end (), bytes + pos, bytes + pos + *((short *) (bytes + pos)));
+		}
+
+		int nextPage = page.getNextPage ();
+		if (nextPage == -1)
+			return numFound;
+		page = (*this)[nextPage];
+		bytes = (char *) page.getBytes ();
+		pos = sizeof (size_t) * 2;
+	}
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: findFirst (char *bytes, bool isDirectory, MyDB_AttValPtr probe, 
+	function <bool ()> &isAtOrPast, vector <size_t> &offsets) {
+
+	size_t headerSize = sizeof (size_t) * 2;
+	size_t bytesUsed = min (*((size_t *) (bytes + sizeof (size_t))), pageSize);
+	if (bytesUsed <= headerSize)
+		return headerSize;
+
+	// if every internal node record is the same size, we know where they all are; otherwise, find them
+	size_t recSize = 0, numRecs;
+	if (isDirectory && keyIsFixedSize) {
+		recSize = inRecSize;
+		numRecs = (bytesUsed - headerSize) / recSize;
+	} else {
+		offsets.clear ();
+		size_t first = isDirectory ? getFirstEntry (bytes) : headerSize;
+		if (first >= bytesUsed)
+			return bytesUsed;
+		for (size_t pos = first; pos != bytesUsed; pos += *((short *) (bytes + pos)))
+			offsets.push_back (pos);
+		numRecs = offsets.size ();
+	}
+
+	string scratch;
+	size_t low = 0, high = numRecs;
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		size_t offset = recSize != 0 ? headerSize + mid * recSize : offsets[mid];
+		loadKey (bytes, offset, isDirectory, probe, scratch);
+		if (isAtOrPast ())
+			high = mid;
+		else
+			low = mid + 1;
+	}
+
+	if (low == numRecs)
+		return bytesUsed;
+	return recSize != 0 ? headerSize + low * recSize : offsets[low];
+}
+
+char *MyDB_BPlusTreeReaderWriter :: getKeyBytes (char *rec, bool isDirectory) {
+
+	// the attributes come right after the size of the record, each one starting with its own size; the key
+	// is the first attribute of an internal node record
+	char *att = rec + sizeof (short);
+	if (!isDirectory) {
+		for (int i = 0; i < whichAttIsOrdering; i++)
+			att += *((short *) att);
+	}
+	return att;
+}
+
+int MyDB_BPlusTreeReaderWriter :: getPtr (char *rec) {
+
+	// the pointer is the last attribute of an internal node record, and an int is the last thing in it
+	return *((int *) (rec + *((short *) rec) - sizeof (int)));
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: getFirstEntry (char *bytes) {
+	size_t headerSize = sizeof (size_t) * 2;
+	return keyIsFixedSize ? headerSize : headerSize + *((short *) (bytes + headerSize));
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: getPreviousEntry (char *bytes, size_t offset) {
+
+	if (keyIsFixedSize)
+		return offset - inRecSize;
+
+	size_t previous = getFirstEntry (bytes);
+	for (size_t pos = previous; pos != offset; pos += *((short *) (bytes + pos)))
+		previous = pos;
+	return previous;
+}
+
+void MyDB_BPlusTreeReaderWriter :: loadKey (char *bytes, size_t offset, bool isDirectory, MyDB_AttValPtr intoMe, 
+	string &scratch) {
+
+	// a string key has its two byte length, then the characters, then a null
+	char *keyBytes = getKeyBytes (bytes + offset, isDirectory);
+	char *prefix = isDirectory && !keyIsFixedSize ? getKeyBytes (bytes + sizeof (size_t) * 2, true) : nullptr;
+	if (prefix == nullptr || *((short *) prefix) == sizeof (short) + 1) {
+		intoMe->fromBinary (keyBytes);
+		return;
+	}
+
+	scratch.assign (prefix + sizeof (short), *((short *) prefix) - sizeof (short) - 1);
+	scratch.append (keyBytes + sizeof (short), *((short *) keyBytes) - sizeof (short) - 1);
+	intoMe->fromString (scratch);
+}
+
+vector <pair <MyDB_AttValPtr, int>> MyDB_BPlusTreeReaderWriter :: getEntries (MyDB_PageReaderWriter page) {
+
+	vector <pair <MyDB_AttValPtr, int>> entries;
+	char *bytes = (char *) page.getBytes ();
+	size_t bytesUsed = *((size_t *) (bytes + sizeof (size_t)));
+	string scratch;
+	MyDB_AttValPtr key = orderingAttType->createAtt ();
+	for (size_t pos = getFirstEntry (bytes); pos != bytesUsed; pos += *((short *) (bytes + pos))) {
+
+		// a key loaded straight from the page still points at the page's bytes, so it is copied
+		loadKey (bytes, pos, true, key, scratch);
+		entries.push_back (make_pair (key->getCopy (), getPtr (bytes + pos)));
+	}
+	return entries;
+}
+
+void MyDB_BPlusTreeReaderWriter :: copyEntries (char *bytes, vector <char> &intoMe, size_t offset, MyDB_RecordPtr andMe) {
+
+	size_t bytesUsed = *((size_t *) (bytes + sizeof (size_t)));
+	char *prefix = keyIsFixedSize ? nullptr : getKeyBytes (bytes + sizeof (size_t) * 2, true);
+	short prefixLen = prefix == nullptr ? 0 : *((short *) prefix) - sizeof (short) - 1;
+	for (size_t pos = getFirstEntry (bytes); pos <= bytesUsed; pos += *((short *) (bytes + pos))) {
+		if (pos == offset && andMe != nullptr)
+			appendEntry (intoMe, andMe);
+		if (pos == bytesUsed)
+			break;
+
+		// put the prefix back on the key, which comes right after the size of the record
+		char *rec = bytes + pos;
+		size_t start = intoMe.size ();
+		intoMe.insert (intoMe.end (), rec, rec + *((short *) rec));
+		if (prefixLen != 0) {
+			char *at = intoMe.data () + start;
+			*((short *) at) += prefixLen;
+			*((short *) (at + sizeof (short))) += prefixLen;
+			intoMe.insert (intoMe.begin () + start + sizeof (short) * 2, prefix + sizeof (short), 
+				prefix + sizeof (short) + prefixLen);
+		}
+	}
+}
+
+void MyDB_BPlusTreeReaderWriter :: appendEntry (vector <char> &intoMe, MyDB_RecordPtr appendMe) {
+	size_t start = intoMe.size ();
+	intoMe.resize (start + appendMe->getBinarySize ());
+	appendMe->toBinary (intoMe.data () + start);
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: getCommonPrefix (char *lhs, char *rhs) {
+
+	if (keyIsFixedSize)
+		return 0;
+
+	char *lhKey = getKeyBytes (lhs, true);
+	char *rhKey = getKeyBytes (rhs, true);
+	size_t len = min (*((short *) lhKey), *((short *) rhKey)) - sizeof (short) - 1;
+	size_t common = 0;
+	while (common < len && lhKey[sizeof (short) + common] == rhKey[sizeof (short) + common])
+		common++;
+	return common;
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: getDirectorySize (char *entries, size_t numBytes, size_t lastEntry, 
+	size_t numEntries) {
+
+	size_t headerSize = sizeof (size_t) * 2;
+	if (keyIsFixedSize)
+		return headerSize + numBytes;
+
+	// the prefix record has the prefix as its key, then a pointer that is never used; the keys are sorted, so
+	// the prefix that they all share is the one shared by the first and the last
+	size_t prefixLen = numEntries == 0 ? 0 : getCommonPrefix (entries, entries + lastEntry);
+	size_t prefixRecSize = sizeof (short) * 3 + prefixLen + 1 + sizeof (int);
+	return headerSize + prefixRecSize + numBytes - numEntries * prefixLen;
+}
+
+bool MyDB_BPlusTreeReaderWriter :: writeEntries (MyDB_PageReaderWriter page, char *entries, size_t numBytes) {
+
+	// find the last entry, which with the first gives the prefix
+	size_t lastEntry = 0, numEntries = 0;
+	for (size_t pos = 0; pos != numBytes; pos += *((short *) (entries + pos))) {
+		lastEntry = pos;
+		numEntries++;
+	}
+	if (getDirectorySize (entries, numBytes, lastEntry, numEntries) > pageSize)
+		return false;
+
+	page.clear ();
+	page.setType (MyDB_PageType :: DirectoryPage);
+	if (keyIsFixedSize) {
+		page.appendBinary (entries, numBytes);
+		return true;
+	}
+
+	// write out the prefix record, and then each entry with the prefix taken off of its key
+	size_t prefixLen = numEntries == 0 ? 0 : getCommonPrefix (entries, entries + lastEntry);
+	char *prefix = getKeyBytes (entries, true) + sizeof (short);
+	vector <char> recs (sizeof (short) * 3 + prefixLen + 1 + sizeof (int));
+	char *at = recs.data ();
+	*((short *) at) = (short) recs.size ();
+	*((short *) (at + sizeof (short))) = (short) (sizeof (short) + prefixLen + 1);
+	memcpy (at + sizeof (short) * 2, prefix, prefixLen);
+	at[sizeof (short) * 2 + prefixLen] = 0;
+	*((short *) (at + sizeof (short) * 2 + prefixLen + 1)) = (short) (sizeof (short) + sizeof (int));
+	*((int *) (at + sizeof (short) * 3 + prefixLen + 1)) = -1;
+
+	recs.reserve (recs.size () + numBytes);
+	for (size_t pos = 0; pos != numBytes; pos += *((short *) (entries + pos))) {
+		char *rec = entries + pos;
+		size_t start = recs.size ();
+		recs.insert (recs.end (), rec, rec + sizeof (short) * 2);
+		recs.insert (recs.end (), rec + sizeof (short) * 2 + prefixLen, rec + *((short *) rec));
+		*((short *) (recs.data () + start)) -= prefixLen;
+		*((short *) (recs.data () + start + sizeof (short))) -= prefixLen;
+	}
+	page.appendBinary (recs.data (), recs.size ());
+	return true;
+}
+
+bool MyDB_BPlusTreeReaderWriter :: insertEntry (MyDB_PageReaderWriter page, size_t offset, MyDB_RecordPtr insertMe) {
+
+	if (keyIsFixedSize)
+		return page.insertAt (offset, insertMe);
+
+	// if the new key starts with the prefix, it just goes in with the prefix taken off
+	char *bytes = (char *) page.getBytes ();
+	char *prefix = getKeyBytes (bytes + sizeof (size_t) * 2, true);
+	size_t prefixLen = *((short *) prefix) - sizeof (short) - 1;
+	MyDB_INRecordPtr entry = static_pointer_cast <MyDB_INRecord> (insertMe);
+	string key = entry->getKey ()->toString ();
+	if (key.compare (0, prefixLen, prefix + sizeof (short), prefixLen) == 0) {
+		string suffix = key.substr (prefixLen);
+		MyDB_AttValPtr suffixAtt = orderingAttType->createAtt ();
+		suffixAtt->fromString (suffix);
+		MyDB_INRecordPtr shortEntry = getINRecord ();
+		shortEntry->setKey (suffixAtt);
+		shortEntry->setPtr (entry->getPtr ());
+		return page.insertAt (offset, shortEntry);
+	}
+
+	// otherwise, the page is written again with a shorter prefix
+	vector <char> entries;
+	copyEntries (bytes, entries, offset, insertMe);
+	return writeEntries (page, entries.data (), entries.size ());
+}
+
+MyDB_AttValPtr MyDB_BPlusTreeReaderWriter :: getSeparator (MyDB_AttValPtr low, MyDB_AttValPtr high) {
+
+	if (keyIsFixedSize)
+		return low;
+
+	// if the keys are the same, records with that key are on both leaves, so it has to be the separator
+	string lowStr = low->toString ();
+	string highStr = high->toString ();
+	if (!(lowStr < highStr))
+		return low;
+
+	// the first character where they differ (which high has, since it is the larger) is as far as it needs to go
+	size_t common = 0;
+	while (common < lowStr.size () && lowStr[common] == highStr[common])
+		common++;
+	string sep = highStr.substr (0, common + 1);
+	MyDB_AttValPtr res = orderingAttType->createAtt ();
+	res->fromString (sep);
+	return res;
+}
+
+int MyDB_BPlusTreeReaderWriter :: getRightmostLeaf (int whichPage) {
+
+	while (true) {
+		MyDB_PageReaderWriter page = (*this)[whichPage];
+		if (page.getType () == MyDB_PageType :: RegularPage)
+			return whichPage;
+
+		char *bytes = (char *) page.getBytes ();
+		whichPage = getPtr (bytes + getPreviousEntry (bytes, *((size_t *) (bytes + sizeof (size_t)))));
+	}
+}
+
 void MyDB_BPlusTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
 
 	// this file has never had any data in it, because the smallest B+-Tree has two pages
@@ -150,9 +469,9 @@ void MyDB_BPlusTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
 		getTable ()->setLastPage (1);
 
 		// add that internal node record in
-		root.clear ();
-		root.append (internalNodeRec);
-		root.setType (MyDB_PageType :: DirectoryPage);
+		vector <char> entries;
+		appendEntry (entries, internalNodeRec);
+		writeEntries (root, entries.data (), entries.size ());
 		
 		// and add the new record to the leaf
 		MyDB_PageReaderWriter leaf = (*this)[1];
@@ -163,8 +482,8 @@ void MyDB_BPlusTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	// this is a valid B+-Tree, so we can process the insert
 	} else {
 
-		// append the record into the tree
-		auto res = append (rootLocation, appendMe);
+		// append the record into the tree; nothing is to the left of the root
+		auto res = append (rootLocation, appendMe, -1);
 		
 		// see if the root split
 		if (res != nullptr) {
@@ -173,14 +492,14 @@ void MyDB_BPlusTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
 			int newRootLoc = getTable ()->lastPage () + 1;
 			getTable ()->setLastPage (newRootLoc);
 			MyDB_PageReaderWriter newRoot = (*this)[newRootLoc];
-			newRoot.clear ();
-			newRoot.setType (MyDB_PageType :: DirectoryPage);
 
 			// add the two records; the first points to the newly-created page, the second to the old root
-			newRoot.append (res);
+			vector <char> entries;
+			appendEntry (entries, res);
 			MyDB_INRecordPtr newRec = getINRecord ();
 			newRec->setPtr (rootLocation);
-			newRoot.append (newRec);
+			appendEntry (entries, newRec);
+			writeEntries (newRoot, entries.data (), entries.size ());
 
 			// and update the location of the root
 			rootLocation = newRootLoc;
@@ -189,68 +508,224 @@ void MyDB_BPlusTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	}
 }
 
+void MyDB_BPlusTreeReaderWriter :: bulkLoad (MyDB_TableReaderWriter &fromMe, int runSize, double fillFactor) {
+
+	// sort the input on the ordering attribute, and build the tree from the merged runs
+	MyDB_RecordPtr lhs = fromMe.getEmptyRecord ();
+	MyDB_RecordPtr rhs = fromMe.getEmptyRecord ();
+	string computation = "[" + getOrderingAtt () + "]";
+	MyDB_RecordIteratorAltPtr sorted = buildItertorOverSortedRuns (runSize, fromMe, 
+		buildRecordComparator (lhs, rhs, computation), lhs, rhs);
+	buildFromSorted (sorted, fillFactor);
+}
+
+void MyDB_BPlusTreeReaderWriter :: bulkLoad (MyDB_RecordIteratorAltPtr fromMe, int runSize, double fillFactor) {
+
+	MyDB_TablePtr scratchTable = make_shared <MyDB_Table> (getTable ()->getName () + "_bulkLoad", 
+		getTable ()->getStorageLoc () + ".bulkLoad", getTable ()->getSchema ());
+	MyDB_TableReaderWriter scratch (scratchTable, getBufferMgr ());
+	MyDB_RecordPtr rec = getEmptyRecord ();
+	while (fromMe->advance ()) {
+		fromMe->getCurrent (rec);
+		scratch.append (rec);
+	}
+
+	bulkLoad (scratch, runSize, fillFactor);
+	getBufferMgr ()->killTable (scratchTable);
+}
+
+pair <vector <MyDB_HyperLogLog>, size_t> MyDB_BPlusTreeReaderWriter :: loadFromTextFile (string fromMe) {
+
+	MyDB_TablePtr scratchTable = make_shared <MyDB_Table> (getTable ()->getName () + "_bulkLoad", 
+		getTable ()->getStorageLoc () + ".bulkLoad", getTable ()->getSchema ());
+	MyDB_TableReaderWriter scratch (scratchTable, getBufferMgr ());
+	auto res = scratch.loadFromTextFile (fromMe);
+
+	bulkLoad (scratch, BPLUS_LOAD_RUN_SIZE);
+	getBufferMgr ()->killTable (scratchTable);
+	return res;
+}
+
+void MyDB_BPlusTreeReaderWriter :: buildFromSorted (MyDB_RecordIteratorAltPtr sorted, double fillFactor) {
+
+	// the number of bytes of each page that can be filled; a page always gets at least one record (and a
+	// directory page at least two), no matter what the fill factor is
+	size_t pageSize = getBufferMgr ()->getPageSize ();
+	size_t headerSize = sizeof (size_t) * 2;
+	fillFactor = min (1.0, max (0.0, fillFactor));
+	size_t budget = headerSize + (size_t) (fillFactor * (pageSize - headerSize));
+
+	// the pages are written one after another, starting over at the front of the file
+	int nextPage = 0;
+	auto newPage = [&] (MyDB_PageType type) {
+		getTable ()->setLastPage (nextPage);
+		MyDB_PageReaderWriter page = (*this)[nextPage++];
+		page.clear ();
+		page.setType (type);
+		return page;
+	};
+
+	// pack the records into leaves, which are chained together in order, remembering the key that separates each
+	// leaf from the one after it
+	vector <pair <MyDB_AttValPtr, int>> children;
+	MyDB_RecordPtr lastRec = getEmptyRecord ();
+	MyDB_PageReaderWriter leaf;
+	size_t used = 0, lastOffset = 0;
+	auto finishLeaf = [&] () {
+		lastRec->fromBinary (((char *) leaf.getBytes ()) + lastOffset);
+		children.push_back (make_pair (getKey (lastRec), nextPage - 1));
+	};
+	while (sorted->advance ()) {
+		char *rec = (char *) sorted->getCurrentPointer ();
+		size_t len = *((short *) rec);
+		if (used == 0 || used + len > budget) {
+			if (used != 0) {
+				finishLeaf ();
+				leaf.setNextPage (nextPage);
+				leaf.writeBehind ();
+				lastRec->fromBinary (rec);
+				children.back ().first = getSeparator (children.back ().first, lastRec->getAtt (whichAttIsOrdering));
+			}
+			leaf = newPage (MyDB_PageType :: RegularPage);
+			used = headerSize;
+		}
+		if (leaf.appendBinary (rec, len) != len) {
+			cout << "Record of " << len << " bytes is too big for a page.\n";
+			exit (1);
+		}
+		lastOffset = used;
+		used += len;
+	}
+
+	// an empty tree is a single, empty leaf; append () still sees a one-page file as empty
+	if (used == 0) {
+		nextPage = 0;
+		newPage (MyDB_PageType :: RegularPage);
+		rootLocation = 0;
+		getTable ()->setRootLocation (rootLocation);
+		return;
+	}
+	finishLeaf ();
+
+	// now build the directory, a level at a time, until there is just one page at the top.  The last entry
+	// at each level has the largest possible key, so that anything appended later always has a subtree.  A
+	// page is full once its entries, with the prefix that they share taken off, go past the budget
+	MyDB_INRecordPtr inRec = getINRecord ();
+	do {
+		children.back ().first = orderingAttType->createAttMax ();
+		vector <pair <MyDB_AttValPtr, int>> parents;
+		vector <char> entries;
+		size_t count = 0;
+		auto finishDir = [&] (size_t numBytes, size_t lastChild) {
+			MyDB_PageReaderWriter dir = newPage (MyDB_PageType :: DirectoryPage);
+			if (!writeEntries (dir, entries.data (), numBytes)) {
+				cout << "Could not fit an internal node record on a page.\n";
+				exit (1);
+			}
+			dir.writeBehind ();
+			parents.push_back (make_pair (children[lastChild].first, nextPage - 1));
+		};
+		for (size_t i = 0; i < children.size (); i++) {
+			inRec->setKey (children[i].first);
+			inRec->setPtr (children[i].second);
+			size_t last = entries.size ();
+			appendEntry (entries, inRec);
+			if (count >= 2 && getDirectorySize (entries.data (), entries.size (), last, count + 1) > budget) {
+				finishDir (last, i - 1);
+				entries.erase (entries.begin (), entries.begin () + last);
+				count = 0;
+			}
+			count++;
+		}
+		finishDir (entries.size (), children.size () - 1);
+		children = parents;
+	} while (children.size () > 1);
+
+	rootLocation = children[0].second;
+	getTable ()->setRootLocation (rootLocation);
+}
+
 #define NUM_BYTES_USED *((size_t *) (((char *) temp) + sizeof (size_t)))
 
-MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe) {
+void MyDB_BPlusTreeReaderWriter :: appendBinary (vector <char> &recs) {
+
+	MyDB_RecordPtr temp = getEmptyRecord ();
+	for (size_t pos = 0; pos < recs.size (); pos += *((short *) &recs[pos])) {
+		temp->fromBinary (&recs[pos]);
+		append (temp);
+	}
+}
+
+MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe, size_t offset) {
 	
-	// get a new page for the lower one half
+	// get a new page for the lower one half; it is pinned, so that it stays put while it is filled, even if
+	// other threads are using the buffer
 	int newPageLoc = getTable ()->lastPage () + 1;
 	getTable ()->setLastPage (newPageLoc);
-	MyDB_PageReaderWriter newPage = (*this)[newPageLoc];
-
-	// remember the type of this page so we can re-create it after the clear
-	MyDB_PageType myType;
-
-	// get a couple of records and a comparator so that we can sort
-	MyDB_RecordPtr lhs, rhs;
-	if (splitMe.getType () == MyDB_PageType :: RegularPage) {
-		lhs = getEmptyRecord ();
-		rhs = getEmptyRecord ();
-		myType = MyDB_PageType :: RegularPage;
-	} else if (splitMe.getType () == MyDB_PageType :: DirectoryPage) {
-		lhs = getINRecord ();
-		rhs = getINRecord ();
-		myType = MyDB_PageType :: DirectoryPage;
+	MyDB_PageReaderWriter newPage (true, *this, newPageLoc);
+
+	// get the record to return
+	MyDB_INRecordPtr returnVal = getINRecord ();
+	returnVal->setPtr (newPageLoc);
+
+	// a directory page is split on its entries with their whole keys, since each half gets its own prefix; the
+	// median goes into the new page, and it is the key for the new page
+	MyDB_PageType myType = splitMe.getType ();
+	if (myType == MyDB_PageType :: DirectoryPage) {
+		vector <char> entries;
+		copyEntries ((char *) splitMe.getBytes (), entries, offset, andMe);
+		vector <size_t> positions;
+		for (size_t pos = 0; pos != entries.size (); pos += *((short *) (entries.data () + pos)))
+			positions.push_back (pos);
+
+		size_t median = positions[positions.size () / 2];
+		MyDB_INRecordPtr medianRec = getINRecord ();
+		medianRec->fromBinary (entries.data () + median);
+		returnVal->setKey (getKey (medianRec));
+
+		size_t upper = median + *((short *) (entries.data () + median));
+		writeEntries (newPage, entries.data (), upper);
+		writeEntries (splitMe, entries.data () + upper, entries.size () - upper);
+		return returnVal;
 	}
-	function <bool ()> comparator = buildComparator (lhs, rhs);	
+
+	// remember the page after this one, so we can re-create the link after the clear
+	int nextPage = splitMe.getNextPage ();
+
+	// get a record to read the records on the page with
+	MyDB_RecordPtr lhs = getEmptyRecord ();
 
 	// temp memory to hold all of the records
 	void *temp = malloc (splitMe.getPageSize ());
 	memcpy (temp, splitMe.getBytes (), splitMe.getPageSize ());
 
-	// positions of the records
-	vector <void *> positions;
+	// and space for the new guy
+	void *spaceForLastGuy = malloc (andMe->getBinarySize ());
+	andMe->toBinary (spaceForLastGuy);
 
-	// compute where all of the records are located
-	int bytesConsumed = sizeof (size_t) * 2;
+	// compute where all of the records are located; they are already in order, and the new guy goes
+	// in at the given offset
+	vector <void *> positions;
+	size_t bytesConsumed = sizeof (size_t) * 2;
 	while (bytesConsumed != NUM_BYTES_USED) {
+		if (bytesConsumed == offset)
+			positions.push_back (spaceForLastGuy);
 		void *pos = bytesConsumed + (char *) temp;
 		positions.push_back (pos);
-		void *nextPos = lhs->fromBinary (pos);
-		bytesConsumed += ((char *) nextPos) - ((char *) pos);
+		bytesConsumed += *((short *) pos);
 	}
-	
-	// and get a postition for the last guy
-	void *spaceForLastGuy = malloc (andMe->getBinarySize ());
-	andMe->toBinary (spaceForLastGuy);
-	positions.push_back (spaceForLastGuy);
-
-	// now sort
-	RecordComparator myComparator (comparator, lhs, rhs);
-	std::stable_sort (positions.begin (), positions.end (), myComparator);
+	if (offset == NUM_BYTES_USED)
+		positions.push_back (spaceForLastGuy);
 
-	// get the record to return
-	MyDB_INRecordPtr returnVal = getINRecord ();
-	returnVal->setPtr (newPageLoc);
-
-	// clear the pages
+	// clear the pages; the new page comes right before the old one in the chain
 	newPage.clear ();
 	splitMe.clear ();
 	newPage.setType (myType);
 	splitMe.setType (myType);
+	splitMe.setNextPage (nextPage);
 
 	// and copy the data over
-	int counter = 0;
+	size_t counter = 0;
 	for (void *pos : positions) {
 
 		// low data goes into the new page
@@ -258,11 +733,14 @@ MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: split (MyDB_PageReaderWriter splitM
 		if (counter < positions.size () / 2) 
 			newPage.append (lhs);
 
-		// median goes into the old page
+		// median goes into the new page; all that the key for the new page has to do is come between it and
+		// the record after it
 		if (counter == positions.size () / 2) {
 			newPage.append (lhs);
 			returnVal->setKey (getKey (lhs));
 		}
+		if (counter == positions.size () / 2 + 1)
+			returnVal->setKey (getSeparator (returnVal->getKey (), lhs->getAtt (whichAttIsOrdering)));
 
 		// high data goes into the old page
 		if (counter > positions.size () / 2)
@@ -278,7 +756,7 @@ MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: split (MyDB_PageReaderWriter splitM
 
 }
 
-MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: append (int whichPage, MyDB_RecordPtr appendMe) {
+MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: append (int whichPage, MyDB_RecordPtr appendMe, int leftOfMe) {
 
 	// figure out the page to add to
 	MyDB_PageReaderWriter pageToAddTo = (*this)[whichPage];
@@ -286,47 +764,51 @@ MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: append (int whichPage, MyDB_RecordP
 	// it is a regular page (data page)
 	if (pageToAddTo.getType () == MyDB_PageType :: RegularPage) {
 
-		// if we can fit the new guy, we are good
-		if (pageToAddTo.append (appendMe)) {
+		// find where the new guy goes to keep the page in order; if we can fit him, we are good
+		MyDB_RecordPtr onPage = getEmptyRecord ();
+		size_t offset = pageToAddTo.findInsertPoint (buildComparator (appendMe, onPage), onPage);
+		if (pageToAddTo.insertAt (offset, appendMe)) {
 			return nullptr;
 		}
 
-		// if we cannot, then split the page
-		return split (pageToAddTo, appendMe);	
+		// if we cannot, then split the page; the new page goes into the chain of leaves right before
+		// this one, after the last leaf of the subtree to the left (if there is one)
+		MyDB_RecordPtr res = split (pageToAddTo, appendMe, offset);
+		int newPageLoc = static_pointer_cast <MyDB_INRecord> (res)->getPtr ();
+		(*this)[newPageLoc].setNextPage (whichPage);
+		if (leftOfMe != -1)
+			(*this)[getRightmostLeaf (leftOfMe)].setNextPage (newPageLoc);
+		return res;
 		
 	// we have an internal node, so find the subtree to insert into
 	} else {
 
-		// iterate through the various subtrees
-		MyDB_RecordIteratorAltPtr temp = pageToAddTo.getIteratorAlt ();
-		MyDB_INRecordPtr otherRec = getINRecord ();
-		function <bool ()> comparator = buildComparator (appendMe, otherRec);
-		while (temp->advance ()) {
-			
-			// see if the new key is less than the key in the directory record
-			temp->getCurrent (otherRec);
-			if (comparator ()) {
-
-				// recursively append
-				auto res = append (otherRec->getPtr (), appendMe);
+		// find the first subtree whose key the new key is less than; the one to the left of it is the one
+		// whose entry comes right before
+		MyDB_AttValPtr probe = orderingAttType->createAtt ();
+		function <bool ()> appendBelowProbe = buildComparator (appendMe->getAtt (whichAttIsOrdering), probe);
+		vector <size_t> offsets;
+		char *bytes = (char *) pageToAddTo.getBytes ();
+		size_t offset = findFirst (bytes, true, probe, appendBelowProbe, offsets);
+		if (offset == *((size_t *) (bytes + sizeof (size_t))))
+			return nullptr;
+		int leftOfChild = offset == getFirstEntry (bytes) ? leftOfMe : getPtr (bytes + getPreviousEntry (bytes, offset));
 
-				// we got a child split
-				if (res != nullptr) {
+		// recursively append; only the offset is kept, since the page may be swapped out by the recursive call
+		auto res = append (getPtr (bytes + offset), appendMe, leftOfChild);
 
-					// attempt to add the new one	
-					if (pageToAddTo.append (res)) {
-						MyDB_INRecordPtr otherRec = getINRecord ();
-						function <bool ()> comparator = buildComparator (res, otherRec);	
-						pageToAddTo.sortInPlace (comparator, res, otherRec);
-						return nullptr;
-					}
+		// we got a child split; the new record goes right before the one for the child, since the new
+		// page has the lower half of the child's records
+		if (res != nullptr) {
 
-					// could not fit the new one, so split it
-					return split (pageToAddTo, res);
-				}
+			// attempt to add the new one	
+			if (insertEntry (pageToAddTo, offset, res)) 
 				return nullptr;
-			}
+
+			// could not fit the new one, so split it
+			return split (pageToAddTo, res, offset);
 		}
+		return nullptr;
 	}
 
 	// note, we should never get here
@@ -361,11 +843,11 @@ void MyDB_BPlusTreeReaderWriter :: printTree (int whichPage, int depth) {
 	} else {
 
 		MyDB_INRecordPtr myRec = getINRecord ();
-		MyDB_RecordIteratorAltPtr temp = pageToPrint.getIteratorAlt ();
-		while (temp->advance ()) {
+		for (auto &entry : getEntries (pageToPrint)) {
 			
-			temp->getCurrent (myRec);
-			printTree (myRec->getPtr (), depth + 1);
+			myRec->setKey (entry.first);
+			myRec->setPtr (entry.second);
+			printTree (entry.second, depth + 1);
 			for (int i = 0; i < depth; i++)
 				cout << "\t";
 			cout << (MyDB_RecordPtr) myRec << "\n";
@@ -373,6 +855,32 @@ void MyDB_BPlusTreeReaderWriter :: printTree (int whichPage, int depth) {
 	}
 }
 
+void MyDB_BPlusTreeReaderWriter :: getShape (int &height, size_t &numDirPages, double &fanOut) {
+
+	height = 0;
+	numDirPages = 0;
+	size_t numEntries = 0;
+	if (rootLocation != -1)
+		getShape (rootLocation, 1, height, numDirPages, numEntries);
+	fanOut = numDirPages == 0 ? 0 : ((double) numEntries) / numDirPages;
+}
+
+void MyDB_BPlusTreeReaderWriter :: getShape (int whichPage, int depth, int &height, size_t &numDirPages, 
+	size_t &numEntries) {
+
+	MyDB_PageReaderWriter page = (*this)[whichPage];
+	if (page.getType () == MyDB_PageType :: RegularPage) {
+		height = max (height, depth);
+		return;
+	}
+
+	auto entries = getEntries (page);
+	numDirPages++;
+	numEntries += entries.size ();
+	for (auto &entry : entries)
+		getShape (entry.second, depth + 1, height, numDirPages, numEntries);
+}
+
 MyDB_AttValPtr MyDB_BPlusTreeReaderWriter :: getKey (MyDB_RecordPtr fromMe) {
 
 	MyDB_AttValPtr source;
@@ -408,7 +916,12 @@ function <bool ()>  MyDB_BPlusTreeReaderWriter :: buildComparator (MyDB_RecordPt
 		rhAtt = rhs->getAtt (whichAttIsOrdering);
 	}
 	
-	// now, build the comparison lambda and return
+	return buildComparator (lhAtt, rhAtt);
+}
+
+function <bool ()>  MyDB_BPlusTreeReaderWriter :: buildComparator (MyDB_AttValPtr lhAtt, MyDB_AttValPtr rhAtt) {
+
+	// build the comparison lambda and return
 	if (orderingAttType->promotableToInt ()) {
 		return [lhAtt, rhAtt] {return lhAtt->toInt () < rhAtt->toInt ();};
 	} else if (orderingAttType->promotableToDouble ()) {
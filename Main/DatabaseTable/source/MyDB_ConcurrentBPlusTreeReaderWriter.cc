@@ -0,0 +1,592 @@
+
+#ifndef CONCURRENT_BPLUS_C
+#define CONCURRENT_BPLUS_C
+
+#include <iostream>
+#include "MyDB_ConcurrentBPlusTreeReaderWriter.h"
+#include "MyDB_INRecord.h"
+#include "MyDB_LeafCopyIteratorAlt.h"
+#include <string.h>
+#include <thread>
+
+// where a range scan is in the leaves
+struct MyDB_ConcurrentBPlusTreeReaderWriter :: ScanState {
+
+	// the key of each record looked at is loaded into probe, to test it against the range
+	MyDB_AttValPtr probe;
+	function <bool ()> notBelowLow;
+	function <bool ()> highBelowProbe;
+
+	// the key of the last record handed out (its bytes are kept in lastKeyBytes), and how many records with
+	// that key have been handed out; a scan that has to start over picks up right after them
+	bool haveLast;
+	vector <char> lastKeyBytes;
+	MyDB_AttValPtr lastKey;
+	function <bool ()> notBelowLast;
+	function <bool ()> lastBelowProbe;
+	size_t numAtLast;
+
+	// the last leaf copied (or -1, if the scan has to find its place from the root), the version it was
+	// copied at, and the leaf after it
+	int leaf;
+	uint64_t version;
+	int nextLeaf;
+	bool done;
+
+	// space for copies of pages
+	vector <char> leafCopy;
+	vector <char> scratch;
+	vector <size_t> offsets;
+};
+
+MyDB_ConcurrentBPlusTreeReaderWriter :: MyDB_ConcurrentBPlusTreeReaderWriter (string orderOnAttName, MyDB_TablePtr forMe,
+	MyDB_BufferManagerPtr myBuffer) : MyDB_BPlusTreeReaderWriter (orderOnAttName, forMe, myBuffer) {
+
+	if (!myBuffer->isThreadSafe ()) {
+		cout << "A concurrent B+-Tree needs a thread safe buffer manager.\n";
+		exit (1);
+	}
+
+	for (auto &chunk : versions)
+		chunk = nullptr;
+	numRestarts = 0;
+}
+
+MyDB_ConcurrentBPlusTreeReaderWriter :: ~MyDB_ConcurrentBPlusTreeReaderWriter () {
+	for (auto &chunk : versions)
+		delete [] chunk.load ();
+}
+
+size_t MyDB_ConcurrentBPlusTreeReaderWriter :: getNumRestarts () {
+	return numRestarts;
+}
+
+MyDB_PageReaderWriter MyDB_ConcurrentBPlusTreeReaderWriter :: getNode (int whichPage) {
+	MyDB_PageReaderWriter page (true, *this, whichPage);
+	return page;
+}
+
+atomic <uint64_t> &MyDB_ConcurrentBPlusTreeReaderWriter :: getVersion (int whichPage) {
+
+	size_t whichChunk = whichPage / CONCURRENT_BPLUS_CHUNK_SIZE;
+	if (whichChunk >= CONCURRENT_BPLUS_MAX_CHUNKS) {
+		cout << "Too many pages for a concurrent B+-Tree.\n";
+		exit (1);
+	}
+
+	// if two threads create the chunk at once, the one that loses throws its chunk away
+	atomic <uint64_t> *chunk = versions[whichChunk];
+	if (chunk == nullptr) {
+		atomic <uint64_t> *newChunk = new atomic <uint64_t>[CONCURRENT_BPLUS_CHUNK_SIZE];
+		for (size_t i = 0; i < CONCURRENT_BPLUS_CHUNK_SIZE; i++)
+			newChunk[i] = 0;
+		if (versions[whichChunk].compare_exchange_strong (chunk, newChunk))
+			chunk = newChunk;
+		else
+			delete [] newChunk;
+	}
+	return chunk[whichPage % CONCURRENT_BPLUS_CHUNK_SIZE];
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: readLock (int whichPage, uint64_t &version) {
+	version = getVersion (whichPage);
+	return (version & CONCURRENT_BPLUS_LOCKED) == 0;
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: validate (int whichPage, uint64_t version) {
+	return getVersion (whichPage) == version;
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: upgradeLock (int whichPage, uint64_t version) {
+	return getVersion (whichPage).compare_exchange_strong (version, version + CONCURRENT_BPLUS_LOCKED);
+}
+
+void MyDB_ConcurrentBPlusTreeReaderWriter :: writeLock (int whichPage) {
+	uint64_t version;
+	while (!readLock (whichPage, version) || !upgradeLock (whichPage, version))
+		this_thread :: yield ();
+}
+
+void MyDB_ConcurrentBPlusTreeReaderWriter :: writeUnlock (int whichPage) {
+	getVersion (whichPage) += CONCURRENT_BPLUS_LOCKED;
+}
+
+void MyDB_ConcurrentBPlusTreeReaderWriter :: writeUnlockUnchanged (int whichPage, uint64_t version) {
+	getVersion (whichPage) = version;
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: copyNode (int whichPage, uint64_t version, vector <char> &intoMe) {
+
+	// the number of bytes used is not to be trusted until the copy is checked, so it is kept on the page
+	MyDB_PageReaderWriter page = getNode (whichPage);
+	char *bytes = (char *) page.getBytes ();
+	size_t bytesUsed = *((size_t *) (bytes + sizeof (size_t)));
+	bytesUsed = max (sizeof (size_t) * 2, min (bytesUsed, pageSize));
+	intoMe.assign (bytes, bytes + bytesUsed);
+	return validate (whichPage, version);
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: findLeafOptimistic (MyDB_AttValPtr probe, function <bool ()> &isAtOrPast,
+	vector <char> &scratch, vector <size_t> &offsets, int &leaf, uint64_t &version) {
+
+	// the root may move while its version is being noted, so check that it is still the root after
+	int whichPage = rootLocation;
+	leaf = -1;
+	if (whichPage == -1)
+		return true;
+	if (!readLock (whichPage, version) || rootLocation != whichPage)
+		return false;
+
+	while (true) {
+
+		// a leaf is checked by the caller, when it copies it or locks it
+		MyDB_PageReaderWriter page = getNode (whichPage);
+		char *bytes = (char *) page.getBytes ();
+		MyDB_PageType type = *((MyDB_PageType *) bytes);
+		if (type == MyDB_PageType :: RegularPage) {
+			leaf = whichPage;
+			return true;
+		} else if (type != MyDB_PageType :: DirectoryPage) {
+			return false;
+		}
+
+		// internal node records that are all the same size are searched right on the page, since findFirst never
+		// goes off of it; otherwise, the page is copied and checked first
+		size_t bytesUsed = pageSize;
+		if (!keyIsFixedSize) {
+			if (!copyNode (whichPage, version, scratch))
+				return false;
+			bytes = scratch.data ();
+			bytesUsed = scratch.size ();
+		}
+		size_t offset = findFirst (bytes, true, probe, isAtOrPast, offsets);
+		if (offset >= bytesUsed)
+			return false;
+		size_t recSize = keyIsFixedSize ? inRecSize : *((short *) (bytes + offset));
+		if (offset + recSize > bytesUsed || recSize < sizeof (int))
+			return false;
+		int child = *((int *) (bytes + offset + recSize - sizeof (int)));
+
+		// the child is only the right one if the page has not changed, both before its version is noted (so
+		// the page number is good) and after (so the version is of the right page)
+		uint64_t childVersion;
+		if (!validate (whichPage, version) || !readLock (child, childVersion) || !validate (whichPage, version))
+			return false;
+		whichPage = child;
+		version = childVersion;
+	}
+}
+
+void MyDB_ConcurrentBPlusTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
+
+	if (rootLocation == -1)
+		createRoot ();
+
+	MyDB_AttValPtr probe = orderingAttType->createAtt ();
+	function <bool ()> keyBelowProbe = buildComparator (appendMe->getAtt (whichAttIsOrdering), probe);
+	MyDB_RecordPtr onPage = getEmptyRecord ();
+	function <bool ()> comparator = buildComparator (appendMe, onPage);
+	vector <char> scratch;
+	vector <size_t> offsets;
+
+	// find the leaf and lock it; it is the right leaf if it has not changed since it was found
+	while (true) {
+		int leaf;
+		uint64_t version;
+		if (!findLeafOptimistic (probe, keyBelowProbe, scratch, offsets, leaf, version) || !upgradeLock (leaf, version)) {
+			numRestarts++;
+			this_thread :: yield ();
+			continue;
+		}
+
+		MyDB_PageReaderWriter page = getNode (leaf);
+		if (page.insertAt (page.findInsertPoint (comparator, onPage), appendMe)) {
+			writeUnlock (leaf);
+			return;
+		}
+		writeUnlockUnchanged (leaf, version);
+		break;
+	}
+
+	// the leaf is full
+	splitAndAppend (appendMe);
+}
+
+void MyDB_ConcurrentBPlusTreeReaderWriter :: createRoot () {
+
+	lock_guard <mutex> guard (splitLatch);
+	if (rootLocation != -1)
+		return;
+
+	// just like the first append to a MyDB_BPlusTreeReaderWriter, except that the pages are pinned
+	getTable ()->setLastPage (1);
+	MyDB_PageReaderWriter root = getNode (0);
+	MyDB_INRecordPtr internalNodeRec = getINRecord ();
+	internalNodeRec->setPtr (1);
+	vector <char> entries;
+	appendEntry (entries, internalNodeRec);
+	writeEntries (root, entries.data (), entries.size ());
+
+	MyDB_PageReaderWriter leaf = getNode (1);
+	leaf.clear ();
+	leaf.setType (MyDB_PageType :: RegularPage);
+
+	getTable ()->setRootLocation (0);
+	rootLocation = 0;
+}
+
+void MyDB_ConcurrentBPlusTreeReaderWriter :: splitAndAppend (MyDB_RecordPtr appendMe) {
+
+	lock_guard <mutex> guard (splitLatch);
+
+	// go down to the leaf; only splits change directory pages, so they can be read without locking them.  Remember
+	// the path, where the record for each page on it is in its parent, and the root of the subtree to the left
+	MyDB_AttValPtr probe = orderingAttType->createAtt ();
+	function <bool ()> appendBelowProbe = buildComparator (appendMe->getAtt (whichAttIsOrdering), probe);
+	vector <int> path;
+	vector <size_t> offsets, scratch;
+	int leftOfMe = -1;
+	int whichPage = rootLocation;
+	while (true) {
+		path.push_back (whichPage);
+		MyDB_PageReaderWriter page = getNode (whichPage);
+		if (page.getType () == MyDB_PageType :: RegularPage)
+			break;
+
+		char *bytes = (char *) page.getBytes ();
+		size_t offset = findFirst (bytes, true, probe, appendBelowProbe, scratch);
+		if (offset != getFirstEntry (bytes))
+			leftOfMe = getPtr (bytes + getPreviousEntry (bytes, offset));
+		offsets.push_back (offset);
+		whichPage = getPtr (bytes + offset);
+	}
+
+	// another split may have made room while this one waited for the latch
+	int leaf = path.back ();
+	writeLock (leaf);
+	MyDB_PageReaderWriter page = getNode (leaf);
+	MyDB_RecordPtr onPage = getEmptyRecord ();
+	size_t offset = page.findInsertPoint (buildComparator (appendMe, onPage), onPage);
+	if (page.insertAt (offset, appendMe)) {
+		writeUnlock (leaf);
+		return;
+	}
+
+	// the new page goes into the chain of leaves right before this one, after the last leaf of the subtree to the
+	// left (if there is one); that leaf is locked as well, since its link changes
+	vector <int> locked {leaf};
+	int before = leftOfMe == -1 ? -1 : getRightmostLeaf (leftOfMe);
+	if (before != -1) {
+		writeLock (before);
+		locked.push_back (before);
+	}
+	MyDB_RecordPtr res = split (page, appendMe, offset);
+	int newPageLoc = static_pointer_cast <MyDB_INRecord> (res)->getPtr ();
+	getNode (newPageLoc).setNextPage (leaf);
+	if (before != -1)
+		getNode (before).setNextPage (newPageLoc);
+
+	// add the new page to the directory, going up the path for as long as the pages split.  Each page is locked
+	// before the page below it is unlocked, so that no reader sees a child that its parent does not agree with
+	for (int i = (int) path.size () - 2; i >= 0 && res != nullptr; i--) {
+		writeLock (path[i]);
+		locked.push_back (path[i]);
+		MyDB_PageReaderWriter parent = getNode (path[i]);
+		if (insertEntry (parent, offsets[i], res))
+			res = nullptr;
+		else
+			res = split (parent, res, offsets[i]);
+	}
+
+	// if the root split, there is a new root above it; the old root is still locked, so a reader that got to it
+	// before the root moved starts over
+	if (res != nullptr) {
+		int newRootLoc = getTable ()->lastPage () + 1;
+		getTable ()->setLastPage (newRootLoc);
+		MyDB_PageReaderWriter newRoot = getNode (newRootLoc);
+		vector <char> entries;
+		appendEntry (entries, res);
+		MyDB_INRecordPtr newRec = getINRecord ();
+		newRec->setPtr (rootLocation);
+		appendEntry (entries, newRec);
+		writeEntries (newRoot, entries.data (), entries.size ());
+		getTable ()->setRootLocation (newRootLoc);
+		rootLocation = newRootLoc;
+	}
+
+	for (int whichPage : locked)
+		writeUnlock (whichPage);
+}
+
+int MyDB_ConcurrentBPlusTreeReaderWriter :: getRightmostLeaf (int whichPage) {
+
+	while (true) {
+		MyDB_PageReaderWriter page = getNode (whichPage);
+		if (page.getType () == MyDB_PageType :: RegularPage)
+			return whichPage;
+
+		char *bytes = (char *) page.getBytes ();
+		whichPage = getPtr (bytes + getPreviousEntry (bytes, *((size_t *) (bytes + sizeof (size_t)))));
+	}
+}
+
+size_t MyDB_ConcurrentBPlusTreeReaderWriter :: lookup (MyDB_AttValPtr key, vector <char> &intoMe) {
+	size_t startSize = intoMe.size ();
+	size_t numFound;
+	while (!tryFindKey (key, &intoMe, numFound)) {
+		intoMe.resize (startSize);
+		numRestarts++;
+		this_thread :: yield ();
+	}
+	return numFound;
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: contains (MyDB_AttValPtr key) {
+	size_t numFound;
+	while (!tryFindKey (key, nullptr, numFound)) {
+		numRestarts++;
+		this_thread :: yield ();
+	}
+	return numFound != 0;
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: tryFindKey (MyDB_AttValPtr key, vector <char> *intoMe, size_t &numFound) {
+
+	numFound = 0;
+	MyDB_AttValPtr probe = orderingAttType->createAtt ();
+	function <bool ()> probeBelowKey = buildComparator (probe, key);
+	function <bool ()> keyBelowProbe = buildComparator (key, probe);
+	function <bool ()> notBelowKey = [&] {return !probeBelowKey ();};
+	vector <char> copy;
+	vector <size_t> offsets;
+
+	// find the first record on the leaf that is not below the key
+	int leaf;
+	uint64_t version;
+	if (!findLeafOptimistic (probe, notBelowKey, copy, offsets, leaf, version))
+		return false;
+	if (leaf == -1)
+		return true;
+	if (!copyNode (leaf, version, copy))
+		return false;
+	size_t pos = findFirst (copy.data (), false, probe, notBelowKey, offsets);
+
+	// and take records until one is past the key; records with the same key can go on to the next leaves
+	while (true) {
+		for (; pos != copy.size (); pos += *((short *) (copy.data () + pos))) {
+			probe->fromBinary (getKeyBytes (copy.data () + pos, false));
+			if (keyBelowProbe ())
+				return true;
+			numFound++;
+			if (intoMe == nullptr)
+				return true;
+			intoMe->insert (intoMe->end (), copy.data () + pos, copy.data () + pos + *((short *) (copy.data () + pos)));
+		}
+
+		// the link to the next leaf is only good if this leaf has not changed since its version was noted
+		int nextLeaf = *((int *) (copy.data () + sizeof (MyDB_PageType)));
+		if (nextLeaf == -1)
+			return true;
+		uint64_t nextVersion;
+		if (!readLock (nextLeaf, nextVersion) || !validate (leaf, version) || !copyNode (nextLeaf, nextVersion, copy))
+			return false;
+		leaf = nextLeaf;
+		version = nextVersion;
+		pos = sizeof (size_t) * 2;
+	}
+}
+
+MyDB_RecordIteratorAltPtr MyDB_ConcurrentBPlusTreeReaderWriter :: getSortedRangeIteratorAlt (MyDB_AttValPtr low,
+	MyDB_AttValPtr high) {
+
+	shared_ptr <ScanState> scan = make_shared <ScanState> ();
+	scan->probe = orderingAttType->createAtt ();
+	function <bool ()> probeBelowLow = buildComparator (scan->probe, low);
+	scan->notBelowLow = [probeBelowLow] {return !probeBelowLow ();};
+	scan->highBelowProbe = buildComparator (high, scan->probe);
+	scan->haveLast = false;
+	scan->lastKey = orderingAttType->createAtt ();
+	function <bool ()> probeBelowLast = buildComparator (scan->probe, scan->lastKey);
+	scan->notBelowLast = [probeBelowLast] {return !probeBelowLast ();};
+	scan->lastBelowProbe = buildComparator (scan->lastKey, scan->probe);
+	scan->numAtLast = 0;
+	scan->leaf = -1;
+	scan->done = false;
+
+	return make_shared <MyDB_LeafCopyIteratorAlt> ([this, scan] (vector <char> &intoMe) {
+		while (!scan->done) {
+			if (!tryScan (*scan, intoMe)) {
+				scan->leaf = -1;
+				numRestarts++;
+				this_thread :: yield ();
+			} else if (intoMe.size () != 0) {
+				return true;
+			}
+		}
+		return false;
+	});
+}
+
+MyDB_RecordIteratorAltPtr MyDB_ConcurrentBPlusTreeReaderWriter :: getRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
+	return getSortedRangeIteratorAlt (low, high);
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: tryScan (ScanState &scan, vector <char> &intoMe) {
+
+	intoMe.clear ();
+	size_t pos, numToSkip = 0;
+
+	// the scan finds its place from the root: right after the last record that it handed out, or at the start of
+	// the range.  Records with the same key stay in the order they were appended in, so the ones that were handed
+	// out already are the first numAtLast with the last key
+	if (scan.leaf == -1) {
+		function <bool ()> &isAtOrPast = scan.haveLast ? scan.notBelowLast : scan.notBelowLow;
+		int leaf;
+		uint64_t version;
+		if (!findLeafOptimistic (scan.probe, isAtOrPast, scan.scratch, scan.offsets, leaf, version))
+			return false;
+		if (leaf == -1) {
+			scan.done = true;
+			return true;
+		}
+		if (!copyNode (leaf, version, scan.leafCopy))
+			return false;
+		pos = findFirst (scan.leafCopy.data (), false, scan.probe, isAtOrPast, scan.offsets);
+		numToSkip = scan.haveLast ? scan.numAtLast : 0;
+		scan.leaf = leaf;
+		scan.version = version;
+
+	// otherwise, it goes on to the next leaf, as long as the link to it is still good
+	} else {
+		if (scan.nextLeaf == -1) {
+			scan.done = true;
+			return true;
+		}
+		uint64_t version;
+		if (!readLock (scan.nextLeaf, version) || !validate (scan.leaf, scan.version) ||
+			!copyNode (scan.nextLeaf, version, scan.leafCopy))
+			return false;
+		pos = sizeof (size_t) * 2;
+		scan.leaf = scan.nextLeaf;
+		scan.version = version;
+	}
+
+	// the copy has been checked, so it can be trusted from here on
+	char *bytes = scan.leafCopy.data ();
+	scan.nextLeaf = *((int *) (bytes + sizeof (MyDB_PageType)));
+	for (; pos != scan.leafCopy.size (); pos += *((short *) (bytes + pos))) {
+		char *keyBytes = getKeyBytes (bytes + pos, false);
+		scan.probe->fromBinary (keyBytes);
+		if (scan.highBelowProbe ()) {
+			scan.done = true;
+			return true;
+		}
+
+		bool isLast = scan.haveLast && !scan.lastBelowProbe ();
+		if (numToSkip != 0 && isLast) {
+			numToSkip--;
+			continue;
+		}
+		numToSkip = 0;
+
+		intoMe.insert (intoMe.end (), bytes + pos, bytes + pos + *((short *) (bytes + pos)));
+		if (isLast) {
+			scan.numAtLast++;
+		} else {
+			scan.lastKeyBytes.assign (keyBytes, keyBytes + *((short *) keyBytes));
+			scan.lastKey->fromBinary (scan.lastKeyBytes.data ());
+			scan.numAtLast = 1;
+			scan.haveLast = true;
+		}
+	}
+	return true;
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: checkInvariants (size_t &numRecs) {
+
+	numRecs = 0;
+	if (rootLocation == -1)
+		return true;
+
+	vector <int> leaves;
+	int leafDepth = -1;
+	if (!checkInvariants (rootLocation, nullptr, nullptr, 0, leafDepth, leaves, numRecs))
+		return false;
+
+	// the chain of leaves goes through the leaves in the same order as the directory does
+	int whichPage = leaves[0];
+	for (int leaf : leaves) {
+		if (whichPage != leaf) {
+			cout << "The chain of leaves goes to page " << whichPage << " rather than page " << leaf << ".\n";
+			return false;
+		}
+		whichPage = getNode (whichPage).getNextPage ();
+	}
+	if (whichPage != -1) {
+		cout << "The chain of leaves goes past the last leaf.\n";
+		return false;
+	}
+	return true;
+}
+
+bool MyDB_ConcurrentBPlusTreeReaderWriter :: checkInvariants (int whichPage, MyDB_AttValPtr low, MyDB_AttValPtr high,
+	int depth, int &leafDepth, vector <int> &leaves, size_t &numRecs) {
+
+	if ((getVersion (whichPage) & CONCURRENT_BPLUS_LOCKED) != 0) {
+		cout << "Page " << whichPage << " is still locked.\n";
+		return false;
+	}
+
+	// each key has to be in the bounds, and not below the key before it
+	MyDB_AttValPtr last = low;
+	auto checkKey = [&] (MyDB_AttValPtr key) {
+		if ((last != nullptr && buildComparator (key, last) ()) || (high != nullptr && buildComparator (high, key) ())) {
+			cout << "Key " << key->toString () << " on page " << whichPage << " is out of order.\n";
+			return false;
+		}
+		last = key->getCopy ();
+		return true;
+	};
+
+	MyDB_PageReaderWriter page = getNode (whichPage);
+	if (page.getType () == MyDB_PageType :: RegularPage) {
+
+		if (leafDepth == -1)
+			leafDepth = depth;
+		if (depth != leafDepth) {
+			cout << "Leaf " << whichPage << " is at depth " << depth << " rather than " << leafDepth << ".\n";
+			return false;
+		}
+		leaves.push_back (whichPage);
+
+		MyDB_RecordPtr rec = getEmptyRecord ();
+		MyDB_RecordIteratorAltPtr temp = page.getIteratorAlt ();
+		while (temp->advance ()) {
+			temp->getCurrent (rec);
+			if (!checkKey (rec->getAtt (whichAttIsOrdering)))
+				return false;
+			numRecs++;
+		}
+		return true;
+	}
+
+	// for a directory page, the keys are the bounds on the subtrees
+	vector <pair <MyDB_AttValPtr, int>> children = getEntries (page);
+	for (auto &child : children) {
+		if (!checkKey (child.first))
+			return false;
+	}
+	if (children.size () == 0) {
+		cout << "Directory page " << whichPage << " is empty.\n";
+		return false;
+	}
+
+	for (auto &child : children) {
+		if (!checkInvariants (child.second, low, child.first, depth + 1, leafDepth, leaves, numRecs))
+			return false;
+		low = child.first;
+	}
+	return true;
+}
+
+#endif
@@ -30,9 +30,28 @@ bool MyDB_PageListIteratorAlt :: advance () {
 
 	curPage++;
 	myIter = forUs[curPage].getIteratorAlt ();
+	prefetchNext ();
 	return advance ();
 }
 
+bool MyDB_PageListIteratorAlt :: nextBatch (MyDB_RecordBatch &intoMe) {
+
+	while (!myIter->nextBatch (intoMe)) {
+		if (curPage == forUs.size () - 1)
+			return false;
+
+		curPage++;
+		myIter = forUs[curPage].getIteratorAlt ();
+		prefetchNext ();
+	}
+	return true;
+}
+
+void MyDB_PageListIteratorAlt :: prefetchNext () {
+	if (curPage + 1 < forUs.size ())
+		forUs[curPage + 1].prefetch ();
+}
+
 void *MyDB_PageListIteratorAlt :: getCurrentPointer () {
 	return myIter->getCurrentPointer ();
 }
@@ -41,6 +60,7 @@ MyDB_PageListIteratorAlt :: MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWri
 	forUs = forUsIn;
 	curPage = 0;
 	myIter = forUsIn[curPage].getIteratorAlt ();		
+	prefetchNext ();
 }
 
 MyDB_PageListIteratorAlt :: ~MyDB_PageListIteratorAlt () {}
@@ -18,12 +18,17 @@
 #include "MyDB_PageRecIterator.h"
 #include "MyDB_PageRecIteratorAlt.h"
 #include "MyDB_PageListIteratorAlt.h"
-#include "RecordComparator.h"
+#include "MyDB_SortKey.h"
 
 #define PAGE_TYPE *((MyDB_PageType *) ((char *) myPage->getBytes ()))
 #define NUM_BYTES_USED *((size_t *) (((char *) myPage->getBytes ()) + sizeof (size_t)))
 #define NUM_BYTES_LEFT (pageSize - NUM_BYTES_USED)
 
+// the page type only takes up the first half of its slot at the front of the page; the number of the next
+// page in a chain of pages is kept in the other half
+#define NEXT_PAGE *((int *) (((char *) myPage->getBytes ()) + sizeof (MyDB_PageType)))
+static_assert (sizeof (MyDB_PageType) + sizeof (int) <= sizeof (size_t), "no room for the next page");
+
 MyDB_PageReaderWriter :: MyDB_PageReaderWriter () {
 	myPage = nullptr;
 	pageSize = 0;
@@ -67,6 +72,7 @@ MyDB_PageReaderWriter :: MyDB_PageReaderWriter (bool pinned, MyDB_BufferManager
 void MyDB_PageReaderWriter :: clear () {
 	NUM_BYTES_USED = 2 * sizeof (size_t);
 	PAGE_TYPE = MyDB_PageType :: RegularPage;
+	NEXT_PAGE = -1;
 	myPage->wroteBytes ();	
 }
 
@@ -91,6 +97,52 @@ void MyDB_PageReaderWriter :: setType (MyDB_PageType toMe) {
 	myPage->wroteBytes ();	
 }
 
+int MyDB_PageReaderWriter :: getNextPage () {
+	return NEXT_PAGE;
+}
+
+void MyDB_PageReaderWriter :: setNextPage (int toMe) {
+	NEXT_PAGE = toMe;
+	myPage->wroteBytes ();	
+}
+
+size_t MyDB_PageReaderWriter :: findInsertPoint (function <bool ()> comparator, MyDB_RecordPtr onPage) {
+
+	// find where each of the records starts; only their lengths are looked at
+	char *bytes = (char *) myPage->getBytes ();
+	size_t bytesUsed = *((size_t *) (bytes + sizeof (size_t)));
+	vector <size_t> offsets;
+	for (size_t pos = 2 * sizeof (size_t); pos != bytesUsed; pos += *((short *) (bytes + pos)))
+		offsets.push_back (pos);
+
+	// and find the first record that the new one comes before
+	size_t low = 0, high = offsets.size ();
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		onPage->fromBinary (bytes + offsets[mid]);
+		if (comparator ())
+			high = mid;
+		else
+			low = mid + 1;
+	}
+
+	return low == offsets.size () ? bytesUsed : offsets[low];
+}
+
+bool MyDB_PageReaderWriter :: insertAt (size_t offset, MyDB_RecordPtr insertMe) {
+
+	size_t recSize = insertMe->getBinarySize ();
+	if (recSize > NUM_BYTES_LEFT)
+		return false;
+
+	char *bytes = (char *) myPage->getBytes ();
+	memmove (bytes + offset + recSize, bytes + offset, NUM_BYTES_USED - offset);
+	insertMe->toBinary (bytes + offset);
+	NUM_BYTES_USED += recSize;
+	myPage->wroteBytes ();
+	return true;
+}
+
 void *MyDB_PageReaderWriter :: appendAndReturnLocation (MyDB_RecordPtr appendMe) {
 	void *recLocation = NUM_BYTES_USED + (char *)  myPage->getBytes ();
 	if (append (appendMe))
@@ -113,6 +165,27 @@ bool MyDB_PageReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	return true;
 }
 
+size_t MyDB_PageReaderWriter :: appendBinary (char *fromHere, size_t numBytes) {
+
+	// see how many of the records fit, and copy them over all at once
+	size_t fits = 0;
+	while (fits < numBytes && fits + *((short *) (fromHere + fits)) <= NUM_BYTES_LEFT)
+		fits += *((short *) (fromHere + fits));
+
+	if (fits == 0)
+		return 0;
+
+	memcpy (NUM_BYTES_USED + (char *) myPage->getBytes (), fromHere, fits);
+	NUM_BYTES_USED += fits;
+	myPage->wroteBytes ();
+	return fits;
+}
+
+void MyDB_PageReaderWriter :: copyRecords (vector <char> &appendToMe) {
+	char *bytes = (char *) myPage->getBytes ();
+	appendToMe.insert (appendToMe.end (), bytes + 2 * sizeof (size_t), bytes + NUM_BYTES_USED);
+}
+
 void MyDB_PageReaderWriter :: 
 	sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs) {
 
@@ -131,9 +204,8 @@ void MyDB_PageReaderWriter ::
 		bytesConsumed += ((char *) nextPos) - ((char *) pos);
 	}
 
-	// and now we sort the vector of positions, using the record contents to build a comparator
-	RecordComparator myComparator (comparator, lhs, rhs);
-	std::stable_sort (positions.begin (), positions.end (), myComparator);
+	// and now we sort the vector of positions, on the keys of the records if we can, or using the record contents
+	sortRecords (positions, comparator, lhs, rhs);
 
 	// and write the guys back
 	NUM_BYTES_USED = 2 * sizeof (size_t);
@@ -161,9 +233,8 @@ MyDB_PageReaderWriterPtr MyDB_PageReaderWriter ::
 		bytesConsumed += ((char *) nextPos) - ((char *) pos);
 	}
 
-	// and now we sort the vector of positions, using the record contents to build a comparator
-	RecordComparator myComparator (comparator, lhs, rhs);
-	std::stable_sort (positions.begin (), positions.end (), myComparator);
+	// and now we sort the vector of positions, on the keys of the records if we can, or using the record contents
+	sortRecords (positions, comparator, lhs, rhs);
 
 	// and now create the page to return
 	MyDB_PageReaderWriterPtr returnVal = make_shared <MyDB_PageReaderWriter> (myPage->getParent ());
@@ -186,4 +257,12 @@ void *MyDB_PageReaderWriter :: getBytes () {
 	return myPage->getBytes ();
 }
 
+void MyDB_PageReaderWriter :: prefetch () {
+	myPage->prefetch ();
+}
+
+void MyDB_PageReaderWriter :: writeBehind () {
+	myPage->writeBehind ();
+}
+
 #endif
@@ -29,15 +29,36 @@ void *MyDB_PageRecIteratorAlt :: getCurrentPointer () {
 }
 
 bool MyDB_PageRecIteratorAlt :: advance () {
-	if (nextRecSize == -1) {
-		cout << "You can't call advance without calling getCurrent!!\n";
-		exit (1);
-	}
+
+	// if getCurrent was not called, the size of the current record is at its front
+	if (nextRecSize == -1)
+		nextRecSize = *((short *) getCurrentPointer ());
 	bytesConsumed += nextRecSize;
 	nextRecSize = -1;
 	return bytesConsumed != NUM_BYTES_USED;
 }
 
+bool MyDB_PageRecIteratorAlt :: nextBatch (MyDB_RecordBatch &intoMe) {
+
+	intoMe.clear ();
+	char *bytes = (char *) myPage->getBytes ();
+	int bytesUsed = *((size_t *) (bytes + sizeof (size_t)));
+	if (bytesConsumed >= bytesUsed)
+		return false;
+
+	// move past the current record (if there is one), and then hand out the ones after it
+	int pos = bytesConsumed + (nextRecSize == -1 ? *((short *) (bytes + bytesConsumed)) : nextRecSize);
+	while (pos < bytesUsed && !intoMe.full ()) {
+		intoMe.append (bytes + pos);
+		pos += *((short *) (bytes + pos));
+	}
+
+	// the next call to advance () or nextBatch () will pick up right after the batch
+	bytesConsumed = pos;
+	nextRecSize = 0;
+	return intoMe.size () != 0;
+}
+
 MyDB_PageRecIteratorAlt :: MyDB_PageRecIteratorAlt (MyDB_PageHandle myPageIn) {
 	bytesConsumed = sizeof (size_t) * 2;
 	myPage = myPageIn;
@@ -0,0 +1,167 @@
+
+#ifndef PARALLEL_SCAN_C
+#define PARALLEL_SCAN_C
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include "MyDB_ParallelScan.h"
+#include <thread>
+
+using namespace std;
+
+// the morsels handed to one worker thread; the worker takes them from the front, and any other
+// worker that has run out takes them from the back
+struct MorselQueue {
+	mutex lock;
+	deque <MyDB_Morsel *> morsels;
+};
+
+// what the thread running a scan shares with its workers
+struct ScanState {
+
+	ScanState (size_t numThreads) : queues (numThreads) {}
+
+	vector <MorselQueue> queues;
+
+	// these are all protected by lock; each new batch of morsels bumps the generation
+	mutex lock;
+	condition_variable workReady;
+	condition_variable batchDone;
+	size_t generation = 0;
+	size_t remaining = 0;
+	bool done = false;
+};
+
+// gets the next morsel for the given worker, stealing one if its own queue is empty; returns
+// nullptr if there are no morsels left anywhere
+static MyDB_Morsel *getMorsel (ScanState &state, size_t me) {
+
+	size_t numThreads = state.queues.size ();
+	for (size_t i = 0; i < numThreads; i++) {
+		MorselQueue &queue = state.queues[(me + i) % numThreads];
+		lock_guard <mutex> guard (queue.lock);
+		if (queue.morsels.empty ())
+			continue;
+
+		MyDB_Morsel *res;
+		if (i == 0) {
+			res = queue.morsels.front ();
+			queue.morsels.pop_front ();
+		} else {
+			res = queue.morsels.back ();
+			queue.morsels.pop_back ();
+		}
+		return res;
+	}
+	return nullptr;
+}
+
+// run by each worker thread: it sets up its own pipeline, and then runs it over morsels until the scan is done
+static void runWorker (ScanState &state, size_t me, function <MyDB_MorselPipeline ()> &buildPipeline) {
+
+	MyDB_MorselPipeline pipeline = buildPipeline ();
+	size_t seen = 0;
+	while (true) {
+
+		// wait for a new batch
+		{
+			unique_lock <mutex> guard (state.lock);
+			state.workReady.wait (guard, [&] {return state.done || state.generation != seen;});
+			if (state.done)
+				return;
+			seen = state.generation;
+		}
+
+		// and work on it until there is nothing left to take
+		MyDB_Morsel *morsel;
+		while ((morsel = getMorsel (state, me)) != nullptr) {
+			pipeline (*morsel);
+			lock_guard <mutex> guard (state.lock);
+			if (--state.remaining == 0)
+				state.batchDone.notify_one ();
+		}
+	}
+}
+
+MyDB_ParallelScan :: MyDB_ParallelScan (MyDB_TableReaderWriter &input) {
+	numPages = input.getNumPages ();
+	getPage = [&input] (size_t i) {return input[i];};
+}
+
+MyDB_ParallelScan :: MyDB_ParallelScan (vector <MyDB_PageReaderWriter> &pages) {
+	numPages = pages.size ();
+	getPage = [pages] (size_t i) {return pages[i];};
+}
+
+void MyDB_ParallelScan :: run (function <MyDB_MorselPipeline ()> buildPipeline, MyDB_TableReaderWriter &output,
+	size_t numThreads) {
+
+	if (numThreads == 0)
+		numThreads = max (1u, thread :: hardware_concurrency ());
+
+	ScanState state (numThreads);
+	vector <thread> workers;
+	for (size_t i = 0; i < numThreads; i++)
+		workers.push_back (thread (runWorker, ref (state), i, ref (buildPipeline)));
+
+	// copies the records from the next run of pages into a batch of morsels, returning the number of morsels filled
+	size_t nextPage = 0;
+	auto fill = [&] (vector <MyDB_Morsel> &batch) {
+		size_t numMorsels = 0;
+		for (; numMorsels < batch.size () && nextPage < numPages; numMorsels++) {
+			batch[numMorsels].records.clear ();
+			batch[numMorsels].output.clear ();
+			for (size_t i = 0; i < MORSEL_PAGES && nextPage < numPages; i++)
+				getPage (nextPage++).copyRecords (batch[numMorsels].records);
+		}
+		return numMorsels;
+	};
+
+	// two batches: the workers process one while this thread fills the other
+	vector <MyDB_Morsel> batches[2];
+	batches[0].resize (numThreads * MORSELS_PER_THREAD);
+	batches[1].resize (numThreads * MORSELS_PER_THREAD);
+	int which = 0;
+	size_t numMorsels = fill (batches[which]);
+	while (numMorsels > 0) {
+
+		// hand out the morsels round robin
+		{
+			lock_guard <mutex> guard (state.lock);
+			state.remaining = numMorsels;
+			for (size_t i = 0; i < numMorsels; i++) {
+				MorselQueue &queue = state.queues[i % numThreads];
+				lock_guard <mutex> queueGuard (queue.lock);
+				queue.morsels.push_back (&batches[which][i]);
+			}
+			state.generation++;
+		}
+		state.workReady.notify_all ();
+
+		// get the next batch ready, then wait for this one to finish
+		size_t numNext = fill (batches[1 - which]);
+		{
+			unique_lock <mutex> guard (state.lock);
+			state.batchDone.wait (guard, [&] {return state.remaining == 0;});
+		}
+
+		// and write out its results, in order
+		for (size_t i = 0; i < numMorsels; i++)
+			output.appendBinary (batches[which][i].output);
+
+		which = 1 - which;
+		numMorsels = numNext;
+	}
+
+	{
+		lock_guard <mutex> guard (state.lock);
+		state.done = true;
+	}
+	state.workReady.notify_all ();
+	for (auto &worker : workers)
+		worker.join ();
+}
+
+#endif
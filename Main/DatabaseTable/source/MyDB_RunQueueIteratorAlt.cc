@@ -11,7 +11,6 @@
 #ifndef RUN_QITER_ALT_C
 #define RUN_QITER_ALT_C
 
-#include "IteratorComparator.h"
 #include "MyDB_PageListIteratorAlt.h"
 #include "MyDB_PageRecIteratorAlt.h"
 #include "MyDB_RunQueueIteratorAlt.h"
@@ -19,41 +18,122 @@
 using namespace std;
 
 void MyDB_RunQueueIteratorAlt :: getCurrent (MyDB_RecordPtr intoMe) {
-	auto myIter = pq.top ();
-	myIter->getCurrent (intoMe);
+	intoMe->fromBinary (current[tree[0]].data ());
 }
 
-MyDB_RunQueueIteratorAlt :: MyDB_RunQueueIteratorAlt (function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) : 
-	pq (IteratorComparator (comparator, lhs, rhs)) {
+MyDB_RunQueueIteratorAlt :: MyDB_RunQueueIteratorAlt (function <bool ()> comparatorIn, MyDB_RecordPtr lhsIn, 
+	MyDB_RecordPtr rhsIn) : comparator (comparatorIn), lhs (lhsIn), rhs (rhsIn) {
 	firstTime = true;
+	sortKey = MyDB_SortKey :: forComparator (comparator, lhs->getSchema ());
+}
+
+void MyDB_RunQueueIteratorAlt :: addRun (MyDB_RecordIteratorAltPtr run) {
+	runs.push_back (run);
+	current.push_back (vector <char> ());
+	keys.push_back (0);
+	cacheCurrent (runs.size () - 1, true);
+}
+
+void MyDB_RunQueueIteratorAlt :: cacheCurrent (int run, bool hasRecord) {
+	if (!hasRecord) {
+		current[run].clear ();
+		return;
+	}
+	char *rec = (char *) runs[run]->getCurrentPointer ();
+	current[run].assign (rec, rec + *((short *) rec));
+	if (sortKey != nullptr)
+		keys[run] = sortKey->encode (rec);
+}
+
+bool MyDB_RunQueueIteratorAlt :: before (int a, int b) {
+	if (current[a].empty ())
+		return false;
+	if (current[b].empty ())
+		return true;
+	if (sortKey != nullptr && keys[a] != keys[b])
+		return keys[a] < keys[b];
+	if (sortKey != nullptr && sortKey->isExact ())
+		return false;
+	lhs->fromBinary (current[a].data ());
+	rhs->fromBinary (current[b].data ());
+	return comparator ();
+}
+
+void MyDB_RunQueueIteratorAlt :: build () {
+
+	// play the whole tournament once, bottom up; winners[n] is the run that won at node n
+	int k = runs.size ();
+	vector <int> winners (2 * k);
+	tree.resize (k);
+	for (int i = 0; i < k; i++)
+		winners[k + i] = i;
+
+	for (int n = k - 1; n >= 1; n--) {
+		int a = winners[2 * n], b = winners[2 * n + 1];
+		if (before (b, a)) {
+			winners[n] = b;
+			tree[n] = a;
+		} else {
+			winners[n] = a;
+			tree[n] = b;
+		}
+	}
+	tree[0] = winners[1];
 }
 	
 bool MyDB_RunQueueIteratorAlt :: advance () {
 
-	if (pq.size () == 0)
+	if (runs.size () == 0)
 		return false;
 
 	if (firstTime) {
 		firstTime = false;
-		return true;
+		build ();
+		return !current[tree[0]].empty ();
 	}
 
-	if (pq.size () == 0)
-		return false;
+	// move the winning run on to its next record
+	int candidate = tree[0];
+	cacheCurrent (candidate, runs[candidate]->advance ());
 
-	// remove from the q
-	auto myIter = pq.top ();
-	pq.pop ();
-	
-	// re-insert
-	if (myIter->advance ()) 
-		pq.push (myIter);
+	// and replay its matches on the way up to the root.  A match is decided on the keys of the two
+	// runs if it can be; if not, the candidate is kept in rhs for as long as it keeps winning, so
+	// each match only has to load the record of the run that it plays
+	bool loaded = false;
+	for (int node = (candidate + runs.size ()) / 2; node > 0; node /= 2) {
+		int opponent = tree[node];
+		if (current[opponent].empty ())
+			continue;
+
+		if (!current[candidate].empty ()) {
+			if (sortKey != nullptr && keys[opponent] != keys[candidate]) {
+				if (keys[opponent] > keys[candidate])
+					continue;
+			} else if (sortKey != nullptr && sortKey->isExact ()) {
+				continue;
+			} else {
+				if (!loaded) {
+					rhs->fromBinary (current[candidate].data ());
+					loaded = true;
+				}
+				lhs->fromBinary (current[opponent].data ());
+				if (!comparator ())
+					continue;
+			}
+		}
+
+		// the opponent won, so it goes on up, and the candidate stays here
+		tree[node] = candidate;
+		candidate = opponent;
+		loaded = false;
+	}
+	tree[0] = candidate;
 
-	return (pq.size () != 0);
+	return !current[candidate].empty ();
 }
 
 void *MyDB_RunQueueIteratorAlt :: getCurrentPointer () {
-	return pq.top ()->getCurrentPointer ();
+	return current[tree[0]].data ();
 }
 
 MyDB_RunQueueIteratorAlt :: ~MyDB_RunQueueIteratorAlt () {}
@@ -0,0 +1,178 @@
+
+#ifndef SORT_KEY_C
+#define SORT_KEY_C
+
+#include <algorithm>
+#include "MyDB_SortKey.h"
+#include "RecordComparator.h"
+#include <string.h>
+
+using namespace std;
+
+MyDB_SortKey :: MyDB_SortKey (MyDB_SchemaPtr mySchema, string computation, bool descendingIn) {
+
+	// only the attributes that the computation looks at are loaded
+	myRec = make_shared <MyDB_Record> (mySchema);
+	vector <string> computations {computation};
+	myRec->narrowTo (myRec->getReferencedAtts (computations));
+	keyFunc = myRec->compileComputation (computation);
+	descending = descendingIn;
+
+	MyDB_AttTypePtr type = myRec->getType (computation);
+	exact = true;
+	if (type->isBool ()) {
+		keyType = BoolKey;
+	} else if (type->isDecimal ()) {
+
+		// a narrow decimal is a scaled 64-bit int, so it can be encoded exactly; a wide one is encoded as a double
+		MyDB_DecimalAttType *decimal = static_cast <MyDB_DecimalAttType *> (type.get ());
+		if (decimal->getPrecision () <= MyDB_MAX_NARROW_DIGITS) {
+			keyType = DecimalKey;
+			scale = decimal->getScale ();
+		} else {
+			keyType = DoubleKey;
+			exact = false;
+		}
+	} else if (type->promotableToInt ()) {
+		keyType = IntKey;
+	} else if (type->promotableToDouble ()) {
+		keyType = DoubleKey;
+	} else {
+		keyType = StringKey;
+		exact = false;
+	}
+}
+
+MyDB_SortKeyPtr MyDB_SortKey :: forComparator (function <bool ()> &comparator, MyDB_SchemaPtr mySchema) {
+	MyDB_RecordLessThan *lessThan = comparator.target <MyDB_RecordLessThan> ();
+	if (lessThan == nullptr)
+		return nullptr;
+	return make_shared <MyDB_SortKey> (mySchema, lessThan->computation, lessThan->descending);
+}
+
+uint64_t MyDB_SortKey :: encode (void *rec) {
+
+	myRec->fromBinary (rec);
+	MyDB_AttValPtr val = keyFunc ();
+	uint64_t res = 0;
+
+	if (keyType == IntKey) {
+
+		// flipping the sign bit puts the negative numbers first
+		res = ((uint64_t) (((uint32_t) val->toInt ()) ^ 0x80000000u)) << 32;
+
+	} else if (keyType == DecimalKey) {
+		MyDB_Decimal d = static_cast <MyDB_DecimalAttVal *> (val.get ())->getDecimal ();
+		long long scaled = d.scale == scale ? d.val : (long long) MyDB_rescale (d.val, d.scale, scale);
+		res = ((uint64_t) scaled) ^ (1ULL << 63);
+
+	} else if (keyType == BoolKey) {
+		res = ((uint64_t) val->toBool ()) << 56;
+
+	} else if (keyType == DoubleKey) {
+
+		// a positive double gets its sign bit set, and a negative one has all of its bits flipped, so that
+		// the larger its magnitude, the smaller its key; -0.0 is made into 0.0, as they are equal
+		double d = val->toDouble ();
+		if (d == 0.0)
+			d = 0.0;
+		memcpy (&res, &d, sizeof (res));
+		res = (res >> 63) ? ~res : (res | (1ULL << 63));
+
+	} else {
+
+		// the first eight bytes, padded with zeros
+		MyDB_StringView view = static_cast <MyDB_StringAttVal *> (val.get ())->getView ();
+		for (size_t i = 0; i < 8 && i < view.size; i++)
+			res |= ((uint64_t) (unsigned char) view.data[i]) << (56 - 8 * i);
+	}
+
+	return descending ? ~res : res;
+}
+
+bool MyDB_SortKey :: isExact () {
+	return exact;
+}
+
+void radixSort (vector <MyDB_KeyedRecord> &recs) {
+
+	size_t n = recs.size ();
+	if (n == 0)
+		return;
+
+	// count the values of all eight bytes of the keys, in one pass
+	vector <size_t> counts (8 * 256, 0);
+	for (size_t i = 0; i < n; i++) {
+		uint64_t key = recs[i].key;
+		for (int b = 0; b < 8; b++)
+			counts[b * 256 + ((key >> (8 * b)) & 0xFF)]++;
+	}
+
+	// then distribute the records on each byte in turn, from the lowest to the highest.  Each bucket gets a
+	// small buffer, which is written out all at once when it fills, so that the writes go to a few cache
+	// lines at a time instead of being scattered over all 256 buckets
+	vector <MyDB_KeyedRecord> other (n);
+	MyDB_KeyedRecord *from = recs.data (), *to = other.data ();
+	vector <MyDB_KeyedRecord> buffers (256 * RADIX_BUFFER);
+	size_t offsets[256], fill[256];
+	for (int b = 0; b < 8; b++) {
+
+		// if all of the keys have the same value in this byte, there is nothing to do
+		size_t *count = &counts[b * 256];
+		if (count[(from[0].key >> (8 * b)) & 0xFF] == n)
+			continue;
+
+		size_t sum = 0;
+		for (int d = 0; d < 256; d++) {
+			offsets[d] = sum;
+			sum += count[d];
+			fill[d] = 0;
+		}
+
+		for (size_t i = 0; i < n; i++) {
+			int d = (from[i].key >> (8 * b)) & 0xFF;
+			MyDB_KeyedRecord *buffer = &buffers[d * RADIX_BUFFER];
+			buffer[fill[d]++] = from[i];
+			if (fill[d] == RADIX_BUFFER) {
+				memcpy (to + offsets[d], buffer, RADIX_BUFFER * sizeof (MyDB_KeyedRecord));
+				offsets[d] += RADIX_BUFFER;
+				fill[d] = 0;
+			}
+		}
+		for (int d = 0; d < 256; d++)
+			memcpy (to + offsets[d], &buffers[d * RADIX_BUFFER], fill[d] * sizeof (MyDB_KeyedRecord));
+
+		swap (from, to);
+	}
+
+	if (from != recs.data ())
+		memcpy (recs.data (), from, n * sizeof (MyDB_KeyedRecord));
+}
+
+void sortRecords (vector <void *> &positions, function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	MyDB_SortKeyPtr sortKey = MyDB_SortKey :: forComparator (comparator, lhs->getSchema ());
+	if (sortKey == nullptr) {
+		RecordComparator myComparator (comparator, lhs, rhs);
+		std::stable_sort (positions.begin (), positions.end (), myComparator);
+		return;
+	}
+
+	vector <MyDB_KeyedRecord> keyed (positions.size ());
+	for (size_t i = 0; i < positions.size (); i++) {
+		keyed[i].key = sortKey->encode (positions[i]);
+		keyed[i].rec = positions[i];
+	}
+
+	// if the keys are exact, sorting on them alone is enough, so a radix sort can be used
+	if (sortKey->isExact () && keyed.size () >= RADIX_SORT_MIN) {
+		radixSort (keyed);
+	} else {
+		MyDB_KeyedComparator myComparator (sortKey->isExact (), comparator, lhs, rhs);
+		std::stable_sort (keyed.begin (), keyed.end (), myComparator);
+	}
+	for (size_t i = 0; i < positions.size (); i++)
+		positions[i] = keyed[i].rec;
+}
+
+#endif
@@ -13,7 +13,11 @@
 #ifndef TABLE_RW_C
 #define TABLE_RW_C
 
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
 #include <fstream>
+#include <functional>
 #include <limits>
 #include <queue>
 #include "MyDB_PageReaderWriter.h"
@@ -21,11 +25,94 @@
 #include "MyDB_TableRecIteratorAlt.h"
 #include "MyDB_TableReaderWriter.h"
 #include <set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 #include "Sorting.h"
 
 using namespace std;
 
+// the loader cuts its input file into chunks of about this many bytes (ending at line boundaries),
+// and the worker threads each parse one chunk at a time
+#define LOAD_CHUNK_SIZE (1024 * 1024)
+
+// one chunk of a text file that is being loaded, along with the result of parsing it: the records
+// in binary form (one after another, just as they are laid out on a page) and a distinct-value
+// sketch for each attribute
+struct LoadChunk {
+
+	const char *begin;
+	const char *end;
+	vector <char> binary;
+	vector <MyDB_HyperLogLog> sketches;
+	size_t numRecs;
+
+	LoadChunk (const char *beginIn, const char *endIn, size_t numAtts) : begin (beginIn), end (endIn), 
+		sketches (numAtts), numRecs (0) {}
+};
+
+// parses all of the lines in a chunk; this is run by the loader's worker threads, so it must not
+// touch the buffer manager or anything else that is shared
+static void parseChunk (MyDB_SchemaPtr mySchema, LoadChunk &chunk) {
+
+	MyDB_Record tempRec (mySchema);
+	size_t bytesUsed = 0;
+	chunk.binary.resize ((chunk.end - chunk.begin) * 3 / 2 + 1024);
+	for (const char *pos = chunk.begin; pos < chunk.end; ) {
+
+		// find the end of the line
+		const char *lineEnd = (const char *) memchr (pos, '\n', chunk.end - pos);
+		if (lineEnd == nullptr)
+			lineEnd = chunk.end;
+		if (lineEnd == pos) {
+			pos++;
+			continue;
+		}
+		tempRec.fromChars (pos, lineEnd);
+		pos = lineEnd + 1;
+		chunk.numRecs++;
+
+		// hash all of the attributes... this is used for counting
+		for (size_t i = 0; i < chunk.sketches.size (); i++)
+			chunk.sketches[i].add (tempRec.getAtt (i)->hash ());
+
+		// and write out the record
+		size_t recSize = tempRec.getBinarySize ();
+		if (bytesUsed + recSize > chunk.binary.size ())
+			chunk.binary.resize ((bytesUsed + recSize) * 2);
+		tempRec.toBinary (&chunk.binary[bytesUsed]);
+		bytesUsed += recSize;
+	}
+	chunk.binary.resize (bytesUsed);
+}
+
+// when a table is written out as text, each worker thread formats the records from this many pages
+// at a time
+#define WRITE_PAGES_PER_CHUNK 16
+
+// a run of pages from a table that is being written out as text: the records from the pages in
+// binary form (one after another), and the text that they are formatted into... both buffers are
+// reused from one run of pages to the next
+struct WriteChunk {
+	vector <char> binary;
+	string text;
+};
+
+// formats all of the records in a chunk; this is run by the writer's worker threads, so just like
+// parseChunk, it must not touch the buffer manager
+static void formatChunk (MyDB_SchemaPtr mySchema, WriteChunk &chunk) {
+
+	MyDB_Record tempRec (mySchema);
+	chunk.text.clear ();
+	for (char *pos = chunk.binary.data (), *end = pos + chunk.binary.size (); pos < end; ) {
+		pos = (char *) tempRec.fromBinary (pos);
+		tempRec.appendString (chunk.text);
+		chunk.text += '\n';
+	}
+}
+
 MyDB_TableReaderWriter :: MyDB_TableReaderWriter (MyDB_TableReaderWriterPtr fromMe) {
 	forMe = make_shared <MyDB_Table> (*fromMe->forMe);
 	myBuffer = fromMe->myBuffer;
@@ -98,7 +185,8 @@ void MyDB_TableReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	// try to append the record on the current page...
 	if (!lastPage->append (appendMe)) {
 
-		// if we cannot, then get a new last page and append
+		// if we cannot, then write the full page back in the background, and get a new last page and append
+		lastPage->writeBehind ();
 		forMe->setLastPage (forMe->lastPage () + 1);
 		lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());
 		lastPage->clear ();
@@ -106,72 +194,108 @@ void MyDB_TableReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	}
 }
 
-pair <vector <size_t>, size_t>  MyDB_TableReaderWriter :: loadFromTextFile (string fName) {
+void MyDB_TableReaderWriter :: appendBinary (vector <char> &recs) {
+
+	size_t done = 0;
+	bool newPage = false;
+	while (done < recs.size ()) {
+
+		// copy as many records as fit onto the current page
+		size_t copied = lastPage->appendBinary (&recs[done], recs.size () - done);
+		done += copied;
+		if (copied != 0) {
+			newPage = false;
+			continue;
+		}
+
+		// and when it is full, write it back in the background, and get a new last page
+		if (newPage) {
+			cout << "Record of " << *((short *) &recs[done]) << " bytes is too big for a page.\n";
+			exit (1);
+		}
+		lastPage->writeBehind ();
+		forMe->setLastPage (forMe->lastPage () + 1);
+		lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());
+		lastPage->clear ();
+		newPage = true;
+	}
+}
+
+pair <vector <MyDB_HyperLogLog>, size_t>  MyDB_TableReaderWriter :: loadFromTextFile (string fName) {
 
 	// empty out the database file
 	forMe->setLastPage (0);
 	lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());
 	lastPage->clear ();
 
-	// try to open the file
-	string line;
-	ifstream myfile (fName);
+	auto startTime = chrono :: steady_clock :: now ();
+	MyDB_SchemaPtr mySchema = forMe->getSchema ();
+	size_t numAtts = mySchema->getAtts ().size ();
 
-	MyDB_RecordPtr tempRec = getEmptyRecord ();
-
-	// this data structure is used for apporoximate counting of the number of distinct
-	// values of each attribute
-	vector <pair <set <size_t>, int>> allHashes;
-	for (int i = 0; i < tempRec->getSchema ()->getAtts ().size (); i++) {
-		set <size_t> temp1;
-		allHashes.push_back (make_pair (temp1, 1));
-	}
+	// these are used for approximate counting of the number of distinct values of each attribute
+	vector <MyDB_HyperLogLog> allSketches (numAtts);
 
-	// if we opened it, read the contents
+	// try to open the file and map it into memory
 	size_t counter = 0;
-	if (myfile.is_open()) {
-
-		// loop through all of the lines
-		while (getline (myfile,line)) {
-			tempRec->fromString (line);		
-			counter++;
-			// hash all of the attributes... this is used for counting
-			int i = 0;
-			for (auto &a : allHashes) {
-
-				// insert the hash
-				size_t hash = tempRec->getAtt (i)->hash ();
-				i++;
-				if (hash % a.second != 0)
-					continue;
-
-				a.first.insert (hash);
-
-				// if we have too many items, compact them
-				#define MAX_SIZE 1000
-				if (a.first.size () > MAX_SIZE) {
-					a.second *= 2;
-					set <size_t> newSet;
-					for (auto &num : a.first) {
-						if (num % a.second == 0)
-							newSet.insert (num);
-					}
-					a.first = newSet;	
-				}
+	int fd = open (fName.c_str (), O_RDONLY);
+	struct stat fileInfo;
+	if (fd >= 0 && fstat (fd, &fileInfo) == 0 && fileInfo.st_size > 0) {
+
+		size_t fileSize = fileInfo.st_size;
+		char *text = (char *) mmap (nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (text == MAP_FAILED) {
+			cout << "Could not map " << fName << " into memory.\n";
+			exit (1);
+		}
+		madvise (text, fileSize, MADV_SEQUENTIAL);
+
+		// cut the file into chunks that end at line boundaries
+		vector <LoadChunk> chunks;
+		const char *fileEnd = text + fileSize;
+		for (const char *pos = text; pos < fileEnd; ) {
+			const char *chunkEnd = fileEnd;
+			if (fileEnd - pos > LOAD_CHUNK_SIZE) {
+				chunkEnd = (const char *) memchr (pos + LOAD_CHUNK_SIZE, '\n', fileEnd - pos - LOAD_CHUNK_SIZE);
+				chunkEnd = (chunkEnd == nullptr) ? fileEnd : chunkEnd + 1;
 			}
-			append (tempRec);
+			chunks.push_back (LoadChunk (pos, chunkEnd, numAtts));
+			pos = chunkEnd;
 		}
-		myfile.close ();
-	}
-	cout << "Loaded " << counter << " records.\n";
 
-	// finally, compute the vector of estimates
-	vector <size_t> returnVal;
-	for (auto &a : allHashes) {
-		size_t est = ((size_t) a.first.size ()) * a.second;
-		returnVal.push_back (est);
+		// parse the chunks a batch at a time (one chunk per thread, with this thread taking the first
+		// one), and then append the results of the batch to the table in order, a page at a time
+		size_t numThreads = max (1u, thread :: hardware_concurrency ());
+		for (size_t first = 0; first < chunks.size (); first += numThreads) {
+
+			size_t last = min (chunks.size (), first + numThreads);
+			vector <thread> workers;
+			for (size_t i = first + 1; i < last; i++)
+				workers.push_back (thread (parseChunk, mySchema, ref (chunks[i])));
+			parseChunk (mySchema, chunks[first]);
+			for (auto &worker : workers)
+				worker.join ();
+
+			for (size_t i = first; i < last; i++) {
+				appendBinary (chunks[i].binary);
+				counter += chunks[i].numRecs;
+				for (size_t j = 0; j < numAtts; j++)
+					allSketches[j].merge (chunks[i].sketches[j]);
+				vector <char> ().swap (chunks[i].binary);
+				vector <MyDB_HyperLogLog> ().swap (chunks[i].sketches);
+			}
+		}
+		munmap (text, fileSize);
 	}
-	return make_pair (returnVal, counter);
+	if (fd >= 0)
+		close (fd);
+
+	double secs = chrono :: duration <double> (chrono :: steady_clock :: now () - startTime).count ();
+	cout << "Loaded " << counter << " records";
+	if (secs > 0)
+		cout << " (" << (size_t) (counter / secs) << " rows/sec)";
+	cout << ".\n";
+
+	return make_pair (allSketches, counter);
 }
 
 MyDB_RecordIteratorPtr MyDB_TableReaderWriter :: getIterator (MyDB_RecordPtr iterateIntoMe) {
@@ -189,19 +313,52 @@ MyDB_RecordIteratorAltPtr MyDB_TableReaderWriter :: getIteratorAlt (int lowPage,
 void MyDB_TableReaderWriter :: writeIntoTextFile (string fName) {
 	
 	// open up the output file
-	ofstream output;
-	output.open (fName);
+	int fd = open (fName.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		cout << "Could not open " << fName << " for writing.\n";
+		return;
+	}
 
-	// get an empty record
-	MyDB_RecordPtr tempRec = getEmptyRecord ();;		
+	// the pages are taken a batch at a time: this thread copies the records out of each run of pages
+	// in the batch, the runs are formatted in parallel (with this thread taking the first one), and
+	// then the text from each run is written out in order
+	MyDB_SchemaPtr mySchema = forMe->getSchema ();
+	size_t numThreads = max (1u, thread :: hardware_concurrency ());
+	vector <WriteChunk> chunks (numThreads);
+	size_t numPages = getNumPages ();
+	for (size_t firstPage = 0; firstPage < numPages; ) {
+
+		size_t numChunks = 0;
+		for (; numChunks < numThreads && firstPage < numPages; numChunks++) {
+			vector <char> &binary = chunks[numChunks].binary;
+			binary.clear ();
+			for (size_t i = 0; i < WRITE_PAGES_PER_CHUNK && firstPage < numPages; i++, firstPage++)
+				(*this)[firstPage].copyRecords (binary);
+		}
 
-	// and write out all of the records
-	MyDB_RecordIteratorPtr myIter = getIterator (tempRec);
-	while (myIter->hasNext ()) {
-		myIter->getNext ();
-                output << tempRec << "\n";
+		vector <thread> workers;
+		for (size_t i = 1; i < numChunks; i++)
+			workers.push_back (thread (formatChunk, mySchema, ref (chunks[i])));
+		formatChunk (mySchema, chunks[0]);
+		for (auto &worker : workers)
+			worker.join ();
+
+		for (size_t i = 0; i < numChunks; i++) {
+			const char *text = chunks[i].text.data ();
+			size_t left = chunks[i].text.size ();
+			while (left > 0) {
+				ssize_t written = write (fd, text, left);
+				if (written <= 0) {
+					cout << "Could not write to " << fName << ".\n";
+					close (fd);
+					return;
+				}
+				text += written;
+				left -= written;
+			}
+		}
 	}
-	output.close ();
+	close (fd);
 }
 
 #endif
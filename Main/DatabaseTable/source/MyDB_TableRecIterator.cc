@@ -25,14 +25,16 @@ void *MyDB_TableRecIterator :: getCurrentPointer () {
 }
 
 bool MyDB_TableRecIterator :: hasNext () {
-	if (myParent[curPage].getType () == MyDB_PageType :: RegularPage && myIter->hasNext ())
+	if (curPageType == MyDB_PageType :: RegularPage && myIter->hasNext ())
 		return true;
 
 	if (curPage == myTable->lastPage ())
 		return false;
 
 	curPage++;
-	myIter = myParent[curPage].getIterator (myRec);
+	MyDB_PageReaderWriter nextPage = myParent[curPage];
+	curPageType = nextPage.getType ();
+	myIter = nextPage.getIterator (myRec);
 	return hasNext ();
 }
 
@@ -41,7 +43,9 @@ MyDB_TableRecIterator :: MyDB_TableRecIterator (MyDB_TableReaderWriter &myParent
 	myTable = myTableIn;
 	myRec = myRecIn;
 	curPage = 0;
-	myIter = myParent[curPage].getIterator (myRec);		
+	MyDB_PageReaderWriter firstPage = myParent[curPage];
+	curPageType = firstPage.getType ();
+	myIter = firstPage.getIterator (myRec);		
 }
 
 MyDB_TableRecIterator :: ~MyDB_TableRecIterator () {}
@@ -26,24 +26,46 @@ void *MyDB_TableRecIteratorAlt :: getCurrentPointer () {
 
 bool MyDB_TableRecIteratorAlt :: advance () {
 
-	if (myParent[curPage].getType () == MyDB_PageType :: RegularPage && myIter->advance ())
+	if (curPageType == MyDB_PageType :: RegularPage && myIter->advance ())
 		return true;
 
 	if (curPage == myTable->lastPage () || curPage == highPage)
 		return false;
 
 	curPage++;
-	myIter = myParent[curPage].getIteratorAlt ();
+	MyDB_PageReaderWriter nextPage = myParent.getPinned (curPage);
+	curPageType = nextPage.getType ();
+	myIter = nextPage.getIteratorAlt ();
 	return advance ();
 }
 
+bool MyDB_TableRecIteratorAlt :: nextBatch (MyDB_RecordBatch &intoMe) {
+
+	while (curPageType != MyDB_PageType :: RegularPage || !myIter->nextBatch (intoMe)) {
+		if (curPage == myTable->lastPage () || curPage == highPage) {
+			intoMe.clear ();
+			return false;
+		}
+
+		curPage++;
+		MyDB_PageReaderWriter nextPage = myParent.getPinned (curPage);
+		curPageType = nextPage.getType ();
+		myIter = nextPage.getIteratorAlt ();
+	}
+	return true;
+}
+
 MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn,
 	int lowPage, int highPageIn) :
 	myParent (myParent) {
 	myTable = myTableIn;
 	curPage = lowPage;
 	highPage = highPageIn;
-	myIter = myParent[curPage].getIteratorAlt ();		
+	// going through operator [] first makes sure that the page exists, even if the table is empty
+	myParent[curPage];
+	MyDB_PageReaderWriter firstPage = myParent.getPinned (curPage);
+	curPageType = firstPage.getType ();
+	myIter = firstPage.getIteratorAlt ();		
 }
 
 MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn) :
@@ -51,7 +73,11 @@ MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &my
 	myTable = myTableIn;
 	curPage = 0;
 	highPage = 1999999999;
-	myIter = myParent[curPage].getIteratorAlt ();		
+	// going through operator [] first makes sure that the page exists, even if the table is empty
+	myParent[curPage];
+	MyDB_PageReaderWriter firstPage = myParent.getPinned (curPage);
+	curPageType = firstPage.getType ();
+	myIter = firstPage.getIteratorAlt ();		
 }
 
 MyDB_TableRecIteratorAlt :: ~MyDB_TableRecIteratorAlt () {}
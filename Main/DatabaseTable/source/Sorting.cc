@@ -2,17 +2,27 @@
 #ifndef SORT_C
 #define SORT_C
 
+#include <algorithm>
 #include <queue>
 #include "MyDB_PageReaderWriter.h"
 #include "MyDB_TableRecIterator.h"
 #include "MyDB_TableRecIteratorAlt.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_RunQueueIteratorAlt.h"
+#include "MyDB_SortKey.h"
 #include "IteratorComparator.h"
+#include "RecordComparator.h"
 #include "Sorting.h"
+#include <thread>
+#include <unordered_map>
 
 using namespace std;
 
+MyDB_SortCounters &getSortCounters () {
+	static MyDB_SortCounters counters;
+	return counters;
+}
+
 void appendRecord (MyDB_PageReaderWriter &curPage, vector <MyDB_PageReaderWriter> &returnVal, 
 	MyDB_RecordPtr appendMe, MyDB_BufferManagerPtr parent) {
 
@@ -34,6 +44,10 @@ vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB
 	MyDB_PageReaderWriter curPage (*parent);
 	bool lhsLoaded = false, rhsLoaded = false;
 
+	// if we can, the records are compared on their keys, and only compared in full if their keys are the same
+	MyDB_SortKeyPtr sortKey = MyDB_SortKey :: forComparator (comparator, lhs->getSchema ());
+	uint64_t lhsKey = 0, rhsKey = 0;
+
 	// if one of the runs is empty, get outta here
 	if (!leftIter->advance ()) {
 		while (rightIter->advance ()) {
@@ -53,16 +67,28 @@ vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB
 			// here's a bit of an optimization... if one of the records is loaded, don't re-load
 			if (!lhsLoaded) {
 				leftIter->getCurrent (lhs);
+				if (sortKey != nullptr)
+					lhsKey = sortKey->encode (leftIter->getCurrentPointer ());
 				lhsLoaded = true;
 			}
 
 			if (!rhsLoaded) {
 				rightIter->getCurrent (rhs);		
+				if (sortKey != nullptr)
+					rhsKey = sortKey->encode (rightIter->getCurrentPointer ());
 				rhsLoaded = true;
 			}
 	
 			// see if the lhs is less
-			if (comparator ()) {
+			bool lhsLess;
+			if (sortKey != nullptr && lhsKey != rhsKey)
+				lhsLess = lhsKey < rhsKey;
+			else if (sortKey != nullptr && sortKey->isExact ())
+				lhsLess = false;
+			else
+				lhsLess = comparator ();
+
+			if (lhsLess) {
 				appendRecord (curPage, returnVal, lhs, parent);
 				lhsLoaded = false;
 
@@ -99,6 +125,429 @@ vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB
 	return returnVal;
 }
 	
+// the records of one run, copied out of the buffer manager (which is not thread safe) so that a worker
+// thread can sort them, and the same records once they have been sorted
+struct SortRun {
+	vector <char> records;
+	vector <char> sorted;
+};
+
+// sorts the records in a run; this is run by the worker threads of a parallel sort, so it builds its own
+// records and its own comparator, and only keeps the records that are accepted by the predicate
+static void sortRun (MyDB_SchemaPtr mySchema, string computation, bool descending, string pred, SortRun &run) {
+
+	MyDB_RecordPtr lhs = make_shared <MyDB_Record> (mySchema);
+	MyDB_RecordPtr rhs = make_shared <MyDB_Record> (mySchema);
+	function <bool ()> comparator = buildRecordComparator (lhs, rhs, computation, descending);
+	bool skipPred = (pred == "bool[true]");
+	func f = lhs->compileComputation (pred);
+
+	// find all of the records
+	vector <void *> positions;
+	for (char *pos = run.records.data (), *end = pos + run.records.size (); pos < end; ) {
+		if (skipPred) {
+			positions.push_back (pos);
+			pos += *((short *) pos);
+		} else {
+			char *next = (char *) lhs->fromBinary (pos);
+			if (f ()->toBool ())
+				positions.push_back (pos);
+			pos = next;
+		}
+	}
+
+	// sort them, and copy them over in order
+	sortRecords (positions, comparator, lhs, rhs);
+	run.sorted.clear ();
+	for (void *pos : positions)
+		run.sorted.insert (run.sorted.end (), (char *) pos, ((char *) pos) + *((short *) pos));
+}
+
+// writes a list of records in binary form out to a list of anonymous pages
+static vector <MyDB_PageReaderWriter> writeToPages (MyDB_BufferManagerPtr parent, vector <char> &recs) {
+
+	vector <MyDB_PageReaderWriter> returnVal;
+	MyDB_PageReaderWriter curPage (*parent);
+	bool newPage = true;
+	for (size_t done = 0; done < recs.size (); ) {
+		size_t copied = curPage.appendBinary (&recs[done], recs.size () - done);
+		done += copied;
+		if (copied != 0) {
+			newPage = false;
+			continue;
+		}
+
+		if (newPage) {
+			cout << "Record of " << *((short *) &recs[done]) << " bytes is too big for a page.\n";
+			exit (1);
+		}
+		returnVal.push_back (curPage);
+		curPage = MyDB_PageReaderWriter (*parent);
+		newPage = true;
+	}
+	returnVal.push_back (curPage);
+	return returnVal;
+}
+
+// the first phase of a parallel TPMMS.  The pages of sortMe are taken runSize pages at a time, and a batch
+// of these runs (one per thread) is copied out, sorted in parallel, and then written to anonymous pages;
+// the list of pages making up each (non-empty) sorted run is returned
+static vector <vector <MyDB_PageReaderWriter>> buildRunsInParallel (int runSize, MyDB_TableReaderWriter &sortMe,
+	MyDB_SchemaPtr mySchema, string computation, bool descending, string pred) {
+
+	vector <vector <MyDB_PageReaderWriter>> returnVal;
+	size_t numThreads = max (1u, thread :: hardware_concurrency ());
+	vector <SortRun> runs (numThreads);
+	int numPages = sortMe.getNumPages ();
+	for (int nextPage = 0; nextPage < numPages; ) {
+
+		size_t numRuns = 0;
+		for (; numRuns < numThreads && nextPage < numPages; numRuns++) {
+			runs[numRuns].records.clear ();
+			for (int i = 0; i < runSize && nextPage < numPages; nextPage++) {
+				MyDB_PageReaderWriter page = sortMe[nextPage];
+				if (page.getType () == MyDB_PageType :: RegularPage) {
+					page.copyRecords (runs[numRuns].records);
+					i++;
+				}
+			}
+		}
+
+		vector <thread> workers;
+		for (size_t i = 1; i < numRuns; i++)
+			workers.push_back (thread (sortRun, mySchema, computation, descending, pred, ref (runs[i])));
+		sortRun (mySchema, computation, descending, pred, runs[0]);
+		for (auto &worker : workers)
+			worker.join ();
+
+		for (size_t i = 0; i < numRuns; i++) {
+			if (!runs[i].sorted.empty ())
+				returnVal.push_back (writeToPages (sortMe.getBufferMgr (), runs[i].sorted));
+		}
+	}
+
+	getSortCounters ().runsBuilt += returnVal.size ();
+	return returnVal;
+}
+
+// a record waiting in the heap used for replacement selection: the run that it is going to be written to,
+// its key, and the slot that holds a copy of it
+struct WaitingRecord {
+	size_t run;
+	MyDB_KeyedRecord keyed;
+	size_t slot;
+};
+
+// the first phase of a TPMMS, using replacement selection.  A heap holds up to runSize pages worth of the
+// records of sortMe (only those accepted by the predicate); the smallest record that is not less than the
+// last one written to the current run is written out, and each record that is read in is either put in
+// the current run (if it is not less than the last record written) or held for the next one
+static vector <vector <MyDB_PageReaderWriter>> buildRunsByReplacementSelection (int runSize, 
+	MyDB_TableReaderWriter &sortMe, function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, 
+	string pred) {
+
+	MyDB_BufferManagerPtr parent = sortMe.getBufferMgr ();
+	size_t budget = runSize * parent->getPageSize ();
+	bool skipPred = (pred == "bool[true]");
+	func f = lhs->compileComputation (pred);
+
+	// the records are compared on their keys if we can, and in full if not
+	MyDB_SortKeyPtr sortKey = MyDB_SortKey :: forComparator (comparator, lhs->getSchema ());
+	MyDB_KeyedComparator lessThan (sortKey != nullptr && sortKey->isExact (), comparator, lhs, rhs);
+	auto heapOrder = [&] (const WaitingRecord &a, const WaitingRecord &b) {
+		if (a.run != b.run)
+			return a.run > b.run;
+		return lessThan (b.keyed, a.keyed);
+	};
+
+	// the copies of the records in the heap are kept in slots, which are reused
+	vector <vector <char>> slots;
+	vector <size_t> freeSlots;
+	vector <WaitingRecord> heap;
+	size_t heapBytes = 0;
+
+	vector <vector <MyDB_PageReaderWriter>> returnVal;
+	vector <MyDB_PageReaderWriter> curRun;
+	MyDB_PageReaderWriter curPage (*parent);
+	size_t curRunNum = 0;
+	bool wroteAny = false;
+
+	// the last record written out
+	vector <char> lastOut;
+	MyDB_KeyedRecord lastKeyed;
+
+	// writes the smallest record in the heap to its run, starting a new run if need be
+	auto writeSmallest = [&] () {
+		pop_heap (heap.begin (), heap.end (), heapOrder);
+		WaitingRecord smallest = heap.back ();
+		heap.pop_back ();
+		if (smallest.run != curRunNum) {
+			curRun.push_back (curPage);
+			returnVal.push_back (curRun);
+			curRun.clear ();
+			curPage = MyDB_PageReaderWriter (*parent);
+			curRunNum = smallest.run;
+		}
+
+		vector <char> &rec = slots[smallest.slot];
+		if (curPage.appendBinary (rec.data (), rec.size ()) == 0) {
+			curRun.push_back (curPage);
+			curPage = MyDB_PageReaderWriter (*parent);
+			if (curPage.appendBinary (rec.data (), rec.size ()) == 0) {
+				cout << "Record of " << rec.size () << " bytes is too big for a page.\n";
+				exit (1);
+			}
+		}
+		wroteAny = true;
+
+		lastOut.swap (rec);
+		lastKeyed.key = smallest.keyed.key;
+		lastKeyed.rec = lastOut.data ();
+		heapBytes -= lastOut.size ();
+		freeSlots.push_back (smallest.slot);
+	};
+
+	MyDB_RecordIteratorAltPtr input = sortMe.getIteratorAlt ();
+	while (input->advance ()) {
+
+		char *pos = (char *) input->getCurrentPointer ();
+		if (!skipPred) {
+			lhs->fromBinary (pos);
+			if (!f ()->toBool ())
+				continue;
+		}
+
+		// make room for the record
+		size_t recSize = *((short *) pos);
+		while (!heap.empty () && heapBytes + recSize > budget)
+			writeSmallest ();
+
+		// and copy it into the heap
+		size_t slot;
+		if (freeSlots.empty ()) {
+			slot = slots.size ();
+			slots.push_back (vector <char> ());
+		} else {
+			slot = freeSlots.back ();
+			freeSlots.pop_back ();
+		}
+		slots[slot].assign (pos, pos + recSize);
+		heapBytes += recSize;
+
+		WaitingRecord waiting;
+		waiting.slot = slot;
+		waiting.keyed.rec = slots[slot].data ();
+		waiting.keyed.key = sortKey == nullptr ? 0 : sortKey->encode (waiting.keyed.rec);
+
+		// a record that is less than the last one written has to wait for the next run
+		waiting.run = curRunNum;
+		if (wroteAny && lessThan (waiting.keyed, lastKeyed))
+			waiting.run++;
+
+		heap.push_back (waiting);
+		push_heap (heap.begin (), heap.end (), heapOrder);
+	}
+
+	while (!heap.empty ())
+		writeSmallest ();
+
+	if (wroteAny) {
+		curRun.push_back (curPage);
+		returnVal.push_back (curRun);
+	}
+
+	getSortCounters ().runsBuilt += returnVal.size ();
+	getSortCounters ().replacementSelections++;
+	return returnVal;
+}
+
+// true if a sort should build its runs by replacement selection: either it was asked to, or runs of runSize
+// pages would be more than can be merged at once with runSize pages of memory
+static bool useReplacementSelection (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_RunGeneration how) {
+	if (how != MyDB_RunGeneration :: Automatic)
+		return how == MyDB_RunGeneration :: ReplacementSelection;
+	return sortMe.getNumPages () > runSize * runSize;
+}
+
+// one of the key ranges that the final merge of a parallel TPMMS is split into.  Each worker thread merges the
+// records in one range, from all of the runs, so that disjoint ranges are merged at the same time and then
+// written out one after another
+struct MergeRange {
+
+	// the records bounding the range; the range holds the records that are not less than low, and are less
+	// than high... an empty bound means that the range is unbounded on that side
+	vector <char> low;
+	vector <char> high;
+
+	// for each run, the records from the pages that may have records in the range, and where the last of
+	// those pages starts (only the first and last page can have records outside of the range)
+	vector <vector <char>> runs;
+	vector <size_t> lastPageStart;
+
+	// the merged records
+	vector <char> merged;
+};
+
+// merges the records in a range; this is run by the worker threads of a parallel sort
+static void mergeRange (MyDB_SchemaPtr mySchema, string computation, bool descending, MergeRange &range) {
+
+	MyDB_RecordPtr lhs = make_shared <MyDB_Record> (mySchema);
+	MyDB_RecordPtr rhs = make_shared <MyDB_Record> (mySchema);
+	function <bool ()> comparator = buildRecordComparator (lhs, rhs, computation, descending);
+	RecordComparator lessThan (comparator, lhs, rhs);
+	MyDB_SortKey sortKey (mySchema, computation, descending);
+	MyDB_KeyedComparator keyedLessThan (sortKey.isExact (), comparator, lhs, rhs);
+
+	// find the records from each run that are in the range
+	vector <char *> cur, end;
+	for (size_t r = 0; r < range.runs.size (); r++) {
+		char *pos = range.runs[r].data ();
+		char *last = pos + range.runs[r].size ();
+		while (!range.low.empty () && pos < last && lessThan (pos, range.low.data ()))
+			pos += *((short *) pos);
+		if (!range.high.empty ()) {
+			char *stop = range.runs[r].data () + range.lastPageStart[r];
+			if (stop < pos)
+				stop = pos;
+			while (stop < last && lessThan (stop, range.high.data ()))
+				stop += *((short *) stop);
+			last = stop;
+		}
+		if (pos < last) {
+			cur.push_back (pos);
+			end.push_back (last);
+		}
+	}
+
+	// and merge them, using a heap of the runs ordered on their current records (and their keys)
+	vector <MyDB_KeyedRecord> curKeyed (cur.size ());
+	auto heapOrder = [&] (size_t a, size_t b) {return keyedLessThan (curKeyed[b], curKeyed[a]);};
+	vector <size_t> heap;
+	for (size_t r = 0; r < cur.size (); r++) {
+		curKeyed[r].key = sortKey.encode (cur[r]);
+		curKeyed[r].rec = cur[r];
+		heap.push_back (r);
+	}
+	make_heap (heap.begin (), heap.end (), heapOrder);
+
+	range.merged.clear ();
+	while (!heap.empty ()) {
+		pop_heap (heap.begin (), heap.end (), heapOrder);
+		size_t r = heap.back ();
+		short recSize = *((short *) cur[r]);
+		range.merged.insert (range.merged.end (), cur[r], cur[r] + recSize);
+		cur[r] += recSize;
+		if (cur[r] < end[r]) {
+			curKeyed[r].key = sortKey.encode (cur[r]);
+			curKeyed[r].rec = cur[r];
+			push_heap (heap.begin (), heap.end (), heapOrder);
+		}
+		else
+			heap.pop_back ();
+	}
+}
+
+// the second phase of a parallel TPMMS.  The first record on each page of each run is used to cut the key
+// space into ranges of about runSize pages each; a batch of ranges (one per thread) is copied out and merged
+// in parallel, and the merged ranges are then appended to sortIntoMe in order
+static void mergeRunsInParallel (int runSize, vector <vector <MyDB_PageReaderWriter>> &runs,
+	MyDB_TableReaderWriter &sortIntoMe, MyDB_SchemaPtr mySchema, string computation, bool descending,
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	// get the first record on every page, reading the next page of the run in the background
+	vector <vector <vector <char>>> fences (runs.size ());
+	vector <void *> allFences;
+	for (size_t r = 0; r < runs.size (); r++) {
+		for (size_t i = 0; i < runs[r].size (); i++) {
+			if (i + 1 < runs[r].size ())
+				runs[r][i + 1].prefetch ();
+			MyDB_RecordIteratorAltPtr temp = runs[r][i].getIteratorAlt ();
+			temp->advance ();
+			char *rec = (char *) temp->getCurrentPointer ();
+			fences[r].push_back (vector <char> (rec, rec + *((short *) rec)));
+		}
+		for (auto &fence : fences[r])
+			allFences.push_back (fence.data ());
+	}
+
+	// remember which page each one came from
+	unordered_map <void *, pair <size_t, size_t>> fencePages;
+	for (size_t r = 0; r < runs.size (); r++)
+		for (size_t i = 0; i < fences[r].size (); i++)
+			fencePages[fences[r][i].data ()] = make_pair (r, i);
+
+	// sort them, and take every runSize^th one as the start of a new range
+	RecordComparator lessThan (comparator, lhs, rhs);
+	sortRecords (allFences, comparator, lhs, rhs);
+	vector <void *> splitters;
+	for (size_t i = runSize; i < allFences.size (); i += runSize)
+		splitters.push_back (allFences[i]);
+
+	size_t numThreads = max (1u, thread :: hardware_concurrency ());
+	vector <MergeRange> ranges (numThreads);
+
+	// for each run, the first page that may have records in the next range
+	vector <size_t> firstPage (runs.size (), 0);
+	for (size_t nextRange = 0; nextRange <= splitters.size (); ) {
+
+		size_t numRanges = 0;
+		for (; numRanges < numThreads && nextRange <= splitters.size (); numRanges++, nextRange++) {
+
+			MergeRange &range = ranges[numRanges];
+			char *low = nextRange == 0 ? nullptr : (char *) splitters[nextRange - 1];
+			char *high = nextRange == splitters.size () ? nullptr : (char *) splitters[nextRange];
+			range.low.clear ();
+			range.high.clear ();
+			if (low != nullptr)
+				range.low.assign (low, low + *((short *) low));
+			if (high != nullptr)
+				range.high.assign (high, high + *((short *) high));
+
+			range.runs.resize (runs.size ());
+			range.lastPageStart.resize (runs.size ());
+			for (size_t r = 0; r < runs.size (); r++) {
+
+				// the records in the range start on the last page whose first record is less than low...
+				size_t &first = firstPage[r];
+				while (low != nullptr && first + 1 < fences[r].size () && lessThan (fences[r][first + 1].data (), low))
+					first++;
+
+				// and end on the last page whose first record is less than high
+				size_t last = first;
+				while (last + 1 < fences[r].size () && (high == nullptr || lessThan (fences[r][last + 1].data (), high)))
+					last++;
+
+				range.runs[r].clear ();
+				range.lastPageStart[r] = 0;
+				if (high != nullptr && !lessThan (fences[r][first].data (), high))
+					continue;
+				for (size_t i = first; i <= last; i++) {
+					range.lastPageStart[r] = range.runs[r].size ();
+					runs[r][i].copyRecords (range.runs[r]);
+				}
+			}
+		}
+
+		// the pages that the next batch of ranges start on are (more or less) the next ones in the order of
+		// their first records, so they are read in the background while this batch is merged
+		size_t prefetchEnd = min (allFences.size (), (nextRange + numThreads) * runSize);
+		for (size_t i = nextRange * runSize; i < prefetchEnd; i++) {
+			pair <size_t, size_t> &page = fencePages[allFences[i]];
+			runs[page.first][page.second].prefetch ();
+		}
+
+		vector <thread> workers;
+		for (size_t i = 1; i < numRanges; i++)
+			workers.push_back (thread (mergeRange, mySchema, computation, descending, ref (ranges[i])));
+		mergeRange (mySchema, computation, descending, ranges[0]);
+		for (auto &worker : workers)
+			worker.join ();
+
+		for (size_t i = 0; i < numRanges; i++)
+			sortIntoMe.appendBinary (ranges[i].merged);
+	}
+}
+
 MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
 	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
 
@@ -106,7 +555,26 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 }
 
 MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
-	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred) {
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred, MyDB_RunGeneration how) {
+
+	// if the comparator was built by buildRecordComparator, then each worker thread can build its own
+	// copy of it, and the runs are sorted in parallel (unless replacement selection is used)
+	MyDB_RecordLessThan *lessThan = comparator.target <MyDB_RecordLessThan> ();
+	bool replacementSelection = useReplacementSelection (runSize, sortMe, how);
+	if (lessThan != nullptr || replacementSelection) {
+		vector <vector <MyDB_PageReaderWriter>> runs = replacementSelection ?
+			buildRunsByReplacementSelection (runSize, sortMe, comparator, lhs, rhs, lhsPred) :
+			buildRunsInParallel (runSize, sortMe, lhs->getSchema (), lessThan->computation, lessThan->descending, lhsPred);
+
+		MyDB_RunQueueIteratorAltPtr temp = make_shared <MyDB_RunQueueIteratorAlt> (comparator, lhs, rhs);
+		for (auto &run : runs) {
+			MyDB_RecordIteratorAltPtr m = getIteratorAlt (run);
+			if (m->advance ()) {
+				temp->addRun (m);
+			}
+		}
+		return temp;
+	}
 
 	bool skipPred = false;
 	if (lhsPred == "bool[true]")
@@ -201,6 +669,7 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 		
 		// now we have a single list, so create an iterator for it
 		runIters.push_back (getIteratorAlt (pagesToSort[0]));
+		getSortCounters ().runsBuilt++;
 
 		// and start over on the next run
 		pagesToSort.clear ();
@@ -212,7 +681,7 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 	// load up the set
 	for (MyDB_RecordIteratorAltPtr m : runIters) {
 		if (m->advance ()) {
-			temp->getQ ().push (m);
+			temp->addRun (m);
 		}
 	}
 
@@ -221,10 +690,23 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 
 
 void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe,
-	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, MyDB_RunGeneration how) {
+
+	// if the comparator was built by buildRecordComparator, then both the runs and the final merge are
+	// done in parallel (unless the runs are built by replacement selection, which is done on this thread)
+	MyDB_RecordLessThan *lessThan = comparator.target <MyDB_RecordLessThan> ();
+	if (lessThan != nullptr) {
+		vector <vector <MyDB_PageReaderWriter>> runs = useReplacementSelection (runSize, sortMe, how) ?
+			buildRunsByReplacementSelection (runSize, sortMe, comparator, lhs, rhs, "bool[true]") :
+			buildRunsInParallel (runSize, sortMe, lhs->getSchema (), lessThan->computation, lessThan->descending, 
+			"bool[true]");
+		mergeRunsInParallel (runSize, runs, sortIntoMe, lhs->getSchema (), lessThan->computation, lessThan->descending,
+			comparator, lhs, rhs);
+		return;
+	}
 
 	// get the sorted runs
-	MyDB_RecordIteratorAltPtr myIter = buildItertorOverSortedRuns (runSize, sortMe, comparator, lhs, rhs);
+	MyDB_RecordIteratorAltPtr myIter = buildItertorOverSortedRuns (runSize, sortMe, comparator, lhs, rhs, "bool[true]", how);
 
 	// and write everyone out
 	while (myIter->advance ()) {
@@ -135,6 +135,13 @@ public:
 		for (int i = 0; i < depth; i++) cout << "  ";
 		cout << "  ** Input table: " << inputSpec->getName () << "\n";
 
+		// the scan only needs to read the attributes that make it into the output
+		for (int i = 0; i < depth; i++) cout << "  ";
+		cout << "  ** Attributes read:";
+		for (auto &a: outputSpec->getSchema ()->getAtts ())
+			cout << " " << a.first;
+		cout << "\n";
+
 		for (int i = 0; i < depth; i++) cout << "  ";
 		cout << "  ** Predicates:\n";
 
@@ -157,4 +164,61 @@ private:
         vector <ExprTreePtr> selectionPred;
 };
 
+// a logical ORDER BY / LIMIT operation---will be implemented with a TopN, which is always the last operation
+// in the plan
+class LogicalTopN : public LogicalOp {
+
+public:
+
+	//
+	// inputOp: this is the input operation that we are reading from
+	// outputSpec: this is the table that we are going to create by running the operation
+	// orderBy: the computations to order on, most significant first, each with true if it is descending
+	// limit: the number of tuples to keep (negative if there is no LIMIT)
+	// outputStats: the satistics describing the relation created by this operation
+	//
+	LogicalTopN (LogicalOpPtr inputOp, MyDB_TablePtr outputSpec, vector <pair <ExprTreePtr, bool>> &orderBy,
+		long limit, MyDB_StatsPtr outputStats) : inputOp (inputOp), outputSpec (outputSpec), orderBy (orderBy),
+		limit (limit), outputStats (outputStats) {}
+
+	// print this tree out
+	void print (int depth, vector <MyDB_TablePtr> &outputs) override {
+
+		for (int i = 0; i < depth; i++) cout << "  ";
+		cout << "****** TOP N returning " << outputStats->getTupleCount () << " tuples.\n";
+
+		for (int i = 0; i < depth; i++) cout << "  ";
+		cout << "  ** Output table: " << outputSpec->getName () << "\n";
+
+		for (int i = 0; i < depth; i++) cout << "  ";
+		cout << "  ** Order by:\n";
+
+		for (auto &a: orderBy) {
+			for (int i = 0; i < depth; i++) cout << "  ";
+			cout << "    " << a.first->toString () << (a.second ? " DESC" : " ASC") << "\n";
+		}
+
+		if (limit >= 0) {
+			for (int i = 0; i < depth; i++) cout << "  ";
+			cout << "  ** Limit: " << limit << "\n";
+		}
+
+		for (int i = 0; i < depth; i++) cout << "  ";
+		cout << "  ** Input tree:\n";
+		inputOp->print (depth + 1, outputs);
+
+		outputs.push_back (outputSpec);
+	}
+
+	MyDB_StatsPtr getStats () override {return outputStats;}
+
+private:
+
+	LogicalOpPtr inputOp;
+	MyDB_TablePtr outputSpec;
+	vector <pair <ExprTreePtr, bool>> orderBy;
+	long limit;
+	MyDB_StatsPtr outputStats;
+};
+
 #endif
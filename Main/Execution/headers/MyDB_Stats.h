@@ -36,6 +36,9 @@ public:
 	// cost a selection predicte
 	MyDB_StatsPtr costSelection (vector <ExprTreePtr> &allDisjunctions);
 
+	// cost keeping only the first limit tuples (a negative limit keeps all of them)
+	MyDB_StatsPtr costLimit (long limit);
+
 private:
 
 	vector <pair <double, string>> allAtts;
@@ -16,6 +16,10 @@ private:
 	vector <ExprTreePtr> allDisjunctions;
 	vector <ExprTreePtr> groupingClauses;
 
+	// the ORDER BY clause (each computation with true if it is descending), and the LIMIT (negative if none)
+	vector <pair <ExprTreePtr, bool>> orderingClauses;
+	long limit = -1;
+
 public:
 	SFWQuery () {}
 
@@ -26,6 +30,10 @@ public:
 		struct CNF *cnf);
 
 	SFWQuery (struct ValueList *selectClause, struct FromList *fromClause);
+
+	// adds an ORDER BY clause and a LIMIT to the query
+	void addOrderBy (struct OrderList *orderBy);
+	void addLimit (long limit);
 	
 	// builds and optimizes a logical query plan for a SFW query, returning the resulting logical query plan
 	//
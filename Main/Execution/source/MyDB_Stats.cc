@@ -142,6 +142,22 @@ MyDB_StatsPtr MyDB_Stats :: costSelection (vector <ExprTreePtr> &allDisjunctions
 }
 
 
+MyDB_StatsPtr MyDB_Stats :: costLimit (long limit) {
+
+	MyDB_StatsPtr returnVal = make_shared <MyDB_Stats> ();
+	*returnVal = *this;
+	if (limit < 0 || limit >= tupleCount)
+		return returnVal;
+
+	// no attribute can have more distinct values than there are tuples
+	returnVal->tupleCount = limit;
+	for (auto &b: returnVal->allAtts) {
+		if (b.first > limit)
+			b.first = limit;
+	}
+	return returnVal;
+}
+
 MyDB_StatsPtr MyDB_Stats ::  costJoin (vector <ExprTreePtr> &allDisjunctions, MyDB_StatsPtr RHS) {
 
 	// search through the clauses to find an equality check
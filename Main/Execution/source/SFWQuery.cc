@@ -3,6 +3,7 @@
 #define SFW_QUERY_CC
 
 #include "ParserTypes.h"
+#include <algorithm>
 #include <unordered_set>
 #include <utility>
 #include <functional>
@@ -44,17 +45,40 @@ pair<LogicalOpPtr, double> SFWQuery ::optimizeQueryPlan(map<string, MyDB_TablePt
         cout << "Predicate: " << pred->toString() << endl;
     }
 
-    // Detailed schema building
+    // Detailed schema building; only the attributes that the query actually refers to are
+    // carried up from the scans, so that the scans only need to read those columns
+    vector<ExprTreePtr> allExprs = valuesToSelect;
+    allExprs.insert(allExprs.end(), groupingClauses.begin(), groupingClauses.end());
+    allExprs.insert(allExprs.end(), allDisjunctions.begin(), allDisjunctions.end());
+    for (auto &ordering : orderingClauses)
+        allExprs.push_back(ordering.first);
     for (auto &entry : tables)
     {   
         cout << "Table: " << entry.first << "\n";
+        string alias = entry.first;
         for (auto &att : entry.second->getSchema()->getAtts())
         {
-            totSchema->appendAtt(att);
+            string attName = att.first;
+            if (any_of(allExprs.begin(), allExprs.end(),
+                       [&alias, &attName](ExprTreePtr expr) {
+                           return expr->referencesAtt(alias, attName);
+                       }))
+            {
+                totSchema->appendAtt(att);
+            }
         }
     }
 
-    return optimizeQueryPlan(tables, totSchema, allDisjunctions);
+    pair<LogicalOpPtr, double> res = optimizeQueryPlan(tables, totSchema, allDisjunctions);
+
+    // an ORDER BY or a LIMIT is run over the result of the whole plan
+    if (res.first != nullptr && (orderingClauses.size() > 0 || limit >= 0))
+    {
+        MyDB_TablePtr outputSpec = make_shared<MyDB_Table>("TopNOutput", "topNOutput.bin", totSchema);
+        MyDB_StatsPtr stats = res.first->getStats()->costLimit(limit);
+        res.first = make_shared<LogicalTopN>(res.first, outputSpec, orderingClauses, limit, stats);
+    }
+    return res;
 }
 
 // builds and optimizes a logical query plan for a SFW query, returning the logical query plan
@@ -163,56 +187,37 @@ pair<LogicalOpPtr, double> SFWQuery ::optimizeQueryPlan(map<string, MyDB_TablePt
 
 		// LeftAtts ← Atts(Left) ∩ (A ∪ Atts(TopCNF))
 		// RightAtts ← Atts(Right) ∩ (A ∪ Atts(TopCNF))
-		// MyDB_SchemaPtr leftSchema = make_shared<MyDB_Schema>(), rightSchema = make_shared<MyDB_Schema>();
-        // for (auto &entry : left) {
-        //     auto alias = entry.first;
-        //     auto table = entry.second;
-        //     for (auto &att : table->getSchema()->getAtts()) {
-        //         string attName = att.first;
-        //         MyDB_AttTypePtr attType = att.second;
-        //         if (allAtts.count(make_pair(attName, attType)) ||
-        //             any_of(topDisjunctions.begin(), topDisjunctions.end(),
-        //                    [&alias, &attName](ExprTreePtr disjunction) {
-        //                        return disjunction->referencesAtt(alias, attName);
-        //                    })) {
-        //             leftSchema->appendAtt(make_pair(attName, attType));
-        //         }
-        //     }
-        // }
-
-        // for (auto &entry : right) {
-        //     auto alias = entry.first;
-        //     auto table = entry.second;
-        //     for (auto &att : table->getSchema()->getAtts()) {
-        //         string attName = att.first;
-        //         MyDB_AttTypePtr attType = att.second;
-        //         if (allAtts.count(make_pair(attName, attType)) ||
-        //             any_of(topDisjunctions.begin(), topDisjunctions.end(),
-        //                    [&alias, &attName](ExprTreePtr disjunction) {
-        //                        return disjunction->referencesAtt(alias, attName);
-        //                    })) {
-        //             rightSchema->appendAtt(make_pair(attName, attType));
-        //         }
-        //     }
-        // }
-
-		// LeftAtts ← Atts(Left) and (A union Atts(TopCNF))
-		// RightAtts ← Atts(Right) and (A union Atts(TopCNF))
 		MyDB_SchemaPtr leftSchema = make_shared<MyDB_Schema>(), rightSchema = make_shared<MyDB_Schema>();
-		for (auto [alias, table] : left)
+		for (auto &entry : left)
 		{
-			// MyDB_TablePtr tempTable = table->alias(alias);
-			for (auto [attName, attType] : table->getSchema()->getAtts())
+			string alias = entry.first;
+			for (auto &att : entry.second->getSchema()->getAtts())
 			{
-				leftSchema->appendAtt(make_pair(attName, attType));
+				string attName = att.first;
+				if (allAtts.count(att) ||
+					any_of(topDisjunctions.begin(), topDisjunctions.end(),
+						   [&alias, &attName](ExprTreePtr disjunction) {
+							   return disjunction->referencesAtt(alias, attName);
+						   }))
+				{
+					leftSchema->appendAtt(att);
+				}
 			}
 		}
-		for (auto [alias, table] : right)
+		for (auto &entry : right)
 		{
-			// MyDB_TablePtr tempTable = table->alias(alias);
-			for (auto [attName, attType] : table->getSchema()->getAtts())
+			string alias = entry.first;
+			for (auto &att : entry.second->getSchema()->getAtts())
 			{
-				rightSchema->appendAtt(make_pair(attName, attType));
+				string attName = att.first;
+				if (allAtts.count(att) ||
+					any_of(topDisjunctions.begin(), topDisjunctions.end(),
+						   [&alias, &attName](ExprTreePtr disjunction) {
+							   return disjunction->referencesAtt(alias, attName);
+						   }))
+				{
+					rightSchema->appendAtt(att);
+				}
 			}
 		}
 
@@ -273,6 +278,15 @@ void SFWQuery ::print()
 	{
 		cout << "\t" << a->toString() << "\n";
 	}
+	cout << "Order by:\n";
+	for (auto a : orderingClauses)
+	{
+		cout << "\t" << a.first->toString() << (a.second ? " DESC" : " ASC") << "\n";
+	}
+	if (limit >= 0)
+	{
+		cout << "Limit: " << limit << "\n";
+	}
 }
 
 SFWQuery ::SFWQuery(struct ValueList *selectClause, struct FromList *fromClause,
@@ -299,4 +313,14 @@ SFWQuery ::SFWQuery(struct ValueList *selectClause, struct FromList *fromClause)
 	allDisjunctions.push_back(make_shared<BoolLiteral>(true));
 }
 
+void SFWQuery ::addOrderBy(struct OrderList *orderBy)
+{
+	orderingClauses = orderBy->orderings;
+}
+
+void SFWQuery ::addLimit(long limitIn)
+{
+	limit = limitIn;
+}
+
 #endif
@@ -2,12 +2,174 @@
 #ifndef ATT_VAL_H
 #define ATT_VAL_H
 
+#include "MyDB_Hash.h"
+#include <climits>
 #include <memory>
 #include <string>
 #include <string.h>
 
 // create a smart pointer for the catalog
 using namespace std;
+
+// a borrowed view of a string that lives somewhere else (in a page, in a record's buffer, or in an
+// attribute value); this plays the part of std::string_view, which we cannot use as we build as C++11.
+// The view is good until whatever it points into changes
+struct MyDB_StringView {
+
+	const char *data;
+	size_t size;
+
+	MyDB_StringView () : data (""), size (0) {}
+	MyDB_StringView (const char *dataIn, size_t sizeIn) : data (dataIn), size (sizeIn) {}
+	MyDB_StringView (const string &fromMe) : data (fromMe.c_str ()), size (fromMe.size ()) {}
+
+	// same result as string::compare
+	inline int compare (const MyDB_StringView &other) const {
+		int res = memcmp (data, other.data, size < other.size ? size : other.size);
+		if (res != 0)
+			return res;
+		return size < other.size ? -1 : (size > other.size ? 1 : 0);
+	}
+
+	inline string toString () const {
+		return string (data, size);
+	}
+};
+
+inline bool operator < (const MyDB_StringView &lhs, const MyDB_StringView &rhs) { return lhs.compare (rhs) < 0; }
+inline bool operator > (const MyDB_StringView &lhs, const MyDB_StringView &rhs) { return lhs.compare (rhs) > 0; }
+inline bool operator == (const MyDB_StringView &lhs, const MyDB_StringView &rhs) { 
+	return lhs.size == rhs.size && memcmp (lhs.data, rhs.data, lhs.size) == 0; 
+}
+inline bool operator != (const MyDB_StringView &lhs, const MyDB_StringView &rhs) { return !(lhs == rhs); }
+
+// a 128-bit integer, used to hold decimal values (and sums of decimal values) exactly
+typedef __int128 MyDB_WideInt;
+
+// the largest number of digits a decimal can have and still fit into 64 bits, or into 128 bits
+#define MyDB_MAX_NARROW_DIGITS 18
+#define MyDB_MAX_WIDE_DIGITS 38
+
+// the smallest number of digits after the decimal point in the result of a division
+#define MyDB_DIVIDE_SCALE 6
+
+// the largest value a MyDB_WideInt can hold
+#define MyDB_WIDE_MAX ((MyDB_WideInt) (~((unsigned __int128) 0) >> 1))
+
+// returns 10^power, for power from 0 to MyDB_MAX_NARROW_DIGITS
+inline long long MyDB_powerOfTen (int power) {
+	static const long long powers[] = {1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+		100000000LL, 1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+		100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL, 1000000000000000000LL};
+	return powers[power];
+}
+
+// called when the result of a decimal operation is too large to be held; prints an error and exits
+[[noreturn]] void MyDB_decimalOverflow ();
+
+// changes the scale of a scaled integer; digits dropped when going to a smaller scale are rounded (half away from zero),
+// and a value that would not fit into 128 bits at a larger scale is an overflow
+inline MyDB_WideInt MyDB_rescale (MyDB_WideInt val, int fromScale, int toScale) {
+	while (toScale > fromScale) {
+		int step = toScale - fromScale < MyDB_MAX_NARROW_DIGITS ? toScale - fromScale : MyDB_MAX_NARROW_DIGITS;
+		long long factor = MyDB_powerOfTen (step);
+		if (val > MyDB_WIDE_MAX / factor || val < -MyDB_WIDE_MAX / factor)
+			MyDB_decimalOverflow ();
+		val *= factor;
+		fromScale += step;
+	}
+
+	// digits more than MyDB_MAX_NARROW_DIGITS places down can just be dropped, since only whether the
+	// rest is at least one half decides the rounding
+	if (fromScale - toScale > MyDB_MAX_NARROW_DIGITS) {
+		val /= MyDB_powerOfTen (fromScale - toScale - MyDB_MAX_NARROW_DIGITS);
+		fromScale = toScale + MyDB_MAX_NARROW_DIGITS;
+	}
+	if (toScale == fromScale)
+		return val;
+	long long divisor = MyDB_powerOfTen (fromScale - toScale);
+	MyDB_WideInt half = (val < 0 ? -divisor : divisor) / 2;
+	return (val + half) / divisor;
+}
+
+// an exact decimal number: val / 10^scale.  This is what a decimal attribute is unboxed into by the
+// compiled expression kernels; two decimals with the same scale are added, subtracted and compared as
+// plain 64-bit ints.  Anything else is worked out in 128 bits and then rounded to the scale of the result;
+// a result that does not fit into 64 bits at that scale is an overflow
+struct MyDB_Decimal {
+
+	long long val;
+	int scale;
+
+	MyDB_Decimal () : val (0), scale (0) {}
+	MyDB_Decimal (long long valIn, int scaleIn) : val (valIn), scale (scaleIn) {}
+
+	// an int is a decimal with no digits after the decimal point
+	MyDB_Decimal (int fromMe) : val (fromMe), scale (0) {}
+
+	explicit operator double () const {
+		return (double) val / MyDB_powerOfTen (scale);
+	}
+
+	// the value, with the given (larger) scale; this always fits, as the scale is at most MyDB_MAX_NARROW_DIGITS
+	inline MyDB_WideInt at (int toScale) const {
+		return toScale == scale ? val : (MyDB_WideInt) val * MyDB_powerOfTen (toScale - scale);
+	}
+};
+
+// the decimal with the given scaled value, which has to fit into 64 bits
+inline MyDB_Decimal MyDB_narrowDecimal (MyDB_WideInt val, int scale) {
+	if (val > LLONG_MAX || val < LLONG_MIN)
+		MyDB_decimalOverflow ();
+	return MyDB_Decimal ((long long) val, scale);
+}
+
+inline MyDB_Decimal operator + (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) {
+	if (lhs.scale == rhs.scale)
+		return MyDB_narrowDecimal ((MyDB_WideInt) lhs.val + rhs.val, lhs.scale);
+	int scale = lhs.scale > rhs.scale ? lhs.scale : rhs.scale;
+	return MyDB_narrowDecimal (lhs.at (scale) + rhs.at (scale), scale);
+}
+inline MyDB_Decimal operator - (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) {
+	if (lhs.scale == rhs.scale)
+		return MyDB_narrowDecimal ((MyDB_WideInt) lhs.val - rhs.val, lhs.scale);
+	int scale = lhs.scale > rhs.scale ? lhs.scale : rhs.scale;
+	return MyDB_narrowDecimal (lhs.at (scale) - rhs.at (scale), scale);
+}
+inline MyDB_Decimal operator * (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) {
+
+	// the product of two 64-bit values always fits into 128 bits; it is rounded to the largest scale a decimal
+	// result can have
+	int scale = lhs.scale + rhs.scale;
+	MyDB_WideInt product = (MyDB_WideInt) lhs.val * rhs.val;
+	if (scale > MyDB_MAX_NARROW_DIGITS) {
+		product = MyDB_rescale (product, scale, MyDB_MAX_NARROW_DIGITS);
+		scale = MyDB_MAX_NARROW_DIGITS;
+	}
+	return MyDB_narrowDecimal (product, scale);
+}
+inline MyDB_Decimal operator / (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) {
+	int scale = lhs.scale > rhs.scale ? lhs.scale : rhs.scale;
+	scale = scale > MyDB_DIVIDE_SCALE ? scale : MyDB_DIVIDE_SCALE;
+	MyDB_WideInt num = MyDB_rescale (lhs.val, lhs.scale, scale + rhs.scale);
+	MyDB_WideInt half = ((num < 0) != (rhs.val < 0) ? -rhs.val : rhs.val) / 2;
+	return MyDB_narrowDecimal ((num + half) / rhs.val, scale);
+}
+inline MyDB_Decimal operator - (const MyDB_Decimal &ofMe) {
+	return MyDB_narrowDecimal (-(MyDB_WideInt) ofMe.val, ofMe.scale);
+}
+inline int MyDB_compare (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) {
+	if (lhs.scale == rhs.scale)
+		return lhs.val < rhs.val ? -1 : (lhs.val > rhs.val ? 1 : 0);
+	int scale = lhs.scale > rhs.scale ? lhs.scale : rhs.scale;
+	MyDB_WideInt l = lhs.at (scale), r = rhs.at (scale);
+	return l < r ? -1 : (l > r ? 1 : 0);
+}
+inline bool operator < (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) { return MyDB_compare (lhs, rhs) < 0; }
+inline bool operator > (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) { return MyDB_compare (lhs, rhs) > 0; }
+inline bool operator == (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) { return MyDB_compare (lhs, rhs) == 0; }
+inline bool operator != (const MyDB_Decimal &lhs, const MyDB_Decimal &rhs) { return MyDB_compare (lhs, rhs) != 0; }
+
 class MyDB_AttVal;
 typedef shared_ptr <MyDB_AttVal> MyDB_AttValPtr;
 
@@ -35,6 +197,14 @@ public:
 	virtual void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) = 0;
 	virtual ~MyDB_AttVal ();
 
+	// parses the value from the text in [begin, end); this is what the loader uses, so the common
+	// types override it to parse in place... the default makes a string and calls fromString
+	virtual void fromChars (const char *begin, const char *end);
+
+	// appends the value in text form (just as toString writes it) to the given string; this is what
+	// the text writers use, so the common types override it to format without making a new string
+	virtual void appendString (string &appendToMe);
+
 	// this gets a pointer to our data... useful because we can avoid deserializing the record
 	inline void *getDataPointer () {
 		return myData;
@@ -92,19 +262,55 @@ public:
 	void fromInt (int fromMe) override;
 	bool toBool () override;
 	void fromString (string &fromMe) override;
+	void fromChars (const char *begin, const char *end) override;
+	void appendString (string &appendToMe) override;
 	void set (MyDB_AttValPtr toMe) override;
 	size_t hash () override;
 	MyDB_AttValPtr getCopy () override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
-	void set (int val);
 	MyDB_IntAttVal ();
 	~MyDB_IntAttVal ();
 
+	// non-virtual versions of toInt () and set (), used by the compiled expression kernels
+	inline int getInt () {
+		void *dataPtr = getDataPointer ();
+		return dataPtr == nullptr ? value : *((int *) dataPtr);
+	}
+
+	inline void set (int val) {
+		value = val;
+		setNotBuffered ();
+	}
+
 private:
 
 	int value;
 };
 
+class MyDB_DateAttVal;
+typedef shared_ptr <MyDB_DateAttVal> MyDB_DateAttValPtr;
+
+// a date, stored as the number of days since 1970-01-01.  Since this is just an int (and is stored
+// and hashed just like one) a date can be used anywhere an int can, so that comparing, sorting and
+// hashing dates runs at the speed of ints; only converting to and from text knows that it is a date
+class MyDB_DateAttVal : public MyDB_IntAttVal {
+
+public:
+
+	string toString () override;
+	void fromString (string &fromMe) override;
+	void fromChars (const char *begin, const char *end) override;
+	void appendString (string &appendToMe) override;
+	void set (MyDB_AttValPtr toMe) override;
+	MyDB_AttValPtr getCopy () override;
+	using MyDB_IntAttVal :: set;
+
+	// converts a date in the form YYYY-MM-DD to a day number, and back
+	static int parse (const string &fromMe);
+	static string format (int dayNum);
+	static void format (int dayNum, string &appendToMe);
+};
+
 class MyDB_DoubleAttVal;
 typedef shared_ptr <MyDB_DoubleAttVal> MyDB_DoubleAttValPtr;
 
@@ -121,16 +327,97 @@ public:
 	size_t hash () override;
 	void set (MyDB_AttValPtr toMe) override;
 	void fromString (string &fromMe) override;
+	void fromChars (const char *begin, const char *end) override;
+	void appendString (string &appendToMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
-	void set (double val);
 	MyDB_DoubleAttVal ();
 	~MyDB_DoubleAttVal ();
 
+	// non-virtual versions of toDouble () and set (), used by the compiled expression kernels
+	inline double getDouble () {
+		void *dataPtr = getDataPointer ();
+		return dataPtr == nullptr ? value : *((double *) dataPtr);
+	}
+
+	inline void set (double val) {
+		value = val;
+		setNotBuffered ();
+	}
+
 private:
 
 	double value;
 };
 
+class MyDB_DecimalAttVal;
+typedef shared_ptr <MyDB_DecimalAttVal> MyDB_DecimalAttValPtr;
+
+// a fixed-point decimal with a given number of digits after the decimal point, stored as a scaled integer.
+// A narrow decimal is stored in 8 bytes; a wide one (more than MyDB_MAX_NARROW_DIGITS digits) takes 16
+// bytes, and is used to sum up narrow decimals without overflowing
+class MyDB_DecimalAttVal : public MyDB_AttVal {
+
+public:
+
+	int toInt () override;
+	double toDouble () override;
+	string toString () override;
+	bool toBool () override;
+	void fromInt (int fromMe) override;
+	MyDB_AttValPtr getCopy () override;
+	size_t hash () override;
+	void set (MyDB_AttValPtr toMe) override;
+	void fromString (string &fromMe) override;
+	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	MyDB_DecimalAttVal (int scale, bool wide);
+	~MyDB_DecimalAttVal ();
+
+	// the number of digits after the decimal point
+	inline int getScale () {
+		return scale;
+	}
+
+	// the exact scaled value
+	inline MyDB_WideInt getScaled () {
+		void *dataPtr = getDataPointer ();
+		if (dataPtr == nullptr)
+			return value;
+		if (!wide)
+			return *((long long *) dataPtr);
+		MyDB_WideInt res;
+		memcpy (&res, dataPtr, sizeof (res));
+		return res;
+	}
+
+	// non-virtual versions of the value and set (), used by the compiled expression kernels; a wide value
+	// too large for 64 bits loses digits after the decimal point until it fits
+	inline MyDB_Decimal getDecimal () {
+		MyDB_WideInt val = getScaled ();
+		if (!wide || (val <= MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS) && val >= -MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS)))
+			return MyDB_Decimal ((long long) val, scale);
+		return narrow (val);
+	}
+
+	inline void set (const MyDB_Decimal &val) {
+		value = val.scale == scale ? val.val : MyDB_rescale (val.val, val.scale, scale);
+		setNotBuffered ();
+	}
+
+	// adds to the value exactly; used to accumulate sums
+	inline void add (const MyDB_Decimal &val) {
+		value = getScaled () + (val.scale == scale ? val.val : MyDB_rescale (val.val, val.scale, scale));
+		setNotBuffered ();
+	}
+
+private:
+
+	MyDB_Decimal narrow (MyDB_WideInt val);
+
+	MyDB_WideInt value;
+	int scale;
+	bool wide;
+};
+
 class MyDB_StringAttVal;
 typedef shared_ptr <MyDB_StringAttVal> MyDB_StringAttValPtr;
 
@@ -143,6 +430,8 @@ public:
 	string toString () override;
 	bool toBool () override;
 	void fromString (string &fromMe) override;
+	void fromChars (const char *begin, const char *end) override;
+	void appendString (string &appendToMe) override;
 	MyDB_AttValPtr getCopy () override;
 	size_t hash () override;
 	void set (MyDB_AttValPtr toMe) override;
@@ -152,6 +441,17 @@ public:
 	MyDB_StringAttVal ();
 	~MyDB_StringAttVal ();
 
+	// a view of the string, pointing into the record buffer if that is where the string is (or at our own
+	// copy if it is not), so that it can be compared, hashed or copied without building a string
+	inline MyDB_StringView getView () {
+		char *dataPtr = (char *) getDataPointer ();
+		if (dataPtr == nullptr) 
+			return MyDB_StringView (value);
+
+		// the attribute's length is just in front of it, and counts itself and the null terminator
+		return MyDB_StringView (dataPtr, *((short *) (dataPtr - sizeof (short))) - sizeof (short) - 1);
+	}
+
 private:
 
 	string value;
@@ -174,10 +474,20 @@ public:
 	size_t hash () override;
 	void fromInt (int fromMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
-	void set (bool val);
 	MyDB_BoolAttVal ();
 	~MyDB_BoolAttVal ();
 
+	// non-virtual versions of toBool () and set (), used by the compiled expression kernels
+	inline bool getBool () {
+		void *dataPtr = getDataPointer ();
+		return dataPtr == nullptr ? value : (*((char *) dataPtr) == 1);
+	}
+
+	inline void set (bool val) {
+		value = val;
+		setNotBuffered ();
+	}
+
 private:
 
 	bool value;
@@ -0,0 +1,286 @@
+
+#ifndef EXPR_KERNELS_H
+#define EXPR_KERNELS_H
+
+#include "MyDB_AttVal.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// This file contains the kernels used by the expression compiler in MyDB_Record.  Each kernel is
+// a template specialized on the type of its left input, the type of its right input, and the
+// operation, so that once a computation has been compiled, evaluating (for example) an int < int
+// comparison over two attributes is a pair of loads and a compare, with no virtual calls and
+// no conversions.  The choice of kernel is made exactly once, when the computation is compiled.
+// Kernels over literals are run at compile time (constant folding), and each kernel remembers
+// its result for the rest of the evaluation in which it was computed, so that a sub-computation
+// that appears more than once within a computation is only done once per evaluation.
+
+using namespace std;
+
+// a lambda function over the record... computes an attribute value
+typedef function <MyDB_AttValPtr ()> func;
+
+// the function object compiled for a reference to one of a record's attributes; it reads
+// the attribute vector at evaluation time, so that it follows MyDB_Record::buildFrom.  The
+// kernels look for this (via func::target) so that they can read the attribute directly
+struct MyDB_AttRef {
+
+	vector <MyDB_AttValPtr> *atts;
+	size_t which;
+
+	MyDB_AttValPtr operator () () const {
+		return (*atts)[which];
+	}
+};
+
+// the function object compiled for a literal
+struct MyDB_Literal {
+
+	MyDB_AttValPtr val;
+
+	MyDB_AttValPtr operator () () const {
+		return val;
+	}
+};
+
+inline bool MyDB_isLiteral (const func &f) {
+	return f.target <MyDB_Literal> () != nullptr;
+}
+
+// per-record state shared by all of the kernels compiled over the record
+struct MyDB_ExprContext {
+
+	// incremented at the start of each (top-level) evaluation of a computation compiled over the record;
+	// a remembered result is only used during the evaluation that computed it, since the attributes can
+	// be changed in between in ways that the record never hears about
+	size_t epoch;
+
+	// the number of operations evaluated by computations compiled over the record
+	size_t numEvals;
+
+	MyDB_ExprContext () : epoch (0), numEvals (0) {}
+};
+
+typedef shared_ptr <MyDB_ExprContext> MyDB_ExprContextPtr;
+
+// an epoch that no evaluation ever has
+#define MyDB_NO_EPOCH ((size_t) -1)
+
+// the operations; each is applied to unboxed values
+struct MyDB_PlusOp {
+	template <class T> static inline T apply (const T &lhs, const T &rhs) { return lhs + rhs; }
+};
+
+struct MyDB_MinusOp {
+	template <class T> static inline T apply (const T &lhs, const T &rhs) { return lhs - rhs; }
+};
+
+struct MyDB_TimesOp {
+	template <class T> static inline T apply (const T &lhs, const T &rhs) { return lhs * rhs; }
+};
+
+struct MyDB_DivideOp {
+	template <class T> static inline T apply (const T &lhs, const T &rhs) { return lhs / rhs; }
+};
+
+struct MyDB_GtOp {
+	template <class T> static inline bool apply (const T &lhs, const T &rhs) { return lhs > rhs; }
+};
+
+struct MyDB_LtOp {
+	template <class T> static inline bool apply (const T &lhs, const T &rhs) { return lhs < rhs; }
+};
+
+struct MyDB_EqOp {
+	template <class T> static inline bool apply (const T &lhs, const T &rhs) { return lhs == rhs; }
+};
+
+struct MyDB_NeqOp {
+	template <class T> static inline bool apply (const T &lhs, const T &rhs) { return lhs != rhs; }
+};
+
+// maps an attribute value class to the C++ type it holds, and reads that value out of an
+// attribute without going through the virtual interface.  Strings are read as views into the
+// record, so that comparing them does not allocate.  MyDB_AttVal itself stands for "any type,
+// converted to a string", which is how mixed-type string operations are done
+template <class AttVal> struct MyDB_Unboxed;
+
+template <> struct MyDB_Unboxed <MyDB_IntAttVal> {
+	typedef int type;
+	static inline int load (MyDB_AttVal *from) { return static_cast <MyDB_IntAttVal *> (from)->getInt (); }
+};
+
+template <> struct MyDB_Unboxed <MyDB_DoubleAttVal> {
+	typedef double type;
+	static inline double load (MyDB_AttVal *from) { return static_cast <MyDB_DoubleAttVal *> (from)->getDouble (); }
+};
+
+template <> struct MyDB_Unboxed <MyDB_DecimalAttVal> {
+	typedef MyDB_Decimal type;
+	static inline MyDB_Decimal load (MyDB_AttVal *from) { return static_cast <MyDB_DecimalAttVal *> (from)->getDecimal (); }
+};
+
+template <> struct MyDB_Unboxed <MyDB_BoolAttVal> {
+	typedef bool type;
+	static inline bool load (MyDB_AttVal *from) { return static_cast <MyDB_BoolAttVal *> (from)->getBool (); }
+};
+
+template <> struct MyDB_Unboxed <MyDB_StringAttVal> {
+	typedef MyDB_StringView type;
+	static inline MyDB_StringView load (MyDB_AttVal *from) { return static_cast <MyDB_StringAttVal *> (from)->getView (); }
+};
+
+template <> struct MyDB_Unboxed <MyDB_AttVal> {
+	typedef string type;
+	static inline string load (MyDB_AttVal *from) { return from->toString (); }
+};
+
+// the three places an input to a kernel can come from: an attribute of the record...
+template <class AttVal>
+struct MyDB_AttSource {
+
+	vector <MyDB_AttValPtr> *atts;
+	size_t which;
+
+	MyDB_AttSource (const MyDB_AttRef &ref) : atts (ref.atts), which (ref.which) {}
+
+	inline typename MyDB_Unboxed <AttVal> :: type get () const {
+		return MyDB_Unboxed <AttVal> :: load ((*atts)[which].get ());
+	}
+};
+
+// ...a literal, which is unboxed once, at compile time...
+template <class AttVal>
+struct MyDB_ConstSource {
+
+	typename MyDB_Unboxed <AttVal> :: type val;
+
+	// the literal itself, which must outlive val when val is a view into it
+	MyDB_AttValPtr owner;
+
+	MyDB_ConstSource (const MyDB_Literal &lit) : val (MyDB_Unboxed <AttVal> :: load (lit.val.get ())), owner (lit.val) {}
+
+	inline const typename MyDB_Unboxed <AttVal> :: type &get () const {
+		return val;
+	}
+};
+
+// ...or the result of some other computation
+template <class AttVal>
+struct MyDB_FuncSource {
+
+	func f;
+
+	MyDB_FuncSource (const func &fIn) : f (fIn) {}
+
+	inline typename MyDB_Unboxed <AttVal> :: type get () const {
+		return MyDB_Unboxed <AttVal> :: load (f ().get ());
+	}
+};
+
+// the record-at-a-time kernel: computes op (lhs, rhs) in the type Promoted, and stores the result into temp.
+// If a context is given, the result is remembered for the rest of the current evaluation, so that a sub-computation
+// that is used more than once is done once per evaluation
+template <class Op, class Promoted, class Result, class LhsSource, class RhsSource>
+inline func MyDB_makeKernel (MyDB_ExprContextPtr context, shared_ptr <Result> temp, LhsSource lhs, RhsSource rhs) {
+	if (context == nullptr) {
+		return [temp, lhs, rhs] () -> MyDB_AttValPtr {
+			temp->set (Op :: apply ((Promoted) lhs.get (), (Promoted) rhs.get ()));
+			return temp;
+		};
+	}
+	shared_ptr <size_t> lastEpoch = make_shared <size_t> (MyDB_NO_EPOCH);
+	return [context, lastEpoch, temp, lhs, rhs] () -> MyDB_AttValPtr {
+		size_t now = context->epoch;
+		if (*lastEpoch != now) {
+			context->numEvals++;
+			temp->set (Op :: apply ((Promoted) lhs.get (), (Promoted) rhs.get ()));
+			*lastEpoch = now;
+		}
+		return temp;
+	};
+}
+
+// picks the source for the right input, then instantiates the kernel
+template <class Op, class Promoted, class RhsAtt, class Result, class LhsSource>
+inline func MyDB_bindRhs (MyDB_ExprContextPtr context, shared_ptr <Result> temp, LhsSource lhs, const func &rhs) {
+	if (const MyDB_AttRef *ref = rhs.target <MyDB_AttRef> ())
+		return MyDB_makeKernel <Op, Promoted> (context, temp, lhs, MyDB_AttSource <RhsAtt> (*ref));
+	if (const MyDB_Literal *lit = rhs.target <MyDB_Literal> ())
+		return MyDB_makeKernel <Op, Promoted> (context, temp, lhs, MyDB_ConstSource <RhsAtt> (*lit));
+	return MyDB_makeKernel <Op, Promoted> (context, temp, lhs, MyDB_FuncSource <RhsAtt> (rhs));
+}
+
+// builds a lambda computing op (lhs, rhs), where the inputs hold LhsAtt and RhsAtt values, and the
+// operation is done after promoting both to the type Promoted; the result is written into temp.  If
+// both inputs are literals, the operation is done right now, and the result is returned as a literal
+template <class Op, class Promoted, class LhsAtt, class RhsAtt, class Result>
+inline func MyDB_buildKernel (MyDB_ExprContextPtr context, shared_ptr <Result> temp, const func &lhs, const func &rhs) {
+	if (MyDB_isLiteral (lhs) && MyDB_isLiteral (rhs)) {
+		MyDB_Literal lit;
+		lit.val = MyDB_bindRhs <Op, Promoted, RhsAtt> (nullptr, temp, MyDB_ConstSource <LhsAtt> (*lhs.target <MyDB_Literal> ()), rhs) ();
+		return lit;
+	}
+	if (const MyDB_AttRef *ref = lhs.target <MyDB_AttRef> ())
+		return MyDB_bindRhs <Op, Promoted, RhsAtt> (context, temp, MyDB_AttSource <LhsAtt> (*ref), rhs);
+	if (const MyDB_Literal *lit = lhs.target <MyDB_Literal> ())
+		return MyDB_bindRhs <Op, Promoted, RhsAtt> (context, temp, MyDB_ConstSource <LhsAtt> (*lit), rhs);
+	return MyDB_bindRhs <Op, Promoted, RhsAtt> (context, temp, MyDB_FuncSource <LhsAtt> (lhs), rhs);
+}
+
+// the function object compiled for a chain of && (or ||) clauses.  The clauses are run in order,
+// stopping as soon as the result is known.  Every so often the clauses are re-ordered using the
+// observed pass rate and cost of each, so that cheap clauses that decide the result are run first
+struct MyDB_BoolChain {
+
+	struct State {
+
+		// the clauses, and the order in which to run them
+		vector <func> clauses;
+		vector <size_t> order;
+
+		// for each clause, the number of times it was run, the number of times it returned true,
+		// and the total number of operations it took
+		vector <double> numRuns;
+		vector <double> numTrue;
+		vector <double> cost;
+
+		// true if this is a chain of &&, false if a chain of ||
+		bool isAnd;
+
+		// countdown to the next re-ordering
+		size_t untilReorder;
+
+		MyDB_BoolAttValPtr result;
+		MyDB_ExprContextPtr context;
+		size_t lastEpoch;
+	};
+
+	shared_ptr <State> state;
+
+	MyDB_BoolChain (MyDB_ExprContextPtr context, bool isAnd, vector <func> &clauses);
+
+	MyDB_AttValPtr operator () () const;
+
+	// re-orders the clauses using the statistics collected so far
+	void reorder () const;
+};
+
+// the batch form of the same kernels: applies op across a vector of unboxed inputs
+template <class Op, class Promoted, class Lhs, class Rhs, class Out>
+inline void MyDB_applyKernel (const Lhs *lhs, const Rhs *rhs, Out *out, size_t num) {
+	for (size_t i = 0; i < num; i++)
+		out[i] = Op :: apply ((Promoted) lhs[i], (Promoted) rhs[i]);
+}
+
+// and with a constant right input, which is the common case for selection predicates
+template <class Op, class Promoted, class Lhs, class Rhs, class Out>
+inline void MyDB_applyKernelConst (const Lhs *lhs, const Rhs &rhs, Out *out, size_t num) {
+	Promoted right = (Promoted) rhs;
+	for (size_t i = 0; i < num; i++)
+		out[i] = Op :: apply ((Promoted) lhs[i], right);
+}
+
+#endif
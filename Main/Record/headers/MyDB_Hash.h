@@ -0,0 +1,84 @@
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdint.h>
+#include <string.h>
+
+// The hash functions used for join and group keys.  Every attribute value hashes through one of
+// these, and the hashes of a multi-attribute key are put together with MyDB_hashCombine, which
+// (unlike xor) depends on the order of the attributes, so that equal values in swapped columns do
+// not cancel out.  The mixing is done in the style of wyhash: a 64x64 -> 128 bit multiply, with
+// the two halves of the product folded together.  Values of different types that are equal when
+// compared (the int 5, the double 5.0, and the decimal 5.00) have the same hash.
+
+// the constants used by the mixer (from wyhash)
+#define MyDB_HASH_P0 0xa0761d6478bd642fULL
+#define MyDB_HASH_P1 0xe7037ed1a0b428dbULL
+#define MyDB_HASH_P2 0x8ebc6af09c88c6e3ULL
+
+// multiplies two 64-bit values, and folds the 128-bit product into 64 bits
+inline uint64_t MyDB_mum (uint64_t lhs, uint64_t rhs) {
+	unsigned __int128 res = (unsigned __int128) lhs * rhs;
+	return (uint64_t) res ^ (uint64_t) (res >> 64);
+}
+
+// hashes an integer
+inline size_t MyDB_hashInt (long long val) {
+	return MyDB_mum ((uint64_t) val ^ MyDB_HASH_P0, MyDB_HASH_P1);
+}
+
+// hashes a double; a double holding an integer hashes just like that integer
+inline size_t MyDB_hashDouble (double val) {
+	if (val >= -9.2e18 && val <= 9.2e18 && val == (double) (long long) val)
+		return MyDB_hashInt ((long long) val);
+	uint64_t bits;
+	memcpy (&bits, &val, sizeof (bits));
+	return MyDB_mum (bits ^ MyDB_HASH_P2, MyDB_HASH_P1);
+}
+
+// reads up to eight bytes as an integer
+inline uint64_t MyDB_readBytes (const char *data, size_t size) {
+	uint64_t res = 0;
+	memcpy (&res, data, size);
+	return res;
+}
+
+// hashes a run of bytes, sixteen at a time
+inline size_t MyDB_hashBytes (const char *data, size_t size) {
+	uint64_t seed = MyDB_HASH_P0 ^ size;
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16)
+		seed = MyDB_mum (MyDB_readBytes (data + i, 8) ^ MyDB_HASH_P1, MyDB_readBytes (data + i + 8, 8) ^ seed);
+	uint64_t a = 0, b = 0;
+	if (size - i > 8) {
+		a = MyDB_readBytes (data + i, 8);
+		b = MyDB_readBytes (data + i + 8, size - i - 8);
+	} else {
+		a = MyDB_readBytes (data + i, size - i);
+	}
+	return MyDB_mum (MyDB_HASH_P1 ^ size, MyDB_mum (a ^ MyDB_HASH_P1, b ^ seed));
+}
+
+// puts the hash of the next attribute of a key into the hash of the attributes before it; start with a seed of 0
+inline size_t MyDB_hashCombine (size_t seed, size_t hash) {
+	return MyDB_mum (seed ^ MyDB_HASH_P0, hash ^ MyDB_HASH_P2);
+}
+
+// the batch forms of the above, which hash a whole column of values at once
+inline void MyDB_hashInts (const int *in, size_t *out, size_t num) {
+	for (size_t i = 0; i < num; i++)
+		out[i] = MyDB_hashInt (in[i]);
+}
+
+inline void MyDB_hashDoubles (const double *in, size_t *out, size_t num) {
+	for (size_t i = 0; i < num; i++)
+		out[i] = MyDB_hashDouble (in[i]);
+}
+
+inline void MyDB_hashCombineAll (size_t *seeds, const size_t *hashes, size_t num) {
+	for (size_t i = 0; i < num; i++)
+		seeds[i] = MyDB_hashCombine (seeds[i], hashes[i]);
+}
+
+#endif
@@ -4,7 +4,9 @@
 
 #include <functional>
 #include "MyDB_AttVal.h"
+#include "MyDB_ExprKernels.h"
 #include "MyDB_Schema.h"
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,6 +20,21 @@ typedef shared_ptr <MyDB_Record> MyDB_RecordPtr;
 // a lambda function over the record... computes an attribute value
 typedef function <MyDB_AttValPtr ()> func;
 
+// the function built by buildRecordComparator (below) holds one of these.  It remembers the computation
+// that the records are compared on, so that the same comparison can be rebuilt over other records (by each
+// of the threads of a parallel sort, for example); given the function <bool ()>, target <MyDB_RecordLessThan> ()
+// gets at it
+struct MyDB_RecordLessThan {
+
+	func lessThan;
+	string computation;
+	bool descending;
+
+	bool operator () () const {
+		return lessThan ()->toBool ();
+	}
+};
+
 class MyDB_Record {
 
 public:
@@ -62,9 +79,27 @@ public:
 	// 	
 	void *fromBinary (void *startPos);
 
+	// returns the positions (in schema order) of the attributes of this record that are referred to by
+	// the given computations; names that are not in this record's schema (say, the attributes of the
+	// other record in a join) are skipped, so the same computations can be checked against each input
+	vector <size_t> getReferencedAtts (vector <string> &computations);
+
+	// narrows the record so that fromBinary only copies out and sets up the given attributes, skipping
+	// over the rest without looking at them; this is what a scan that needs a few columns of a wide
+	// table uses.  The other attributes of a narrowed record are not valid, so it can be used to run
+	// computations, but should not be written out.  An empty list widens the record back to all attributes
+	void narrowTo (vector <size_t> whichAtts);
+
 	// parse the contents of this record from the given string
 	void fromString (string fromMe);
 
+	// like the above, but parses the '|'-separated text in [begin, end) in place, without
+	// copying it out into strings first
+	void fromChars (const char *begin, const char *end);
+
+	// appends the record to the given string, in the same '|'-separated form that operator<< writes
+	void appendString (string &appendToMe);
+
 	// write the record to an output string
 	friend std::ostream& operator<<(std::ostream& os, const MyDB_Record printMe);
 	friend std::ostream& operator<<(std::ostream& os, const MyDB_RecordPtr printMe);
@@ -112,12 +147,21 @@ public:
 	// used by the method compileComputation above
 	friend function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, string computation);
 
+	// like the above, but if descending is true, the function returns true if the result from lhs is > the
+	// result from rhs, so that sorting with it puts the records in descending order
+	friend function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, string computation,
+		bool descending);
+
 	// access the schema
 	MyDB_SchemaPtr &getSchema ();
 
 	// access a particular attribute
 	MyDB_AttValPtr &getAtt (int whichAtt);
 
+	// the number of operations (arithmetic, comparisons, and boolean connectives) that have been run by
+	// all of the computations compiled over this record; useful for checking how much work a query does
+	size_t getNumEvals ();
+
 private:
 
 	// for fast reading from a page; the contents of the record are simply copied into this buffer
@@ -129,9 +173,12 @@ private:
 	// the amount of data in the record buffer
 	size_t recSize;
 
-	// helper function for the compilation
+	// helper function for the compilation; this checks whether the computation has already been compiled
 	pair <func, MyDB_AttTypePtr> compileHelper (char * &vals);
 
+	// helper function for the compilation; this does the actual parsing
+	pair <func, MyDB_AttTypePtr> parseComputation (char * &vals);
+
 	// helper function for the compilation
 	char *findsymbol (char val, char *input);
 	
@@ -156,6 +203,9 @@ private:
 	// true when the set of attributes don't match the attribute buffer
 	bool bufferOld;
 
+	// the attributes that fromBinary sets up, in order, if the record has been narrowed (empty otherwise)
+	vector <size_t> neededAtts;
+
 	// this is a subtype
 	friend class MyDB_INRecord;
 
@@ -163,6 +213,12 @@ private:
 	vector <MyDB_AttValPtr> values;	
 	vector <MyDB_AttValPtr> scratch;
 
+	// shared by all of the computations compiled over this record
+	MyDB_ExprContextPtr context;
+
+	// every computation compiled over this record, keyed by its text (minus whitespace)
+	map <string, pair <func, MyDB_AttTypePtr>> compiled;
+
 };
 
 #endif
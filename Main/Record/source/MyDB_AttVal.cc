@@ -5,12 +5,39 @@
 #include <iostream>
 #include "MyDB_AttVal.h"
 #include <string>
+#include <climits>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 using namespace std;
 
 MyDB_AttVal :: ~MyDB_AttVal () {}
 
+void MyDB_AttVal :: fromChars (const char *begin, const char *end) {
+	string temp (begin, end);
+	fromString (temp);
+}
+
+void MyDB_AttVal :: appendString (string &appendToMe) {
+	appendToMe += toString ();
+}
+
+// writes the digits of an integer onto the end of a string, padding with zeros to at least minDigits
+static void appendDigits (long long val, string &appendToMe, int minDigits = 1) {
+	char digits[24];
+	int pos = sizeof (digits);
+	unsigned long long mag = val < 0 ? 0ULL - (unsigned long long) val : (unsigned long long) val;
+	do {
+		digits[--pos] = '0' + (mag % 10);
+		mag /= 10;
+	} while (mag != 0 || (int) sizeof (digits) - pos < minDigits);
+	if (val < 0)
+		digits[--pos] = '-';
+	appendToMe.append (digits + pos, sizeof (digits) - pos);
+}
+
 int MyDB_IntAttVal :: toInt () {
 	void *dataPtr = getDataPointer ();
 	if (dataPtr == nullptr) 
@@ -51,7 +78,15 @@ void MyDB_BoolAttVal :: set (MyDB_AttValPtr fromMe) {
 }
 
 void MyDB_StringAttVal :: set (MyDB_AttValPtr fromMe) {
-	value = fromMe->toString ();
+
+	// if this is a string, just copy the bytes over (into the space we already have, if it is big enough)
+	MyDB_StringAttVal *fromString = dynamic_cast <MyDB_StringAttVal *> (fromMe.get ());
+	if (fromString != nullptr) {
+		MyDB_StringView view = fromString->getView ();
+		value.assign (view.data, view.size);
+	} else {
+		value = fromMe->toString ();
+	}
 	setNotBuffered ();
 }
 
@@ -65,20 +100,45 @@ void MyDB_IntAttVal :: fromString (string &fromMe) {
 	setNotBuffered ();
 }
 
+void MyDB_IntAttVal :: fromChars (const char *begin, const char *end) {
+
+	// the usual case is an optional sign followed by digits; anything else goes to stoi
+	const char *cur = begin;
+	bool negative = (cur != end && *cur == '-');
+	if (negative)
+		cur++;
+	long long val = 0;
+	const char *digits = cur;
+	for (; cur != end && *cur >= '0' && *cur <= '9' && cur - digits < 10; cur++)
+		val = val * 10 + (*cur - '0');
+
+	if (cur != end || cur == digits || val > INT_MAX) {
+		MyDB_AttVal :: fromChars (begin, end);
+		return;
+	}
+	value = (int) (negative ? -val : val);
+	setNotBuffered ();
+}
+
+void MyDB_IntAttVal :: appendString (string &appendToMe) {
+	appendDigits (getInt (), appendToMe);
+}
+
 size_t MyDB_IntAttVal :: hash () {
-	return std :: hash <int> () (toInt ());
+	return MyDB_hashInt (getInt ());
 }
 
 size_t MyDB_DoubleAttVal :: hash () {
-	return std :: hash <int> () (toDouble ());
+	return MyDB_hashDouble (getDouble ());
 }
 
 size_t MyDB_BoolAttVal :: hash () {
-	return std :: hash <int> () (toBool ());
+	return MyDB_hashInt (getBool ());
 }
 
 size_t MyDB_StringAttVal :: hash () {
-	return std :: hash <string> () (toString ());
+	MyDB_StringView view = getView ();
+	return MyDB_hashBytes (view.data, view.size);
 }
 
 bool MyDB_IntAttVal :: toBool () {
@@ -96,11 +156,6 @@ void MyDB_IntAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_t &
 	totSize += sizeof (int);
 }
 
-void MyDB_IntAttVal :: set (int val) {
-	value = val;
-	setNotBuffered ();
-}
-
 MyDB_IntAttVal :: MyDB_IntAttVal () {
 	value = 0;
 	setNotBuffered ();
@@ -126,6 +181,38 @@ void MyDB_DoubleAttVal :: fromString (string &fromMe) {
 	setNotBuffered ();
 }
 
+void MyDB_DoubleAttVal :: fromChars (const char *begin, const char *end) {
+
+	// strtod needs a null-terminated string, so copy short values into a local buffer
+	char temp[64];
+	size_t len = end - begin;
+	if (len == 0 || len >= sizeof (temp)) {
+		MyDB_AttVal :: fromChars (begin, end);
+		return;
+	}
+	memcpy (temp, begin, len);
+	temp[len] = 0;
+	char *parsedTo;
+	double val = strtod (temp, &parsedTo);
+	if (parsedTo == temp) {
+		MyDB_AttVal :: fromChars (begin, end);
+		return;
+	}
+	value = val;
+	setNotBuffered ();
+}
+
+void MyDB_DoubleAttVal :: appendString (string &appendToMe) {
+
+	// this is the same format that to_string uses, but printed into a local buffer
+	char temp[64];
+	int len = snprintf (temp, sizeof (temp), "%f", toDouble ());
+	if (len < 0 || len >= (int) sizeof (temp))
+		appendToMe += toString ();
+	else
+		appendToMe.append (temp, len);
+}
+
 double MyDB_DoubleAttVal :: toDouble () {
 	void *dataPtr = getDataPointer ();
 	if (dataPtr == nullptr) 
@@ -157,11 +244,6 @@ void MyDB_DoubleAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_
 	totSize += sizeof (double);
 }
 
-void MyDB_DoubleAttVal :: set (double val) {
-	value = val;
-	setNotBuffered ();
-}
-
 MyDB_DoubleAttVal :: MyDB_DoubleAttVal () {
 	value = 0;
 	setNotBuffered ();
@@ -182,6 +264,16 @@ void MyDB_StringAttVal :: fromString (string &fromMe) {
 	setNotBuffered ();
 }
 
+void MyDB_StringAttVal :: fromChars (const char *begin, const char *end) {
+	value.assign (begin, end - begin);
+	setNotBuffered ();
+}
+
+void MyDB_StringAttVal :: appendString (string &appendToMe) {
+	MyDB_StringView view = getView ();
+	appendToMe.append (view.data, view.size);
+}
+
 double MyDB_StringAttVal :: toDouble () {
         cout << "Oops!  Can't convert int to double";
         exit (1);
@@ -207,14 +299,21 @@ bool MyDB_StringAttVal :: toBool () {
 
 void MyDB_StringAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) {
 
-	string value = toString ();
+	MyDB_StringView view = getView ();
 
-	extendBuffer (buffer, allocatedSize, totSize, strlen (value.c_str ()) + 1 + sizeof (short));
+	char *oldBuffer = buffer;
+	size_t oldSize = allocatedSize;
+	extendBuffer (buffer, allocatedSize, totSize, view.size + 1 + sizeof (short));
 
-	*((short *) (buffer + totSize)) = (short) (sizeof (short) + strlen (value.c_str ()) + 1);
+	// if the string lives in the buffer we are writing to, and that buffer just moved, follow it
+	if (buffer != oldBuffer && view.data >= oldBuffer && view.data < oldBuffer + oldSize)
+		view.data = buffer + (view.data - oldBuffer);
+
+	*((short *) (buffer + totSize)) = (short) (sizeof (short) + view.size + 1);
 	totSize += sizeof (short);
-	memcpy (buffer + totSize, value.c_str (), strlen (value.c_str ()) + 1);
-	totSize += strlen (value.c_str ()) + 1;
+	memmove (buffer + totSize, view.data, view.size);
+	buffer[totSize + view.size] = 0;
+	totSize += view.size + 1;
 }
 
 void MyDB_StringAttVal :: set (string val) {
@@ -292,17 +391,244 @@ void MyDB_BoolAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_t
 	totSize += sizeof (char);
 }
 
-void MyDB_BoolAttVal :: set (bool val) {
-	value = val;
-	setNotBuffered ();
-}
-
 MyDB_AttValPtr MyDB_IntAttVal :: getCopy () {
 	MyDB_IntAttValPtr retVal = make_shared <MyDB_IntAttVal> ();
 	retVal->set (toInt ());
 	return retVal;	
 }
 
+// the conversions between a calendar date and a day number are from H. Hinnant's "chrono-Compatible
+// Low-Level Date Algorithms"; they work over the whole proleptic Gregorian calendar
+int MyDB_DateAttVal :: parse (const string &fromMe) {
+
+	int y, m, d;
+	char extra;
+	if (sscanf (fromMe.c_str (), "%d-%d-%d%c", &y, &m, &d, &extra) != 3 || m < 1 || m > 12 || d < 1 || d > 31) {
+		cout << "Oops!  Bad string for date: " << fromMe << "\n";
+		exit (1);
+	}
+
+	y -= m <= 2;
+	int era = (y >= 0 ? y : y - 399) / 400;
+	int yoe = y - era * 400;
+	int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+
+string MyDB_DateAttVal :: format (int dayNum) {
+	string res;
+	format (dayNum, res);
+	return res;
+}
+
+void MyDB_DateAttVal :: format (int dayNum, string &appendToMe) {
+
+	// done in 64 bits, so that any int (including the INT_MAX used as a sentinel) can be printed
+	long long z = (long long) dayNum + 719468;
+	long long era = (z >= 0 ? z : z - 146096) / 146097;
+	long long doe = z - era * 146097;
+	long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	long long mp = (5 * doy + 2) / 153;
+	long long d = doy - (153 * mp + 2) / 5 + 1;
+	long long m = mp + (mp < 10 ? 3 : -9);
+	long long y = yoe + era * 400 + (m <= 2);
+
+	// this matches the "%04lld-%02lld-%02lld" that printf would give
+	appendDigits (y, appendToMe, y < 0 ? 3 : 4);
+	appendToMe += '-';
+	appendDigits (m, appendToMe, 2);
+	appendToMe += '-';
+	appendDigits (d, appendToMe, 2);
+}
+
+string MyDB_DateAttVal :: toString () {
+	return format (getInt ());
+}
+
+void MyDB_DateAttVal :: appendString (string &appendToMe) {
+	format (getInt (), appendToMe);
+}
+
+void MyDB_DateAttVal :: fromString (string &fromMe) {
+	set (parse (fromMe));
+}
+
+void MyDB_DateAttVal :: fromChars (const char *begin, const char *end) {
+	// skip the integer parse that would be inherited, since a date in text form is never a plain int
+	MyDB_AttVal :: fromChars (begin, end);
+}
+
+void MyDB_DateAttVal :: set (MyDB_AttValPtr fromMe) {
+
+	// dates and ints are both day numbers; anything else must be a date in text form
+	MyDB_IntAttVal *fromInt = dynamic_cast <MyDB_IntAttVal *> (fromMe.get ());
+	if (fromInt != nullptr) {
+		set (fromInt->getInt ());
+	} else {
+		set (parse (fromMe->toString ()));
+	}
+}
+
+MyDB_AttValPtr MyDB_DateAttVal :: getCopy () {
+	MyDB_DateAttValPtr retVal = make_shared <MyDB_DateAttVal> ();
+	retVal->set (getInt ());
+	return retVal;
+}
+
+MyDB_DecimalAttVal :: MyDB_DecimalAttVal (int scaleIn, bool wideIn) {
+	if (scaleIn < 0 || scaleIn > MyDB_MAX_NARROW_DIGITS) {
+		cout << "Oops!  Bad scale for decimal: " << scaleIn << "\n";
+		exit (1);
+	}
+	value = 0;
+	scale = scaleIn;
+	wide = wideIn;
+	setNotBuffered ();
+}
+
+MyDB_DecimalAttVal :: ~MyDB_DecimalAttVal () {}
+
+void MyDB_decimalOverflow () {
+	cout << "Oops!  Decimal result is too large to hold.\n";
+	exit (1);
+}
+
+MyDB_Decimal MyDB_DecimalAttVal :: narrow (MyDB_WideInt val) {
+	int newScale = scale;
+	while (newScale > 0 && (val > MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS) || val < -MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS))) {
+		val = MyDB_rescale (val, newScale, newScale - 1);
+		newScale--;
+	}
+	if (val > MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS) || val < -MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS)) {
+		cout << "Oops!  Decimal too large for 64 bits: " << toString () << "\n";
+		exit (1);
+	}
+	return MyDB_Decimal ((long long) val, newScale);
+}
+
+int MyDB_DecimalAttVal :: toInt () {
+	return (int) (getScaled () / MyDB_powerOfTen (scale));
+}
+
+double MyDB_DecimalAttVal :: toDouble () {
+	return (double) getScaled () / MyDB_powerOfTen (scale);
+}
+
+string MyDB_DecimalAttVal :: toString () {
+
+	// write out the digits, least significant first
+	MyDB_WideInt val = getScaled ();
+	bool negative = val < 0;
+	string digits;
+	do {
+		int digit = (int) (val % 10);
+		digits += (char) ('0' + (digit < 0 ? -digit : digit));
+		val /= 10;
+	} while (val != 0 || (int) digits.size () <= scale);
+
+	string res = negative ? "-" : "";
+	for (int i = digits.size () - 1; i >= 0; i--) {
+		res += digits[i];
+		if (i == scale && scale > 0)
+			res += '.';
+	}
+	return res;
+}
+
+bool MyDB_DecimalAttVal :: toBool () {
+	cout << "Oops!  Can't convert decimal to bool";
+	exit (1);
+}
+
+void MyDB_DecimalAttVal :: fromInt (int fromMe) {
+	value = (MyDB_WideInt) fromMe * MyDB_powerOfTen (scale);
+	setNotBuffered ();
+}
+
+void MyDB_DecimalAttVal :: fromString (string &fromMe) {
+
+	// parse [-]digits[.digits], keeping one digit more than we need so that we can round
+	const char *cur = fromMe.c_str ();
+	while (isspace (*cur))
+		cur++;
+	bool negative = (*cur == '-');
+	if (*cur == '-' || *cur == '+')
+		cur++;
+
+	MyDB_WideInt val = 0;
+	int fracDigits = -1, numDigits = 0;
+	for (; *cur != 0; cur++) {
+		if (*cur == '.' && fracDigits == -1) {
+			fracDigits = 0;
+		} else if (*cur >= '0' && *cur <= '9') {
+			if (fracDigits > scale)
+				continue;
+			val = val * 10 + (*cur - '0');
+			numDigits++;
+			if (fracDigits != -1)
+				fracDigits++;
+		} else if (!isspace (*cur)) {
+			break;
+		}
+	}
+	if (*cur != 0 || numDigits == 0) {
+		cout << "Oops!  Bad string for decimal: " << fromMe << "\n";
+		exit (1);
+	}
+
+	value = MyDB_rescale (negative ? -val : val, fracDigits == -1 ? 0 : fracDigits, scale);
+	setNotBuffered ();
+}
+
+void MyDB_DecimalAttVal :: set (MyDB_AttValPtr fromMe) {
+
+	// a decimal is copied exactly, an int is an integer, and anything else goes through a double
+	if (MyDB_DecimalAttVal *fromDecimal = dynamic_cast <MyDB_DecimalAttVal *> (fromMe.get ())) {
+		value = MyDB_rescale (fromDecimal->getScaled (), fromDecimal->scale, scale);
+	} else if (MyDB_IntAttVal *fromInt = dynamic_cast <MyDB_IntAttVal *> (fromMe.get ())) {
+		value = (MyDB_WideInt) fromInt->getInt () * MyDB_powerOfTen (scale);
+	} else {
+		double val = fromMe->toDouble () * MyDB_powerOfTen (scale);
+		value = (MyDB_WideInt) (val < 0 ? val - 0.5 : val + 0.5);
+	}
+	setNotBuffered ();
+}
+
+size_t MyDB_DecimalAttVal :: hash () {
+
+	// a whole number hashes like the same int, so that it matches ints and doubles in joins and groupings
+	MyDB_WideInt val = getScaled ();
+	MyDB_WideInt whole = val / MyDB_powerOfTen (scale);
+	if (val % MyDB_powerOfTen (scale) == 0 && whole >= LLONG_MIN && whole <= LLONG_MAX)
+		return MyDB_hashInt ((long long) whole);
+	return MyDB_hashDouble (toDouble ());
+}
+
+MyDB_AttValPtr MyDB_DecimalAttVal :: getCopy () {
+	MyDB_DecimalAttValPtr retVal = make_shared <MyDB_DecimalAttVal> (scale, wide);
+	retVal->value = getScaled ();
+	return retVal;
+}
+
+void MyDB_DecimalAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) {
+
+	MyDB_WideInt val = getScaled ();
+	size_t size = wide ? sizeof (MyDB_WideInt) : sizeof (long long);
+
+	extendBuffer (buffer, allocatedSize, totSize, size + sizeof (short));
+
+	*((short *) (buffer + totSize)) = (short) (sizeof (short) + size);
+	totSize += sizeof (short);
+	if (wide) {
+		memcpy (buffer + totSize, &val, size);
+	} else {
+		*((long long *) (buffer + totSize)) = (long long) val;
+	}
+	totSize += size;
+}
+
 MyDB_AttValPtr MyDB_DoubleAttVal :: getCopy () {
 	MyDB_DoubleAttValPtr retVal = make_shared <MyDB_DoubleAttVal> ();
 	retVal->set (toDouble ());
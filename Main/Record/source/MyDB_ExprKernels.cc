@@ -0,0 +1,86 @@
+
+#ifndef EXPR_KERNELS_C
+#define EXPR_KERNELS_C
+
+#include "MyDB_ExprKernels.h"
+#include <algorithm>
+
+using namespace std;
+
+// how many times a chain of clauses is run between re-orderings
+#define REORDER_INTERVAL 1024
+
+MyDB_BoolChain :: MyDB_BoolChain (MyDB_ExprContextPtr context, bool isAnd, vector <func> &clauses) {
+	state = make_shared <State> ();
+	state->clauses = clauses;
+	for (size_t i = 0; i < clauses.size (); i++) {
+		state->order.push_back (i);
+		state->numRuns.push_back (0);
+		state->numTrue.push_back (0);
+		state->cost.push_back (0);
+	}
+	state->isAnd = isAnd;
+	state->untilReorder = REORDER_INTERVAL;
+	state->result = make_shared <MyDB_BoolAttVal> ();
+	state->context = context;
+	state->lastEpoch = MyDB_NO_EPOCH;
+}
+
+MyDB_AttValPtr MyDB_BoolChain :: operator () () const {
+
+	State &me = *state;
+	MyDB_ExprContext &context = *me.context;
+
+	// see if we already know the answer for this evaluation
+	size_t now = context.epoch;
+	if (me.lastEpoch == now)
+		return me.result;
+	context.numEvals++;
+
+	// run the clauses until one of them decides the result
+	bool res = me.isAnd;
+	for (size_t i : me.order) {
+		size_t before = context.numEvals;
+		bool val = MyDB_Unboxed <MyDB_BoolAttVal> :: load (me.clauses[i] ().get ());
+		me.cost[i] += context.numEvals - before;
+		me.numRuns[i]++;
+		if (val) 
+			me.numTrue[i]++;
+		if (val != me.isAnd) {
+			res = val;
+			break;
+		}
+	}
+
+	if (--me.untilReorder == 0)
+		reorder ();
+
+	me.result->set (res);
+	me.lastEpoch = now;
+	return me.result;
+}
+
+void MyDB_BoolChain :: reorder () const {
+
+	State &me = *state;
+
+	// the expected cost of a clause divided by the chance that it decides the result... running the
+	// clauses in increasing order of this is optimal for independent clauses.  The +1s keep clauses
+	// that have rarely been run from being pinned to the end (or front) of the list
+	vector <double> rank (me.clauses.size ());
+	for (size_t i = 0; i < me.clauses.size (); i++) {
+		double passRate = (me.numTrue[i] + 1) / (me.numRuns[i] + 2);
+		double decideRate = me.isAnd ? 1 - passRate : passRate;
+		rank[i] = ((me.cost[i] + 1) / (me.numRuns[i] + 1)) / decideRate;
+
+		// decay the statistics, so we can adapt if the data changes
+		me.numRuns[i] /= 2;
+		me.numTrue[i] /= 2;
+		me.cost[i] /= 2;
+	}
+
+	stable_sort (me.order.begin (), me.order.end (), [&rank] (size_t lhs, size_t rhs) {return rank[lhs] < rank[rhs];});
+	me.untilReorder = REORDER_INTERVAL;
+}
+
+#endif
@@ -4,7 +4,10 @@
 
 #include "MyDB_Record.h"
 #include "MyDB_Schema.h"
+#include <algorithm>
+#include <ctype.h>
 #include <iostream>
+#include <math.h>
 #include <string.h>
 
 using namespace std;
@@ -19,7 +22,17 @@ char *MyDB_Record :: findsymbol (char val, char *input) {
 
 func MyDB_Record :: compileComputation (string compileMe) {
 	char *str = (char *) compileMe.c_str ();
-	return compileHelper (str).first;
+	func res = compileHelper (str).first;
+
+	// a literal or a bare attribute remembers nothing; anything else starts a new evaluation on each call,
+	// so that no result remembered from an earlier call (made over other contents) is used
+	if (MyDB_isLiteral (res) || res.target <MyDB_AttRef> () != nullptr)
+		return res;
+	MyDB_ExprContextPtr context = this->context;
+	return [context, res] () -> MyDB_AttValPtr {
+		context->epoch++;
+		return res ();
+	};
 }
 
 MyDB_AttTypePtr MyDB_Record :: getType (string compileMe) {
@@ -27,7 +40,34 @@ MyDB_AttTypePtr MyDB_Record :: getType (string compileMe) {
 	return compileHelper (str).second;
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
+pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper (char * &vals) {
+
+	// compile the computation
+	char *start = vals;
+	pair <func, MyDB_AttTypePtr> res = parseComputation (vals);
+
+	// get its text, without any whitespace (except within a literal or an attribute name)
+	string key;
+	bool inBrackets = false;
+	for (char *cur = start; cur != vals; cur++) {
+		if (*cur == '[')
+			inBrackets = true;
+		else if (*cur == ']')
+			inBrackets = false;
+		if (inBrackets || !isspace (*cur))
+			key += *cur;
+	}
+
+	// if this same computation has already been compiled over this record, use that one instead, so that
+	// the work is shared (each compiled computation remembers its result for the rest of an evaluation)
+	auto found = compiled.find (key);
+	if (found != compiled.end ())
+		return found->second;
+	compiled[key] = res;
+	return res;
+}
+
+pair <func, MyDB_AttTypePtr> MyDB_Record :: parseComputation (char * &vals) {
 	
 	// search for one of the infix symbols
 	while (true) {
@@ -330,7 +370,9 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			temp->set (val);
 
 			// returns a lambda that computes the result
-			return make_pair ([temp] {return temp;}, make_shared <MyDB_IntAttType> ());
+			MyDB_Literal lit;
+			lit.val = temp;
+			return make_pair (lit, make_shared <MyDB_IntAttType> ());
 
 		} else if (strncmp (vals, "double", 6) == 0) {
 
@@ -344,7 +386,9 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			temp->set (val);
 
 			// returns a lambda that computes the result
-			return make_pair ([temp] {return temp;}, make_shared <MyDB_DoubleAttType> ());
+			MyDB_Literal lit;
+			lit.val = temp;
+			return make_pair (lit, make_shared <MyDB_DoubleAttType> ());
 
 		} else if (strncmp (vals, "bool", 4) == 0) {
 
@@ -361,7 +405,9 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			temp->set (val);
 
 			// returns a lambda that computes the result
-			return make_pair ([temp] {return temp;}, make_shared <MyDB_BoolAttType> ());
+			MyDB_Literal lit;
+			lit.val = temp;
+			return make_pair (lit, make_shared <MyDB_BoolAttType> ());
 
 		} else if (strncmp (vals, "string", 6) == 0) {
 
@@ -387,7 +433,29 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			temp->set (name);
 
 			// returns a lambda that computes the result
-			return make_pair ([temp] {return temp;}, make_shared <MyDB_StringAttType> ());
+			MyDB_Literal lit;
+			lit.val = temp;
+			return make_pair (lit, make_shared <MyDB_StringAttType> ());
+
+		} else if (strncmp (vals, "date", 4) == 0) {
+
+			vals = findsymbol ('[', vals);
+
+			// find the right bracket
+			int cnt = 0;
+			for (; vals[cnt] != ']'; cnt++);
+			string text (vals, cnt);
+			vals = findsymbol (']', vals);
+
+			// remember this value
+			MyDB_DateAttValPtr temp = make_shared <MyDB_DateAttVal> ();
+			scratch.push_back (temp);
+			temp->fromString (text);
+
+			// returns a lambda that computes the result
+			MyDB_Literal lit;
+			lit.val = temp;
+			return make_pair (lit, make_shared <MyDB_DateAttType> ());
 			
 		} else {
 			vals++;
@@ -399,348 +467,361 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: fromData (string attName) {
 
 	// just return a particular attribute
 	auto whichAtt = mySchema->getAttByName (attName);
-	return make_pair ([this, whichAtt] {return values[whichAtt.first];}, whichAtt.second);		
+	MyDB_AttRef ref;
+	ref.atts = &values;
+	ref.which = whichAtt.first;
+	return make_pair (ref, whichAtt.second);		
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: plus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
-
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () + rhs.first ()->toInt ()); return temp;},
-			make_shared <MyDB_IntAttType> ());
-
-	// otherwise, if both sides can be cast upwards to be doubles, then do so
-	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () + rhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_DoubleAttType> ());
+// builds a kernel for an operation done over doubles, where the left input holds LhsAtt values, and the right
+// input may be an int, a decimal, or a double
+template <class Op, class LhsAtt, class Result>
+static func buildDoubleRhs (MyDB_ExprContextPtr context, shared_ptr <Result> temp, pair <func, MyDB_AttTypePtr> &lhs, 
+	pair <func, MyDB_AttTypePtr> &rhs) {
+	if (rhs.second->promotableToInt ())
+		return MyDB_buildKernel <Op, double, LhsAtt, MyDB_IntAttVal> (context, temp, lhs.first, rhs.first);
+	else if (rhs.second->isDecimal ())
+		return MyDB_buildKernel <Op, double, LhsAtt, MyDB_DecimalAttVal> (context, temp, lhs.first, rhs.first);
+	else
+		return MyDB_buildKernel <Op, double, LhsAtt, MyDB_DoubleAttVal> (context, temp, lhs.first, rhs.first);
+}
 
-	// otherwise, if both sides can be cast upwards to be strings, then do so
-	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_StringAttValPtr temp = make_shared <MyDB_StringAttVal> ();
-		scratch.push_back (temp);
+// builds a kernel for an operation done over doubles, where each input may be an int, a decimal, or a double
+template <class Op, class Result>
+static func buildDoubleKernel (MyDB_ExprContextPtr context, shared_ptr <Result> temp, pair <func, MyDB_AttTypePtr> &lhs, 
+	pair <func, MyDB_AttTypePtr> &rhs) {
+	if (lhs.second->promotableToInt ())
+		return buildDoubleRhs <Op, MyDB_IntAttVal> (context, temp, lhs, rhs);
+	else if (lhs.second->isDecimal ())
+		return buildDoubleRhs <Op, MyDB_DecimalAttVal> (context, temp, lhs, rhs);
+	else
+		return buildDoubleRhs <Op, MyDB_DoubleAttVal> (context, temp, lhs, rhs);
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () + rhs.first ()->toString ()); return temp;},
-			make_shared <MyDB_StringAttType> ());
+// the number of digits after the decimal point in a decimal (an int has none)
+static int scaleOf (MyDB_AttTypePtr type) {
+	return type->isDecimal () ? static_pointer_cast <MyDB_DecimalAttType> (type)->getScale () : 0;
+}
 
-	} else {
-		cout << "This is bad... cannot do anything with the plus.\n";
-		exit (1);
-	}
+// true if the two inputs can be operated on as decimals: at least one is a decimal, and the other is a decimal or an int
+static bool areDecimals (MyDB_AttTypePtr lhs, MyDB_AttTypePtr rhs) {
+	return (lhs->isDecimal () || rhs->isDecimal ()) && (lhs->isDecimal () || lhs->promotableToInt ()) && 
+		(rhs->isDecimal () || rhs->promotableToInt ());
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: minus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+// if decimal is a decimal and other is a double literal (such as 0.05), replaces other with the same value as a decimal, 
+// so that the operation is exact; the literal gets as few digits after the decimal point as will hold it exactly
+static void decimalFromLiteral (vector <MyDB_AttValPtr> &scratch, pair <func, MyDB_AttTypePtr> &decimal, 
+	pair <func, MyDB_AttTypePtr> &other) {
 
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
+	if (!decimal.second->isDecimal () || other.second->isDecimal () || other.second->promotableToInt () || 
+		!other.second->promotableToDouble () || !MyDB_isLiteral (other.first))
+		return;
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () - rhs.first ()->toInt ()); return temp;},
-			make_shared <MyDB_IntAttType> ());
+	double val = other.first ()->toDouble ();
+	if (val >= MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS - MyDB_DIVIDE_SCALE) || val <= -MyDB_powerOfTen (MyDB_MAX_NARROW_DIGITS - MyDB_DIVIDE_SCALE))
+		return;
 
-	// otherwise, if both sides can be cast upwards to be doubles, then do so
-	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
+	int scale = 0;
+	while (scale < MyDB_DIVIDE_SCALE && llround (val * MyDB_powerOfTen (scale)) / (double) MyDB_powerOfTen (scale) != val)
+		scale++;
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () - rhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_DoubleAttType> ());
-	
-	} else {
-		cout << "This is bad... cannot do anything with the minus.\n";
-		exit (1);
-	}
-}
+	MyDB_DecimalAttValPtr temp = make_shared <MyDB_DecimalAttVal> (scale, false);
+	scratch.push_back (temp);
+	temp->set (other.first ());
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: unaryMinus (pair <func, MyDB_AttTypePtr> lhs) {
+	MyDB_Literal lit;
+	lit.val = temp;
+	other = make_pair (lit, make_shared <MyDB_DecimalAttType> (MyDB_MAX_NARROW_DIGITS, scale));
+}
 
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
+// the number of digits after the decimal point in the result of an operation over decimals
+template <class Op> static int decimalScale (int lhs, int rhs) {
+	return max (lhs, rhs);
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs] {temp->set (-lhs.first ()->toInt ()); return temp;},
-			make_shared <MyDB_IntAttType> ());
+template <> int decimalScale <MyDB_TimesOp> (int lhs, int rhs) {
+	return min (lhs + rhs, MyDB_MAX_NARROW_DIGITS);
+}
 
-	// otherwise, if both sides can be cast upwards to be doubles, then do so
-	} else if (lhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
+template <> int decimalScale <MyDB_DivideOp> (int lhs, int rhs) {
+	return max (max (lhs, rhs), MyDB_DIVIDE_SCALE);
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs] {temp->set (-lhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_DoubleAttType> ());
-	
-	} else {
-		cout << "This is bad... cannot do anything with the unary minus.\n";
-		exit (1);
-	}
+// builds a kernel for an operation done over decimals, where each input may be an int or a decimal
+template <class Op, class Result>
+static func buildDecimalKernel (MyDB_ExprContextPtr context, shared_ptr <Result> temp, pair <func, MyDB_AttTypePtr> &lhs, 
+	pair <func, MyDB_AttTypePtr> &rhs) {
+	if (lhs.second->isDecimal () && rhs.second->isDecimal ())
+		return MyDB_buildKernel <Op, MyDB_Decimal, MyDB_DecimalAttVal, MyDB_DecimalAttVal> (context, temp, lhs.first, rhs.first);
+	else if (lhs.second->isDecimal ())
+		return MyDB_buildKernel <Op, MyDB_Decimal, MyDB_DecimalAttVal, MyDB_IntAttVal> (context, temp, lhs.first, rhs.first);
+	else
+		return MyDB_buildKernel <Op, MyDB_Decimal, MyDB_IntAttVal, MyDB_DecimalAttVal> (context, temp, lhs.first, rhs.first);
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: times (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+// builds a kernel for an arithmetic operation over ints, decimals or doubles
+template <class Op>
+static pair <func, MyDB_AttTypePtr> buildArithmetic (MyDB_ExprContextPtr context, vector <MyDB_AttValPtr> &scratch, 
+	pair <func, MyDB_AttTypePtr> &lhs, pair <func, MyDB_AttTypePtr> &rhs, string opName) {
+
+	decimalFromLiteral (scratch, lhs, rhs);
+	decimalFromLiteral (scratch, rhs, lhs);
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
 		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
 		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () * rhs.first ()->toInt ()); return temp;},
+		return make_pair (MyDB_buildKernel <Op, int, MyDB_IntAttVal, MyDB_IntAttVal> (context, temp, lhs.first, rhs.first), 
 			make_shared <MyDB_IntAttType> ());
 
+	// if both are decimals (or one is a decimal, and the other an int) then the operation is done exactly
+	} else if (areDecimals (lhs.second, rhs.second)) {
+		int scale = decimalScale <Op> (scaleOf (lhs.second), scaleOf (rhs.second));
+		MyDB_DecimalAttValPtr temp = make_shared <MyDB_DecimalAttVal> (scale, false);
+		scratch.push_back (temp);
+		return make_pair (buildDecimalKernel <Op> (context, temp, lhs, rhs), 
+			make_shared <MyDB_DecimalAttType> (MyDB_MAX_NARROW_DIGITS, scale));
+
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
 		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
 		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () * rhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_DoubleAttType> ());
+		return make_pair (buildDoubleKernel <Op> (context, temp, lhs, rhs), make_shared <MyDB_DoubleAttType> ());
 
 	} else {
-		cout << "This is bad... cannot do anything with the times.\n";
+		cout << "This is bad... cannot do anything with the " << opName << ".\n";
 		exit (1);
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: divide (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
-
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
+// true if the type is string (rather than something that can be made into one)
+static bool isString (MyDB_AttTypePtr type) {
+	return type->promotableToString () && !type->promotableToDouble () && !type->isBool ();
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () / rhs.first ()->toInt ()); return temp;},
-			make_shared <MyDB_IntAttType> ());
+// if date is a date and other is a string literal (such as '1995-03-15'), replaces other with the date it holds
+static void dateFromLiteral (vector <MyDB_AttValPtr> &scratch, pair <func, MyDB_AttTypePtr> &date, 
+	pair <func, MyDB_AttTypePtr> &other) {
 
-	// otherwise, if both sides can be cast upwards to be doubles, then do so
-	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
+	if (!date.second->isDate () || !isString (other.second) || !MyDB_isLiteral (other.first))
+		return;
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () / rhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_DoubleAttType> ());
+	MyDB_DateAttValPtr temp = make_shared <MyDB_DateAttVal> ();
+	scratch.push_back (temp);
+	temp->set (other.first ());
 
-	} else {
-		cout << "This is bad... cannot do anything with the divide.\n";
-		exit (1);
-	}
+	MyDB_Literal lit;
+	lit.val = temp;
+	other = make_pair (lit, make_shared <MyDB_DateAttType> ());
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: gt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+// builds a kernel for a comparison
+template <class Op>
+static pair <func, MyDB_AttTypePtr> buildComparison (MyDB_ExprContextPtr context, vector <MyDB_AttValPtr> &scratch, 
+	pair <func, MyDB_AttTypePtr> &lhs, pair <func, MyDB_AttTypePtr> &rhs) {
+
+	MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+	scratch.push_back (temp);
+
+	// a date compared with a string literal is compared as a date, so the comparison is done over ints
+	dateFromLiteral (scratch, lhs, rhs);
+	dateFromLiteral (scratch, rhs, lhs);
+	decimalFromLiteral (scratch, lhs, rhs);
+	decimalFromLiteral (scratch, rhs, lhs);
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () > rhs.first ()->toInt ()); return temp;},
+		return make_pair (MyDB_buildKernel <Op, int, MyDB_IntAttVal, MyDB_IntAttVal> (context, temp, lhs.first, rhs.first), 
 			make_shared <MyDB_BoolAttType> ());
 
+	// decimals are compared exactly
+	} else if (areDecimals (lhs.second, rhs.second)) {
+		return make_pair (buildDecimalKernel <Op> (context, temp, lhs, rhs), make_shared <MyDB_BoolAttType> ());
+
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+		return make_pair (buildDoubleKernel <Op> (context, temp, lhs, rhs), make_shared <MyDB_BoolAttType> ());
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () > rhs.first ()->toDouble ()); return temp;},
+	// booleans can be compared with one another
+	} else if (lhs.second->isBool () && rhs.second->isBool ()) {
+		return make_pair (MyDB_buildKernel <Op, bool, MyDB_BoolAttVal, MyDB_BoolAttVal> (context, temp, lhs.first, rhs.first), 
+			make_shared <MyDB_BoolAttType> ());
+
+	// two strings are compared in place
+	} else if (isString (lhs.second) && isString (rhs.second)) {
+		return make_pair (MyDB_buildKernel <Op, MyDB_StringView, MyDB_StringAttVal, MyDB_StringAttVal> (context, temp, lhs.first, rhs.first), 
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be strings, then do so
 	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () > rhs.first ()->toString ()); return temp;},
+		return make_pair (MyDB_buildKernel <Op, string, MyDB_AttVal, MyDB_AttVal> (context, temp, lhs.first, rhs.first), 
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
-		cout << "This is bad... cannot do anything with the >.\n";
+		cout << "This is bad... cannot do anything with the comparison.\n";
 		exit (1);
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: lt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
-
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () < rhs.first ()->toInt ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
-
-	// otherwise, if both sides can be cast upwards to be doubles, then do so
-	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+pair <func, MyDB_AttTypePtr> MyDB_Record :: plus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () < rhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+	// if both sides are numbers, then add them
+	if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
+		return buildArithmetic <MyDB_PlusOp> (context, scratch, lhs, rhs, "plus");
 
-	// otherwise, if both sides can be cast upwards to be strings, then do so
+	// otherwise, if both sides can be cast upwards to be strings, then concatenate them
 	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+		MyDB_StringAttValPtr temp = make_shared <MyDB_StringAttVal> ();
 		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () < rhs.first ()->toString ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+		return make_pair (MyDB_buildKernel <MyDB_PlusOp, string, MyDB_AttVal, MyDB_AttVal> (context, temp, lhs.first, rhs.first),
+			make_shared <MyDB_StringAttType> ());
 
 	} else {
-		cout << "This is bad... cannot do anything with the >.\n";
+		cout << "This is bad... cannot do anything with the plus.\n";
 		exit (1);
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: eq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <func, MyDB_AttTypePtr> MyDB_Record :: minus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildArithmetic <MyDB_MinusOp> (context, scratch, lhs, rhs, "minus");
+}
 
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+// if the input to a unary operation is a literal, run the operation now, and return the result as a literal
+static pair <func, MyDB_AttTypePtr> foldUnary (pair <func, MyDB_AttTypePtr> res, pair <func, MyDB_AttTypePtr> &input) {
+	if (MyDB_isLiteral (input.first)) {
+		MyDB_Literal lit;
+		lit.val = res.first ();
+		res.first = lit;
+	}
+	return res;
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () == rhs.first ()->toInt ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+pair <func, MyDB_AttTypePtr> MyDB_Record :: unaryMinus (pair <func, MyDB_AttTypePtr> lhs) {
 
-	// otherwise, if both sides can be cast upwards to be doubles, then do so
-	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+	MyDB_ExprContextPtr context = this->context;
+
+	// if both sides can be cast upwards to be ints, then do so
+	if (lhs.second->promotableToInt ()) {
+		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
 		scratch.push_back (temp);
+		MyDB_FuncSource <MyDB_IntAttVal> in (lhs.first);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () == rhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+		return foldUnary (make_pair ([temp, in, context] {context->numEvals++; temp->set (-in.get ()); return temp;},
+			make_shared <MyDB_IntAttType> ()), lhs);
 
-	} else if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+	} else if (lhs.second->isDecimal ()) {
+		int scale = scaleOf (lhs.second);
+		MyDB_DecimalAttValPtr temp = make_shared <MyDB_DecimalAttVal> (scale, false);
 		scratch.push_back (temp);
+		MyDB_FuncSource <MyDB_DecimalAttVal> in (lhs.first);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () == rhs.first ()->toBool ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+		return foldUnary (make_pair ([temp, in, context] {context->numEvals++; temp->set (-in.get ()); return temp;},
+			make_shared <MyDB_DecimalAttType> (MyDB_MAX_NARROW_DIGITS, scale)), lhs);
 
-	// otherwise, if both sides can be cast upwards to be strings, then do so
-	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+	// otherwise, if both sides can be cast upwards to be doubles, then do so
+	} else if (lhs.second->promotableToDouble ()) {
+		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
 		scratch.push_back (temp);
+		MyDB_FuncSource <MyDB_DoubleAttVal> in (lhs.first);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () == rhs.first ()->toString ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
-
+		return foldUnary (make_pair ([temp, in, context] {context->numEvals++; temp->set (-in.get ()); return temp;},
+			make_shared <MyDB_DoubleAttType> ()), lhs);
+	
 	} else {
-		cout << "This is bad... cannot do anything with the >.\n";
+		cout << "This is bad... cannot do anything with the unary minus.\n";
 		exit (1);
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: neq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
-
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () != rhs.first ()->toInt ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+pair <func, MyDB_AttTypePtr> MyDB_Record :: times (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildArithmetic <MyDB_TimesOp> (context, scratch, lhs, rhs, "times");
+}
 
-	} else if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+pair <func, MyDB_AttTypePtr> MyDB_Record :: divide (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildArithmetic <MyDB_DivideOp> (context, scratch, lhs, rhs, "divide");
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () != rhs.first ()->toBool ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+pair <func, MyDB_AttTypePtr> MyDB_Record :: gt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildComparison <MyDB_GtOp> (context, scratch, lhs, rhs);
+}
 
-	// otherwise, if both sides can be cast upwards to be doubles, then do so
-	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+pair <func, MyDB_AttTypePtr> MyDB_Record :: lt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildComparison <MyDB_LtOp> (context, scratch, lhs, rhs);
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () != rhs.first ()->toDouble ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+pair <func, MyDB_AttTypePtr> MyDB_Record :: eq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildComparison <MyDB_EqOp> (context, scratch, lhs, rhs);
+}
 
-	// otherwise, if both sides can be cast upwards to be strings, then do so
-	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+pair <func, MyDB_AttTypePtr> MyDB_Record :: neq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildComparison <MyDB_NeqOp> (context, scratch, lhs, rhs);
+}
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () != rhs.first ()->toString ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+// builds a chain of && (or ||) clauses; nested chains of the same type are flattened into one,
+// and literal clauses are folded away
+static pair <func, MyDB_AttTypePtr> buildChain (MyDB_ExprContextPtr context, bool isAnd, pair <func, MyDB_AttTypePtr> &lhs, 
+	pair <func, MyDB_AttTypePtr> &rhs) {
 
-	} else {
-		cout << "This is bad... cannot do anything with the >.\n";
+	if (!lhs.second->isBool () || !rhs.second->isBool ()) {
+		cout << "This is bad... cannot do " << (isAnd ? "and" : "or") << " on non booleans.\n";
 		exit (1);
 	}
-}
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: orr (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	vector <func> clauses;
+	for (func *f : {&lhs.first, &rhs.first}) {
+		const MyDB_BoolChain *chain = f->target <MyDB_BoolChain> ();
+		if (chain != nullptr && chain->state->isAnd == isAnd) {
+			for (func &clause : chain->state->clauses)
+				clauses.push_back (clause);
 
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+		// a literal either decides the result, or has no effect
+		} else if (MyDB_isLiteral (*f)) {
+			if ((*f) ()->toBool () != isAnd)
+				return make_pair (*f, make_shared <MyDB_BoolAttType> ());
 
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () || rhs.first ()->toBool ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+		} else {
+			clauses.push_back (*f);
+		}
+	}
 
+	if (clauses.size () == 0) {
+		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+		temp->set (isAnd);
+		MyDB_Literal lit;
+		lit.val = temp;
+		return make_pair (lit, make_shared <MyDB_BoolAttType> ());
+	} else if (clauses.size () == 1) {
+		return make_pair (clauses[0], make_shared <MyDB_BoolAttType> ());
 	} else {
-		cout << "This is bad... cannot do or on non booleans.\n";
-		exit (1);
+		return make_pair (MyDB_BoolChain (context, isAnd, clauses), make_shared <MyDB_BoolAttType> ());
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: andd (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
-
-	// if both sides can be cast upwards to be ints, then do so
-	if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
-
-		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () && rhs.first ()->toBool ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+pair <func, MyDB_AttTypePtr> MyDB_Record :: orr (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildChain (context, false, lhs, rhs);
+}
 
-	} else {
-		cout << "This is bad... cannot do or on non booleans.\n";
-		exit (1);
-	}
+pair <func, MyDB_AttTypePtr> MyDB_Record :: andd (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+	return buildChain (context, true, lhs, rhs);
 }
 
 pair <func, MyDB_AttTypePtr> MyDB_Record :: nott (pair <func, MyDB_AttTypePtr> lhs) {
 
+	MyDB_ExprContextPtr context = this->context;
+
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->isBool ()) {
 		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
 		scratch.push_back (temp);
+		MyDB_FuncSource <MyDB_BoolAttVal> in (lhs.first);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs] {temp->set (!lhs.first ()->toBool ()); return temp;},
-			make_shared <MyDB_BoolAttType> ());
+		return foldUnary (make_pair ([temp, in, context] {context->numEvals++; temp->set (!in.get ()); return temp;},
+			make_shared <MyDB_BoolAttType> ()), lhs);
 
 	} else {
 		cout << "This is bad... cannot do not on non boolean.\n";
@@ -783,6 +864,35 @@ void *MyDB_Record :: fromBinary (void *fromHere) {
 
 	recSize = *((short *) fromHere);
 
+	// if the record is narrowed, copy over just the attributes that are needed, walking past the others
+	if (!neededAtts.empty ()) {
+
+		if (recSize > allocatedSize) {
+			if (buffer != nullptr)
+				delete [] buffer;
+			buffer = new char[recSize * 2];
+			allocatedSize = recSize * 2;
+		}
+
+		char *from = ((char *) fromHere) + sizeof (short);
+		char *to = buffer;
+		size_t next = 0;
+		for (size_t i = 0; next < neededAtts.size (); i++) {
+			short attLen = *((short *) from);
+			if (neededAtts[next] == i) {
+				memcpy (to, from, attLen);
+				to = values[i]->fromBinary (to);
+				next++;
+			}
+			from += attLen;
+		}
+
+		// the buffer no longer holds the whole record
+		bufferOld = true;
+
+		return ((char *) fromHere) + recSize;
+	}
+
 	// if our buffer is not large enough, reallocate
 	if (recSize > allocatedSize) {
 		if (buffer != nullptr)
@@ -806,15 +916,87 @@ void *MyDB_Record :: fromBinary (void *fromHere) {
 
 }
 
+vector <size_t> MyDB_Record :: getReferencedAtts (vector <string> &computations) {
+
+	vector <bool> used (values.size (), false);
+	for (string &s : computations) {
+		for (size_t pos = s.find ('['); pos != string :: npos; pos = s.find ('[', pos)) {
+
+			size_t end = s.find (']', pos);
+			if (end == string :: npos)
+				break;
+
+			// a bracket that follows a type name (as in "int[1]" or "string [abc]") holds a literal
+			size_t prev = pos;
+			while (prev > 0 && isspace (s[prev - 1]))
+				prev--;
+			if (prev == 0 || !isalpha (s[prev - 1])) {
+				string attName = s.substr (pos + 1, end - pos - 1);
+				int i = 0;
+				for (auto &att : mySchema->getAtts ()) {
+					if (att.first == attName)
+						used[i] = true;
+					i++;
+				}
+			}
+			pos = end + 1;
+		}
+	}
+
+	vector <size_t> res;
+	for (size_t i = 0; i < used.size (); i++) {
+		if (used[i])
+			res.push_back (i);
+	}
+	return res;
+}
+
+void MyDB_Record :: narrowTo (vector <size_t> whichAtts) {
+
+	sort (whichAtts.begin (), whichAtts.end ());
+	whichAtts.erase (unique (whichAtts.begin (), whichAtts.end ()), whichAtts.end ());
+
+	// if every attribute is needed, there is nothing to skip
+	if (whichAtts.size () == values.size ())
+		whichAtts.clear ();
+	neededAtts = whichAtts;
+
+	// the attributes that are skipped must not point into the buffer, which will now hold other data
+	if (!neededAtts.empty ()) {
+		size_t next = 0;
+		for (size_t i = 0; i < values.size (); i++) {
+			if (next < neededAtts.size () && neededAtts[next] == i)
+				next++;
+			else
+				values[i]->setNotBuffered ();
+		}
+		bufferOld = true;
+	}
+}
+
 void MyDB_Record :: fromString (string res) {	
-	int i = 0;
-        for (int pos = 0; pos < (int) res.size (); pos = (int) res.find ("|", pos + 1) + 1) {
-                string temp = res.substr (pos, res.find ("|", pos + 1) - pos);
-		values[i++]->fromString (temp);
-        }
+	fromChars (res.data (), res.data () + res.size ());
+}
+
+void MyDB_Record :: fromChars (const char *begin, const char *end) {
+	size_t i = 0;
+	for (const char *pos = begin; pos < end && i < values.size (); ) {
+		const char *bar = (const char *) memchr (pos, '|', end - pos);
+		if (bar == nullptr)
+			bar = end;
+		values[i++]->fromChars (pos, bar);
+		pos = bar + 1;
+	}
 	bufferOld = true;
 }
 
+void MyDB_Record :: appendString (string &appendToMe) {
+	for (MyDB_AttValPtr &temp : values) {
+		temp->appendString (appendToMe);
+		appendToMe += '|';
+	}
+}
+
 std::ostream& operator<<(std::ostream& os, const MyDB_Record printMe) {
 	for (MyDB_AttValPtr temp : printMe.values) {
 		os << temp->toString () << "|";
@@ -832,6 +1014,11 @@ std::ostream& operator<<(std::ostream& os, const MyDB_RecordPtr printMe) {
 }
 
 function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, string computation) {
+	return buildRecordComparator (lhs, rhs, computation, false);
+}
+
+function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, string computation,
+	bool descending) {
 
 	// compile a computation over the LHS and over the RHS
 	char *str = (char *) computation.c_str ();
@@ -840,10 +1027,26 @@ function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rh
 	str = (char *) computation.c_str ();
 	pair <func, MyDB_AttTypePtr> rhsFunc = rhs->compileHelper (str);
 
-	// and then build a lambda that performs the computatation
-	auto res = lhs->lt (lhsFunc, rhsFunc);
-	func temp = res.first;
-	return [=] {return temp ()->toBool ();};
+	// and then build a lambda that performs the computatation; this one does not remember its
+	// result, since it depends upon two records that change independently
+	auto res = descending ? buildComparison <MyDB_GtOp> (nullptr, lhs->scratch, lhsFunc, rhsFunc) :
+		buildComparison <MyDB_LtOp> (nullptr, lhs->scratch, lhsFunc, rhsFunc);
+	MyDB_RecordLessThan lessThan;
+	lessThan.lessThan = res.first;
+
+	// unless both sides just read an attribute, each comparison is a new evaluation over both records
+	if (lhsFunc.first.target <MyDB_AttRef> () == nullptr || rhsFunc.first.target <MyDB_AttRef> () == nullptr) {
+		MyDB_ExprContextPtr lhsContext = lhs->context, rhsContext = rhs->context;
+		func compare = res.first;
+		lessThan.lessThan = [lhsContext, rhsContext, compare] () -> MyDB_AttValPtr {
+			lhsContext->epoch++;
+			rhsContext->epoch++;
+			return compare ();
+		};
+	}
+	lessThan.computation = computation;
+	lessThan.descending = descending;
+	return lessThan;
 	
 }
 
@@ -854,6 +1057,7 @@ MyDB_Record :: MyDB_Record (MyDB_SchemaPtr mySchemaIn) {
 	allocatedSize = 256;
 	recSize = 0;
 	bufferOld = true;
+	context = make_shared <MyDB_ExprContext> ();
 
 	if (mySchemaIn == nullptr)
 		return;
@@ -871,6 +1075,10 @@ MyDB_AttValPtr &MyDB_Record :: getAtt (int whichAtt) {
 	return values[whichAtt];
 }
 
+size_t MyDB_Record :: getNumEvals () {
+	return context->numEvals;
+}
+
 void MyDB_Record :: buildFrom (MyDB_RecordPtr left, MyDB_RecordPtr right) {
         vector <MyDB_AttValPtr> newValues;
         for (auto &v : left->values) {
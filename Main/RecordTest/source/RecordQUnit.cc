@@ -3,23 +3,48 @@
 #define RECORD_TEST_H
 
 #include "MyDB_AttType.h"  
+#include "MyDB_BPlusTreeReaderWriter.h"
 #include "MyDB_BufferManager.h"
 #include "MyDB_Catalog.h"  
 #include "MyDB_Page.h"
 #include "MyDB_PageReaderWriter.h"
+#include "MyDB_ParallelScan.h"
 #include "MyDB_Record.h"
+#include "MyDB_RunQueueIteratorAlt.h"
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Schema.h"
+#include "MyDB_SortKey.h"
 #include "QUnit.h"
+#include "Sorting.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <set>
 #include <time.h>
 #include <unistd.h>
 #include <vector>
 
 #define FALLTHROUGH_INTENDED do {} while (0)
 
+// count all heap allocations, so that we can check that scanning a table does not allocate
+static size_t numAllocations = 0;
+
+void *operator new (size_t size) {
+	numAllocations++;
+	void *res = malloc (size);
+	if (res == nullptr)
+		throw bad_alloc ();
+	return res;
+}
+
+void operator delete (void *ptr) noexcept {
+	free (ptr);
+}
+
 void initialize() {
 	cout << "start initialization..." << flush;
 
@@ -463,6 +488,1260 @@ int main(int argc, char *argv[]) {
 		QUNIT_IS_FALSE(result);
 	}
 	FALLTHROUGH_INTENDED;
+	case 10:
+	{
+		// compiled computations over mixed types
+		cout << "TEST 10..." << flush;
+		initialize();
+		int mismatches = 0;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+
+			cout << "create TableReaderWriter..." << flush;
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+
+			cout << "compile..." << flush;
+			func negBal = temp->compileComputation("< ([acctbal], int[0])");
+			func nation = temp->compileComputation("== ([nationkey], int[5])");
+			func keyPlus = temp->compileComputation("+ ([suppkey], double[0.5])");
+			func keyTimes = temp->compileComputation("* ([suppkey], [nationkey])");
+			func nameGt = temp->compileComputation("> ([name], string[Supplier#000005000])");
+			func balGt = temp->compileComputation("> (- ([acctbal], [suppkey]), [nationkey])");
+
+			cout << "check..." << flush;
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(temp);
+			while (myIter->hasNext()) {
+				myIter->getNext();
+				int key = temp->getAtt(0)->toInt();
+				int nationKey = temp->getAtt(3)->toInt();
+				double bal = temp->getAtt(5)->toDouble();
+				string name = temp->getAtt(1)->toString();
+				if (negBal()->toBool() != (bal < 0)) mismatches++;
+				if (nation()->toBool() != (nationKey == 5)) mismatches++;
+				if (keyPlus()->toDouble() != key + 0.5) mismatches++;
+				if (keyTimes()->toInt() != key * nationKey) mismatches++;
+				if (nameGt()->toBool() != (name > "Supplier#000005000")) mismatches++;
+				if (balGt()->toBool() != (bal - key > nationKey)) mismatches++;
+			}
+
+			cout << "shutdown manager..." << flush;
+		}
+		if (mismatches == 0) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_EQUAL(mismatches, 0);
+	}
+	FALLTHROUGH_INTENDED;
+	case 11:
+	{
+		// constant folding, shared sub-computations, and short-circuiting, as seen by the evaluation counter
+		cout << "TEST 11..." << flush;
+		initialize();
+		int mismatches = 0;
+		size_t evalsPerRec = 0, evalsPerRecLate = 0;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+
+			cout << "create TableReaderWriter..." << flush;
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+
+			// the literal sub-tree is folded, and the shifted balance is computed once per evaluation; when not
+			// short-circuited, this is one +, two comparisons, and one && per record, plus one + for the projection
+			cout << "compile..." << flush;
+			func pred = temp->compileComputation("&& (> (+ ([acctbal], + (double[1.5], int[2])), int[0]), "
+				"< (+ ([acctbal], + (double[1.5], int[2])), int[5000]))");
+			func proj = temp->compileComputation("+ ([acctbal], + (double[1.5], int[2]))");
+
+			// the first clause is always true, so the second should be moved in front of it
+			func selective = temp->compileComputation("&& (> ([suppkey], int[0]), == ([nationkey], int[3]))");
+
+			cout << "check..." << flush;
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(temp);
+			int numRecs = 0;
+			size_t evalsBefore = temp->getNumEvals();
+			size_t evalsHalfway = 0;
+			while (myIter->hasNext()) {
+				myIter->getNext();
+				double bal = temp->getAtt(5)->toDouble();
+				int nationKey = temp->getAtt(3)->toInt();
+				if (pred()->toBool() != (bal + 3.5 > 0 && bal + 3.5 < 5000)) mismatches++;
+				if (proj()->toDouble() != bal + 3.5) mismatches++;
+				if (selective()->toBool() != (nationKey == 3)) mismatches++;
+				if (++numRecs == 5000) evalsHalfway = temp->getNumEvals();
+			}
+			evalsPerRec = (temp->getNumEvals() - evalsBefore) / numRecs;
+			evalsPerRecLate = (temp->getNumEvals() - evalsHalfway) / (numRecs - 5000);
+			cout << "evals per record " << evalsPerRec << ", later " << evalsPerRecLate << "..." << flush;
+
+			cout << "shutdown manager..." << flush;
+		}
+		bool result = (mismatches == 0 && evalsPerRec <= 8 && evalsPerRecLate <= 7);
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 12:
+	{
+		// scanning, filtering on strings, hashing, and projecting strings should not allocate per record (moving
+		// from one page to the next does allocate a few page handles and an iterator)
+		cout << "TEST 12..." << flush;
+		initialize();
+		size_t allocs = 0;
+		int numRecs = 0, numAccepted = 0, numPages = 0;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+
+			cout << "create TableReaderWriter..." << flush;
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+			MyDB_RecordPtr out = supplierTable.getEmptyRecord();
+			func pred = temp->compileComputation("&& (> ([name], string[Supplier#000000500]), != ([phone], [address]))");
+			vector <func> projs;
+			for (auto &att : allTables["supplier"]->getSchema()->getAtts())
+				projs.push_back(temp->compileComputation("[" + att.first + "]"));
+			char outBuffer[1024];
+
+			cout << "scan..." << flush;
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(temp);
+			size_t hashes = 0;
+			size_t allocsBefore = numAllocations;
+			while (myIter->hasNext()) {
+				myIter->getNext();
+				numRecs++;
+				hashes += temp->getAtt(1)->hash();
+				if (pred()->toBool()) {
+					numAccepted++;
+					int i = 0;
+					for (auto &f : projs)
+						out->getAtt(i++)->set(f());
+					out->recordContentHasChanged();
+					out->toBinary(outBuffer);
+				}
+			}
+			allocs = numAllocations - allocsBefore;
+			numPages = supplierTable.getNumPages();
+			cout << "allocs " << allocs << " over " << numRecs << " records on " << numPages << " pages (hash " << hashes % 10 << ")..." << flush;
+
+			cout << "shutdown manager..." << flush;
+		}
+		bool result = (allocs <= 8 * (size_t) numPages && (int) allocs < numRecs && numAccepted == 9500);
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 13:
+	{
+		// dates are stored as day numbers, print as YYYY-MM-DD, and compare with date and string literals
+		cout << "TEST 13..." << flush;
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+		mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+		mySchema->appendAtt(make_pair("shipdate", make_shared <MyDB_DateAttType>()));
+		MyDB_RecordPtr temp = make_shared <MyDB_Record>(mySchema);
+		MyDB_RecordPtr copy = make_shared <MyDB_Record>(mySchema);
+		func before = temp->compileComputation("< ([shipdate], string[1995-03-15])");
+		func same = temp->compileComputation("== ([shipdate], date[1995-03-15])");
+		func later = temp->compileComputation("> ([shipdate], + ([key], int[1]))");
+		char buffer[64];
+
+		int mismatches = 0;
+		if (MyDB_DateAttVal::parse("1970-01-01") != 0 || MyDB_DateAttVal::parse("2000-03-01") != 11017 ||
+			MyDB_DateAttVal::parse("1969-12-31") != -1 || MyDB_DateAttVal::format(9204) != "1995-03-15")
+			mismatches++;
+		for (int day = -300000; day < 2900000; day += 97) {
+			string text = MyDB_DateAttVal::format(day);
+			temp->fromString(to_string(day) + "|" + text + "|");
+			temp->toBinary(buffer);
+			copy->fromBinary(buffer);
+			if (temp->getAtt(1)->toInt() != day) mismatches++;
+			if (copy->getAtt(1)->toString() != text) mismatches++;
+			if (before()->toBool() != (text < "1995-03-15")) mismatches++;
+			if (same()->toBool() != (text == "1995-03-15")) mismatches++;
+			if (later()->toBool()) mismatches++;
+		}
+		temp->fromString("9204|1995-03-15|");
+		if (!same()->toBool() || before()->toBool()) mismatches++;
+
+		if (mismatches == 0) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_EQUAL(mismatches, 0);
+	}
+	FALLTHROUGH_INTENDED;
+	case 14:
+	{
+		// decimals are parsed, printed, computed with and summed exactly
+		cout << "TEST 14..." << flush;
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+		mySchema->appendAtt(make_pair("quantity", make_shared <MyDB_IntAttType>()));
+		mySchema->appendAtt(make_pair("price", make_shared <MyDB_DecimalAttType>(15, 2)));
+		mySchema->appendAtt(make_pair("discount", make_shared <MyDB_DecimalAttType>(15, 2)));
+		MyDB_RecordPtr temp = make_shared <MyDB_Record>(mySchema);
+		MyDB_RecordPtr copy = make_shared <MyDB_Record>(mySchema);
+		func charge = temp->compileComputation("* ([price], - (int[1], [discount]))");
+		func total = temp->compileComputation("+ (* ([price], [quantity]), double[0.05])");
+		func cheap = temp->compileComputation("< ([price], double[100.25])");
+		func ratio = temp->compileComputation("/ ([price], [quantity])");
+		char buffer[64];
+
+		// prints val / 10^scale
+		auto print = [](long long val, int scale) {
+			string digits = to_string(val);
+			digits = string(scale + 1 > (int) digits.size() ? scale + 1 - digits.size() : 0, '0') + digits;
+			return digits.substr(0, digits.size() - scale) + "." + digits.substr(digits.size() - scale);
+		};
+
+		int mismatches = 0;
+		if (temp->getType("* ([price], - (int[1], [discount]))")->toString() != "decimal(18,4)") mismatches++;
+		MyDB_DecimalAttVal sum(2, true);
+		long long allCents = 0;
+		for (int i = 1; i < 100000; i += 7) {
+			long long cents = i * 1234LL % 10000019, discount = i % 11, quantity = i % 50 + 1;
+			temp->fromString(to_string(quantity) + "|" + print(cents, 2) + "|" + print(discount, 2) + "|");
+			temp->toBinary(buffer);
+			copy->fromBinary(buffer);
+			if (copy->getAtt(1)->toString() != print(cents, 2)) mismatches++;
+			if (charge()->toString() != print(cents * (100 - discount), 4)) mismatches++;
+			if (total()->toString() != print(cents * quantity + 5, 2)) mismatches++;
+			if (cheap()->toBool() != (cents < 10025)) mismatches++;
+			if (ratio()->toString() != print((cents * 10000 + quantity / 2) / quantity, 6)) mismatches++;
+			sum.add(static_cast <MyDB_DecimalAttVal *> (copy->getAtt(1).get())->getDecimal());
+			allCents += cents;
+		}
+		if (sum.toString() != print(allCents, 2)) mismatches++;
+
+		// a sum too big for 64 bits is still exact
+		MyDB_DecimalAttVal big(4, true);
+		for (int i = 0; i < 1000; i++)
+			big.add(MyDB_Decimal(999999999999999999LL, 4));
+		if (big.toString() != "99999999999999999.9000") mismatches++;
+
+		// values that need more than 64 bits part way through an operation are still worked out exactly, and
+		// rounded to the scale of the result
+		if (MyDB_compare(MyDB_Decimal(100, 0), MyDB_Decimal(1, 18)) <= 0) mismatches++;
+		if (MyDB_compare(MyDB_Decimal(-100, 0), MyDB_Decimal(-1, 18)) >= 0) mismatches++;
+		MyDB_Decimal product = MyDB_Decimal(900000000000000000LL, 18) * MyDB_Decimal(900000000000000000LL, 18);
+		if (product.val != 810000000000000000LL || product.scale != 18) mismatches++;
+		product = MyDB_Decimal(12345678901LL, 10) * MyDB_Decimal(3, 10);
+		if (product.val != 370370367LL || product.scale != 18) mismatches++;
+		MyDB_Decimal shifted = MyDB_Decimal(5, 0) - MyDB_Decimal(1, 18);
+		if (shifted.val != 4999999999999999999LL || shifted.scale != 18) mismatches++;
+
+		if (mismatches == 0) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_EQUAL(mismatches, 0);
+	}
+	FALLTHROUGH_INTENDED;
+	case 15:
+	{
+		// collision rates of the key hashes over the supplier keys: single keys, strided keys (which
+		// all land in one bucket under an identity hash), composite keys, and composite keys whose
+		// attributes are equal (which all cancel out when combined with xor)
+		cout << "TEST 15..." << flush;
+		initialize();
+		set <size_t> single, composite, swapped, repeated;
+		vector <int> buckets (1024, 0);
+		size_t mixed = 0;
+		int numRecs = 0;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+
+			cout << "create TableReaderWriter..." << flush;
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+			func strided = temp->compileComputation("* ([suppkey], int[1024])");
+			func asDouble = temp->compileComputation("+ ([suppkey], double[0.0])");
+
+			cout << "hash..." << flush;
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(temp);
+			while (myIter->hasNext()) {
+				myIter->getNext();
+				numRecs++;
+				size_t key = temp->getAtt(0)->hash(), nation = temp->getAtt(3)->hash();
+				single.insert(key);
+				buckets[strided()->hash() % 1024]++;
+				composite.insert(MyDB_hashCombine(MyDB_hashCombine(0, key), nation));
+				swapped.insert(MyDB_hashCombine(MyDB_hashCombine(0, nation), key));
+				repeated.insert(MyDB_hashCombine(MyDB_hashCombine(0, key), key));
+				if (asDouble()->hash() != key) mixed++;
+			}
+			cout << "shutdown manager..." << flush;
+		}
+		int maxBucket = *max_element(buckets.begin(), buckets.end());
+		cout << "collisions: single " << numRecs - single.size() << ", composite " << numRecs - composite.size() <<
+			", repeated " << numRecs - repeated.size() << ", max strided bucket " << maxBucket << "..." << flush;
+
+		vector <size_t> batch (numRecs);
+		vector <int> keys (numRecs);
+		for (int i = 0; i < numRecs; i++)
+			keys[i] = i + 1;
+		MyDB_hashInts(keys.data(), batch.data(), numRecs);
+
+		bool result = (single.size() == (size_t) numRecs && composite.size() == (size_t) numRecs &&
+			repeated.size() == (size_t) numRecs && composite != swapped && maxBucket < 40 && mixed == 0 &&
+			set <size_t> (batch.begin(), batch.end()) == single);
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 16:
+	{
+		cout << "TEST 16... " << flush;
+		bool result;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+
+			// load the suppliers with the bulk loader, and again one record at a time; the pages should match
+			cout << "load..." << flush;
+			MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema();
+			MyDB_TableReaderWriter bulkTable(make_shared <MyDB_Table>("bulk", "bulk.bin", mySchema), myMgr);
+			MyDB_TableReaderWriter singleTable(make_shared <MyDB_Table>("single", "single.bin", mySchema), myMgr);
+			pair <vector <MyDB_HyperLogLog>, size_t> stats = bulkTable.loadFromTextFile("supplier.tbl");
+			MyDB_RecordPtr temp = singleTable.getEmptyRecord();
+			ifstream input("supplier.tbl");
+			string line;
+			while (getline(input, line)) {
+				temp->fromString(line);
+				singleTable.append(temp);
+			}
+
+			cout << "compare..." << flush;
+			result = stats.second == 10000 && stats.first[3].estimate() == 25 && stats.first[0].estimate() > 9500 &&
+				stats.first[0].estimate() < 10500 &&
+				bulkTable.getNumPages() == singleTable.getNumPages();
+			for (int i = 0; result && i < bulkTable.getNumPages(); i++) {
+				MyDB_PageReaderWriter bulkPage = bulkTable[i], singlePage = singleTable[i];
+				char *bulkBytes = (char *) bulkPage.getBytes(), *singleBytes = (char *) singlePage.getBytes();
+				size_t bytesUsed = *((size_t *) (bulkBytes + sizeof(size_t)));
+				result = memcmp(bulkBytes + sizeof(size_t), singleBytes + sizeof(size_t), bytesUsed - sizeof(size_t)) == 0;
+			}
+		}
+		unlink("bulk.bin");
+		unlink("single.bin");
+
+		// then time both ways of loading on lineitem-like data, at a few TPC-H scale factors
+		MyDB_SchemaPtr lineSchema = make_shared <MyDB_Schema>();
+		lineSchema->appendAtt(make_pair("orderkey", make_shared <MyDB_IntAttType>()));
+		lineSchema->appendAtt(make_pair("partkey", make_shared <MyDB_IntAttType>()));
+		lineSchema->appendAtt(make_pair("suppkey", make_shared <MyDB_IntAttType>()));
+		lineSchema->appendAtt(make_pair("linenumber", make_shared <MyDB_IntAttType>()));
+		lineSchema->appendAtt(make_pair("quantity", make_shared <MyDB_DoubleAttType>()));
+		lineSchema->appendAtt(make_pair("extendedprice", make_shared <MyDB_DoubleAttType>()));
+		lineSchema->appendAtt(make_pair("discount", make_shared <MyDB_DoubleAttType>()));
+		lineSchema->appendAtt(make_pair("tax", make_shared <MyDB_DoubleAttType>()));
+		lineSchema->appendAtt(make_pair("returnflag", make_shared <MyDB_StringAttType>()));
+		lineSchema->appendAtt(make_pair("linestatus", make_shared <MyDB_StringAttType>()));
+		lineSchema->appendAtt(make_pair("shipdate", make_shared <MyDB_DateAttType>()));
+		lineSchema->appendAtt(make_pair("shipmode", make_shared <MyDB_StringAttType>()));
+		lineSchema->appendAtt(make_pair("comment", make_shared <MyDB_StringAttType>()));
+		double scaleFactors[] = {0.001, 0.01, 0.05};
+		for (double scaleFactor : scaleFactors) {
+
+			size_t numLines = (size_t) (6000000 * scaleFactor);
+			{
+				ofstream output("lineitemBench.tbl");
+				unsigned seed = 7;
+				for (size_t i = 0; i < numLines; i++) {
+					seed = seed * 1103515245 + 12345;
+					output << i / 4 + 1 << "|" << seed % 200000 << "|" << seed % 10000 << "|" << i % 4 + 1 << "|" <<
+						seed % 50 + 1 << "|" << (seed % 10000000) / 100.0 << "|0.0" << seed % 10 << "|0.0" << seed % 8 <<
+						"|" << "ANR"[seed % 3] << "|" << "OF"[seed % 2] << "|199" << seed % 7 + 2 << "-0" << seed % 9 + 1 <<
+						"-1" << seed % 10 << "|" << (seed % 2 ? "TRUCK" : "MAIL") << "|carefully final deposits " << seed << "|\n";
+				}
+			}
+
+			MyDB_BufferManagerPtr benchMgr = make_shared <MyDB_BufferManager>(64 * 1024, 64, "tempFileBench");
+			MyDB_TableReaderWriter bulkTable(make_shared <MyDB_Table>("bulk", "bulk.bin", lineSchema), benchMgr);
+			MyDB_TableReaderWriter singleTable(make_shared <MyDB_Table>("single", "single.bin", lineSchema), benchMgr);
+
+			cout << "SF " << scaleFactor << ": " << flush;
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			result = bulkTable.loadFromTextFile("lineitemBench.tbl").second == numLines && result;
+			double bulkSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count();
+
+			start = chrono::steady_clock::now();
+			MyDB_RecordPtr temp = singleTable.getEmptyRecord();
+			vector <set <size_t>> hashes(lineSchema->getAtts().size());
+			ifstream input("lineitemBench.tbl");
+			string line;
+			while (getline(input, line)) {
+				temp->fromString(line);
+				for (size_t i = 0; i < hashes.size(); i++)
+					hashes[i].insert(temp->getAtt(i)->hash() % 1024);
+				singleTable.append(temp);
+			}
+			double singleSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count();
+			cout << "bulk " << (size_t) (numLines / bulkSecs) << " rows/sec, one at a time " <<
+				(size_t) (numLines / singleSecs) << " rows/sec..." << flush;
+			result = result && bulkTable.getNumPages() == singleTable.getNumPages();
+		}
+		unlink("lineitemBench.tbl");
+		unlink("bulk.bin");
+		unlink("single.bin");
+		unlink("tempFileBench");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 17:
+	{
+		// distinct-value estimates from the HyperLogLog sketches versus the old method (a set of the
+		// hashes divisible by a power of two, thinned whenever it passes 1000 entries)
+		cout << "TEST 17... " << flush;
+		bool result = true;
+		size_t counts[] = {1000, 100000, 1000000};
+		for (size_t numDistinct : counts) {
+
+			// each distinct value appears twice, as an int and as a string
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			set <size_t> sample;
+			size_t every = 1;
+			for (size_t i = 0; i < 2 * numDistinct; i++) {
+				string val = to_string(i % numDistinct);
+				for (size_t hash : {MyDB_hashInt(i % numDistinct), MyDB_hashBytes(val.data(), val.size())}) {
+					if (hash % every != 0)
+						continue;
+					sample.insert(hash);
+					while (sample.size() > 1000) {
+						every *= 2;
+						set <size_t> newSet;
+						for (auto &num : sample)
+							if (num % every == 0)
+								newSet.insert(num);
+						sample = newSet;
+					}
+				}
+			}
+			double oldSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count();
+			size_t oldEst = sample.size() * every;
+
+			start = chrono::steady_clock::now();
+			MyDB_HyperLogLog sketch, firstHalf, secondHalf;
+			for (size_t i = 0; i < 2 * numDistinct; i++) {
+				string val = to_string(i % numDistinct);
+				MyDB_HyperLogLog &half = (i < numDistinct) ? firstHalf : secondHalf;
+				sketch.add(MyDB_hashInt(i % numDistinct));
+				sketch.add(MyDB_hashBytes(val.data(), val.size()));
+				half.add(MyDB_hashInt(i % numDistinct));
+				half.add(MyDB_hashBytes(val.data(), val.size()));
+			}
+			double newSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count() / 2;
+			size_t newEst = sketch.estimate();
+
+			double oldErr = fabs((double) oldEst / (2 * numDistinct) - 1.0);
+			double newErr = fabs((double) newEst / (2 * numDistinct) - 1.0);
+			cout << 2 * numDistinct << " distinct: old " << oldEst << " in " << oldSecs << "s, sketch " << newEst <<
+				" in " << newSecs << "s..." << flush;
+			firstHalf.merge(secondHalf);
+			result = result && newErr < 0.05 && oldErr < 1.0 &&
+				firstHalf.toString() == sketch.toString();
+		}
+
+		// the sketches should survive a trip through the catalog, and be merged into when more is added
+		{
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("sketchCat");
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+			MyDB_Table myTable("sketched", "sketched.bin", mySchema);
+			vector <MyDB_HyperLogLog> sketches(1), more(1);
+			for (int i = 0; i < 50000; i++) {
+				sketches[0].add(MyDB_hashInt(i));
+				more[0].add(MyDB_hashInt(i + 25000));
+			}
+			myTable.setDistinctValues(sketches);
+			myTable.setTupleCount(50000);
+			myTable.putInCatalog(myCatalog);
+
+			MyDB_Table fromCat;
+			fromCat.fromCatalog("sketched", myCatalog);
+			fromCat.addDistinctValues(more);
+			cout << "after catalog and merge " << fromCat.getDistinctValues(0) << "..." << flush;
+			result = result && myTable.getDistinctValues(0) == sketches[0].estimate() &&
+				fabs(fromCat.getDistinctValues(0) / 75000.0 - 1.0) < 0.05;
+		}
+		unlink("sketchCat");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 18:
+	{
+		// writing a table out as text should give just what writing each record with operator<< gives
+		cout << "TEST 18... " << flush;
+		bool result;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("price", make_shared <MyDB_DoubleAttType>()));
+			mySchema->appendAtt(make_pair("flag", make_shared <MyDB_BoolAttType>()));
+			mySchema->appendAtt(make_pair("shipdate", make_shared <MyDB_DateAttType>()));
+			mySchema->appendAtt(make_pair("amount", make_shared <MyDB_DecimalAttType>(12, 2)));
+			mySchema->appendAtt(make_pair("comment", make_shared <MyDB_StringAttType>()));
+			{
+				ofstream output("writeBench.tbl");
+				unsigned seed = 11;
+				for (int i = 0; i < 200000; i++) {
+					seed = seed * 1103515245 + 12345;
+					output << (int) seed << "|" << (seed % 10000000) / 100.0 - 5000 << "|" << (seed % 2 ? "true" : "false") <<
+						"|" << 1900 + seed % 200 << "-" << seed % 12 + 1 << "-" << seed % 28 + 1 << "|" <<
+						(seed % 1000000) / 100 << "." << seed % 100 << "|quickly regular packages " << seed << "|\n";
+				}
+			}
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(64 * 1024, 64, "tempFileWrite");
+			MyDB_TableReaderWriter myTable(make_shared <MyDB_Table>("written", "written.bin", mySchema), myMgr);
+			myTable.loadFromTextFile("writeBench.tbl");
+
+			cout << "write..." << flush;
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			myTable.writeIntoTextFile("writeOut.tbl");
+			double fastSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count();
+
+			start = chrono::steady_clock::now();
+			{
+				ofstream output("writeOutSlow.tbl");
+				MyDB_RecordPtr temp = myTable.getEmptyRecord();
+				MyDB_RecordIteratorPtr myIter = myTable.getIterator(temp);
+				while (myIter->hasNext()) {
+					myIter->getNext();
+					output << temp << "\n";
+				}
+			}
+			double slowSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count();
+			cout << "writer " << fastSecs << "s, operator<< " << slowSecs << "s..." << flush;
+
+			ifstream fast("writeOut.tbl"), slow("writeOutSlow.tbl");
+			string fastText((istreambuf_iterator <char>(fast)), istreambuf_iterator <char>());
+			string slowText((istreambuf_iterator <char>(slow)), istreambuf_iterator <char>());
+			result = fastText == slowText && count(fastText.begin(), fastText.end(), '\n') == 200000;
+		}
+		unlink("writeBench.tbl");
+		unlink("writeOut.tbl");
+		unlink("writeOutSlow.tbl");
+		unlink("written.bin");
+		unlink("tempFileWrite");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 19:
+	{
+		// getting records a batch at a time should give the very same records as advance () and getCurrent ()
+		cout << "TEST 19... " << flush;
+		bool result;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("comment", make_shared <MyDB_StringAttType>()));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 32, "tempFileBatch");
+			MyDB_TableReaderWriter heapTable(make_shared <MyDB_Table>("heap", "heapBatch.bin", mySchema), myMgr);
+			MyDB_BPlusTreeReaderWriter treeTable("key", make_shared <MyDB_Table>("tree", "treeBatch.bin", mySchema), myMgr);
+			MyDB_RecordPtr temp = heapTable.getEmptyRecord();
+			unsigned seed = 5;
+			for (int i = 0; i < 20000; i++) {
+				seed = seed * 1103515245 + 12345;
+				temp->fromString(to_string(seed % 10000) + "|comment number " + to_string(i) + "|");
+				heapTable.append(temp);
+				treeTable.append(temp);
+			}
+
+			// these walk an iterator both ways, writing out what they see
+			auto oneAtATime = [&](MyDB_RecordIteratorAltPtr iter) {
+				string res;
+				while (iter->advance()) {
+					iter->getCurrent(temp);
+					temp->appendString(res);
+				}
+				return res;
+			};
+			MyDB_RecordBatch batch;
+			size_t numBatches = 0;
+			auto batchAtATime = [&](MyDB_RecordIteratorAltPtr iter) {
+				string res;
+				while (iter->nextBatch(batch)) {
+					numBatches++;
+					for (size_t i = 0; i < batch.size(); i++) {
+						temp->fromBinary(batch[i]);
+						temp->appendString(res);
+					}
+				}
+				return res;
+			};
+
+			cout << "table..." << flush;
+			string heapText = oneAtATime(heapTable.getIteratorAlt());
+			result = heapText == batchAtATime(heapTable.getIteratorAlt()) && numBatches >= 20000 / RECORD_BATCH_SIZE &&
+				count(heapText.begin(), heapText.end(), '|') == 40000;
+
+			// switching from one record at a time to batches should pick up right after the current record
+			MyDB_RecordIteratorAltPtr iter = heapTable.getIteratorAlt();
+			string mixed;
+			for (int i = 0; i < 1000 && iter->advance(); i++) {
+				iter->getCurrent(temp);
+				temp->appendString(mixed);
+			}
+			mixed += batchAtATime(iter);
+			result = result && mixed == heapText;
+
+			cout << "page list..." << flush;
+			vector <MyDB_PageReaderWriter> pages;
+			for (int i = 0; i < heapTable.getNumPages(); i++)
+				pages.push_back(heapTable[i]);
+			result = result && batchAtATime(getIteratorAlt(pages)) == heapText;
+
+			cout << "B+-tree..." << flush;
+			MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal>(), high = make_shared <MyDB_IntAttVal>();
+			low->set(1000);
+			high->set(4999);
+			string treeText = oneAtATime(treeTable.getRangeIteratorAlt(low, high));
+			result = result && treeText == batchAtATime(treeTable.getRangeIteratorAlt(low, high)) &&
+				count(treeText.begin(), treeText.end(), '|') > 14000 && count(treeText.begin(), treeText.end(), '|') < 18000;
+
+			cout << "sorted runs..." << flush;
+			MyDB_RecordPtr lhs = heapTable.getEmptyRecord(), rhs = heapTable.getEmptyRecord();
+			function <bool ()> comparator = buildRecordComparator(lhs, rhs, "[key]");
+			string sortedText = oneAtATime(buildItertorOverSortedRuns(4, heapTable, comparator, lhs, rhs));
+			result = result && sortedText == batchAtATime(buildItertorOverSortedRuns(4, heapTable, comparator, lhs, rhs)) &&
+				sortedText.size() == heapText.size();
+		}
+		unlink("heapBatch.bin");
+		unlink("treeBatch.bin");
+		unlink("tempFileBatch");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 20:
+	{
+		// a record narrowed to the attributes a query uses should compute the same things as a full one
+		cout << "TEST 20... " << flush;
+		bool result;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("a", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("b", make_shared <MyDB_StringAttType>()));
+			mySchema->appendAtt(make_pair("c", make_shared <MyDB_DoubleAttType>()));
+			mySchema->appendAtt(make_pair("d", make_shared <MyDB_StringAttType>()));
+			mySchema->appendAtt(make_pair("e", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("f", make_shared <MyDB_StringAttType>()));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 32, "tempFileNarrow");
+			MyDB_TableReaderWriter myTable(make_shared <MyDB_Table>("narrow", "narrow.bin", mySchema), myMgr);
+			MyDB_RecordPtr full = myTable.getEmptyRecord(), narrow = myTable.getEmptyRecord();
+			for (int i = 0; i < 20000; i++) {
+				full->fromString(to_string(i) + "|a long comment that no query here looks at " + to_string(i) + "|" +
+					to_string(i * 0.25) + "|" + (i % 3 == 0 ? "b" : "x") + "|" + to_string(i % 7) + "|tail|");
+				myTable.append(full);
+			}
+
+			// the "b" inside the string literal is not the attribute b
+			vector <string> comps = {"+ ([a], [e])", "[d]", "&& (< ([c], double[2000.5]), == ([d], string [b]))"};
+			vector <size_t> used = narrow->getReferencedAtts(comps);
+			result = used == vector <size_t>({0, 2, 3, 4});
+			narrow->narrowTo(used);
+
+			vector <func> fullComps, narrowComps;
+			for (string &s : comps) {
+				fullComps.push_back(full->compileComputation(s));
+				narrowComps.push_back(narrow->compileComputation(s));
+			}
+
+			cout << "compare..." << flush;
+			MyDB_RecordIteratorAltPtr fullIter = myTable.getIteratorAlt(), narrowIter = myTable.getIteratorAlt();
+			size_t numAccepted = 0;
+			while (fullIter->advance()) {
+				result = result && narrowIter->advance();
+				fullIter->getCurrent(full);
+				narrowIter->getCurrent(narrow);
+				for (size_t i = 0; i < comps.size(); i++)
+					result = result && fullComps[i]()->toString() == narrowComps[i]()->toString();
+				numAccepted += narrowComps[2]()->toBool();
+			}
+			result = result && !narrowIter->advance() && numAccepted == 2668;
+
+			// and widening it should give back every attribute
+			narrow->narrowTo(vector <size_t>());
+			narrowIter = myTable.getIteratorAlt();
+			string fullText, narrowText;
+			while (narrowIter->advance()) {
+				narrowIter->getCurrent(narrow);
+				narrow->appendString(narrowText);
+			}
+			fullIter = myTable.getIteratorAlt();
+			while (fullIter->advance()) {
+				fullIter->getCurrent(full);
+				full->appendString(fullText);
+			}
+			result = result && fullText == narrowText;
+		}
+		unlink("narrow.bin");
+		unlink("tempFileNarrow");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 21:
+	{
+		// a parallel scan should write just what a scan on one thread writes, in the same order,
+		// however many threads it uses
+		cout << "TEST 21... " << flush;
+		bool result = true;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("val", make_shared <MyDB_DoubleAttType>()));
+			mySchema->appendAtt(make_pair("comment", make_shared <MyDB_StringAttType>()));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 64, "tempFileParallel");
+			MyDB_TableReaderWriter myTable(make_shared <MyDB_Table>("parIn", "parIn.bin", mySchema), myMgr);
+			MyDB_RecordPtr temp = myTable.getEmptyRecord();
+			for (int i = 0; i < 300000; i++) {
+				temp->fromString(to_string(i) + "|" + to_string(i * 1.5) + "|comment " + to_string(i % 1000) + "|");
+				myTable.append(temp);
+			}
+
+			// the expected answer: every record with a key in (100000, 250000), with its val doubled
+			string expected;
+			func doubledVal = temp->compileComputation("* ([val], double[2.0])");
+			MyDB_RecordIteratorAltPtr myIter = myTable.getIteratorAlt();
+			while (myIter->advance()) {
+				myIter->getCurrent(temp);
+				if (temp->getAtt(0)->toInt() > 100000 && temp->getAtt(0)->toInt() < 250000) {
+					temp->getAtt(1)->set(doubledVal());
+					temp->appendString(expected);
+				}
+			}
+
+			// each worker builds its own records and computations
+			auto buildPipeline = [&] () -> MyDB_MorselPipeline {
+				MyDB_RecordPtr in = myTable.getEmptyRecord(), out = myTable.getEmptyRecord();
+				func pred = in->compileComputation("&& (> ([key], int[100000]), < ([key], int[250000]))");
+				func doubled = in->compileComputation("* ([val], double[2.0])");
+				return [=] (MyDB_Morsel &morsel) {
+					char *end = morsel.records.data() + morsel.records.size();
+					for (char *pos = morsel.records.data(); pos < end; ) {
+						pos = (char *) in->fromBinary(pos);
+						if (!pred()->toBool())
+							continue;
+						out->getAtt(0)->set(in->getAtt(0));
+						out->getAtt(1)->set(doubled());
+						out->getAtt(2)->set(in->getAtt(2));
+						out->recordContentHasChanged();
+						size_t at = morsel.output.size();
+						morsel.output.resize(at + out->getBinarySize());
+						out->toBinary(&morsel.output[at]);
+					}
+				};
+			};
+
+			for (size_t numThreads : {1, 2, 4, 8}) {
+				MyDB_TableReaderWriter outTable(make_shared <MyDB_Table>("parOut", "parOut.bin", mySchema), myMgr);
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				MyDB_ParallelScan myScan(myTable);
+				myScan.run(buildPipeline, outTable, numThreads);
+				cout << numThreads << " threads " << chrono::duration <double> (chrono::steady_clock::now() - start).count() << "s..." << flush;
+
+				string found;
+				myIter = outTable.getIteratorAlt();
+				while (myIter->advance()) {
+					myIter->getCurrent(temp);
+					temp->appendString(found);
+				}
+				result = result && found == expected && !expected.empty();
+				myMgr->killTable(outTable.getTable());
+			}
+		}
+		unlink("parIn.bin");
+		unlink("parOut.bin");
+		unlink("tempFileParallel");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 22:
+	{
+		// a parallel sort should give the same records, in the same order of keys, as a sort on one
+		// thread (a comparator that is not from buildRecordComparator gets the one thread sort)
+		cout << "TEST 22... " << flush;
+		bool result = true;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("comment", make_shared <MyDB_StringAttType>()));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 64, "tempFileSort");
+			MyDB_TableReaderWriter myTable(make_shared <MyDB_Table>("sortIn", "sortIn.bin", mySchema), myMgr);
+			MyDB_RecordPtr temp = myTable.getEmptyRecord();
+			unsigned seed = 11;
+			for (int i = 0; i < 100000; i++) {
+				seed = seed * 1103515245 + 12345;
+				temp->fromString(to_string((seed >> 8) % 20000) + "|comment " + to_string(i) + "|");
+				myTable.append(temp);
+			}
+
+			MyDB_RecordPtr lhs = myTable.getEmptyRecord(), rhs = myTable.getEmptyRecord();
+			function <bool ()> comparator = buildRecordComparator(lhs, rhs, "[key]");
+			function <bool ()> oneThread = [comparator] {return comparator();};
+
+			// the records that come out, and their keys, in the order they come out
+			auto readOut = [&](MyDB_RecordIteratorAltPtr iter, vector <int> &keys) {
+				vector <string> res;
+				while (iter->advance()) {
+					iter->getCurrent(temp);
+					keys.push_back(temp->getAtt(0)->toInt());
+					string rec;
+					temp->appendString(rec);
+					res.push_back(rec);
+				}
+				std::sort(res.begin(), res.end());
+				return res;
+			};
+
+			cout << "sort..." << flush;
+			vector <int> parKeys, seqKeys;
+			vector <string> parRecs, seqRecs;
+			for (int which = 0; which < 2; which++) {
+				MyDB_TableReaderWriter outTable(make_shared <MyDB_Table>("sortOut", "sortOut.bin", mySchema), myMgr);
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				sort(4, myTable, outTable, which == 0 ? comparator : oneThread, lhs, rhs);
+				cout << (which == 0 ? "parallel " : "one thread ") << chrono::duration <double> (chrono::steady_clock::now() - start).count() << "s..." << flush;
+				(which == 0 ? parRecs : seqRecs) = readOut(outTable.getIteratorAlt(), which == 0 ? parKeys : seqKeys);
+				myMgr->killTable(outTable.getTable());
+			}
+			result = parRecs.size() == 100000 && parRecs == seqRecs && parKeys == seqKeys && is_sorted(parKeys.begin(), parKeys.end());
+
+			cout << "runs..." << flush;
+			parKeys.clear();
+			seqKeys.clear();
+			parRecs = readOut(buildItertorOverSortedRuns(4, myTable, comparator, lhs, rhs, "< ([key], int[5000])"), parKeys);
+			seqRecs = readOut(buildItertorOverSortedRuns(4, myTable, oneThread, lhs, rhs, "< ([key], int[5000])"), seqKeys);
+			result = result && parRecs.size() > 20000 && parRecs.size() < 30000 && parRecs == seqRecs && parKeys == seqKeys &&
+				is_sorted(parKeys.begin(), parKeys.end());
+		}
+		unlink("sortIn.bin");
+		unlink("sortOut.bin");
+		unlink("tempFileSort");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 23:
+	{
+		// merging sorted runs with the tournament tree should give the same keys, in the same order, as
+		// merging them with a priority queue of iterators; print the time taken by each
+		cout << "TEST 23... " << flush;
+		bool result = true;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("comment", make_shared <MyDB_StringAttType>()));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 1100, "tempFileMerge");
+			MyDB_TableReaderWriter myTable(make_shared <MyDB_Table>("mergeIn", "mergeIn.bin", mySchema), myMgr);
+			MyDB_RecordPtr temp = myTable.getEmptyRecord();
+			MyDB_RecordPtr lhs = myTable.getEmptyRecord(), rhs = myTable.getEmptyRecord();
+			function <bool ()> comparator = buildRecordComparator(lhs, rhs, "[key]");
+
+			unsigned seed = 5;
+			for (int numRuns = 64; numRuns <= 1024; numRuns *= 4) {
+
+				// each run is one page of records, sorted on the key
+				vector <MyDB_PageReaderWriter> runs;
+				for (int i = 0; i < numRuns; i++) {
+					vector <int> keys;
+					for (int j = 0; j < 100; j++) {
+						seed = seed * 1103515245 + 12345;
+						keys.push_back((seed >> 8) % 100000);
+					}
+					std::sort(keys.begin(), keys.end());
+					MyDB_PageReaderWriter run(true, *myMgr);
+					for (int key : keys) {
+						temp->fromString(to_string(key) + "|run " + to_string(i) + "|");
+						run.append(temp);
+					}
+					runs.push_back(run);
+				}
+
+				cout << numRuns << " runs: " << flush;
+				vector <int> heapKeys, treeKeys;
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				priority_queue <MyDB_RecordIteratorAltPtr, vector <MyDB_RecordIteratorAltPtr>, IteratorComparator> 
+					heap(IteratorComparator(comparator, lhs, rhs));
+				for (auto &run : runs) {
+					MyDB_RecordIteratorAltPtr iter = run.getIteratorAlt();
+					if (iter->advance())
+						heap.push(iter);
+				}
+				while (!heap.empty()) {
+					MyDB_RecordIteratorAltPtr iter = heap.top();
+					heap.pop();
+					iter->getCurrent(temp);
+					heapKeys.push_back(temp->getAtt(0)->toInt());
+					if (iter->advance())
+						heap.push(iter);
+				}
+				cout << "heap " << chrono::duration <double> (chrono::steady_clock::now() - start).count() << "s, " << flush;
+
+				start = chrono::steady_clock::now();
+				MyDB_RunQueueIteratorAlt tree(comparator, lhs, rhs);
+				for (auto &run : runs) {
+					MyDB_RecordIteratorAltPtr iter = run.getIteratorAlt();
+					if (iter->advance())
+						tree.addRun(iter);
+				}
+				while (tree.advance()) {
+					tree.getCurrent(temp);
+					treeKeys.push_back(temp->getAtt(0)->toInt());
+				}
+				cout << "tree " << chrono::duration <double> (chrono::steady_clock::now() - start).count() << "s..." << flush;
+
+				result = result && heapKeys.size() == (size_t) numRuns * 100 && treeKeys == heapKeys && 
+					is_sorted(treeKeys.begin(), treeKeys.end());
+			}
+		}
+		unlink("mergeIn.bin");
+		unlink("tempFileMerge");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 24:
+	{
+		// normalized sort keys should put records in the same order as the comparator they come from, for
+		// ints, doubles and strings, ascending and descending; and sorting with them should give the same
+		// records, in the same order, as sorting without them
+		cout << "TEST 24... " << flush;
+		bool result = true;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("i", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("d", make_shared <MyDB_DoubleAttType>()));
+			mySchema->appendAtt(make_pair("s", make_shared <MyDB_StringAttType>()));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 64, "tempFileKeys");
+			MyDB_TableReaderWriter myTable(make_shared <MyDB_Table>("keysIn", "keysIn.bin", mySchema), myMgr);
+			MyDB_RecordPtr temp = myTable.getEmptyRecord();
+			unsigned seed = 17;
+			for (int i = 0; i < 50000; i++) {
+				seed = seed * 1103515245 + 12345;
+				int val = (int) ((seed >> 8) % 4000) - 2000;
+				string str = (val % 3 == 0 ? "same prefix " : "") + to_string(val * 7 % 1000);
+				temp->fromString(to_string(val) + "|" + (val == 0 ? "-0.0" : to_string(val / 7.0)) + "|" + str + "|");
+				myTable.append(temp);
+			}
+
+			// check the keys directly, on some records at the edges
+			MyDB_SortKey intKey(mySchema, "[i]", false), doubleKey(mySchema, "[d]", false), 
+				stringKey(mySchema, "[s]", false), descKey(mySchema, "[i]", true);
+			auto keyOf = [&](MyDB_SortKey &key, string rec) {
+				temp->fromString(rec);
+				vector <char> bytes(temp->getBinarySize());
+				temp->toBinary(bytes.data());
+				return key.encode(bytes.data());
+			};
+			result = keyOf(intKey, "-5|0|a|") < keyOf(intKey, "-1|0|a|") && keyOf(intKey, "-1|0|a|") < keyOf(intKey, "3|0|a|") &&
+				keyOf(descKey, "-5|0|a|") > keyOf(descKey, "3|0|a|") &&
+				keyOf(doubleKey, "0|-2.5|a|") < keyOf(doubleKey, "0|-0.5|a|") && keyOf(doubleKey, "0|-0.0|a|") == keyOf(doubleKey, "0|0.0|a|") &&
+				keyOf(doubleKey, "0|0.0|a|") < keyOf(doubleKey, "0|1e-300|a|") && keyOf(doubleKey, "0|1e-300|a|") < keyOf(doubleKey, "0|7|a|") &&
+				keyOf(stringKey, "0|0|ab|") < keyOf(stringKey, "0|0|abc|") && keyOf(stringKey, "0|0|abc|") < keyOf(stringKey, "0|0|b|") &&
+				intKey.isExact() && doubleKey.isExact() && !stringKey.isExact();
+
+			// then sort on each attribute, both ways, with and without the keys
+			MyDB_RecordPtr lhs = myTable.getEmptyRecord(), rhs = myTable.getEmptyRecord();
+			for (string att : {"[i]", "[d]", "[s]"}) {
+				for (bool descending : {false, true}) {
+					cout << att << (descending ? " desc..." : "...") << flush;
+					function <bool ()> comparator = buildRecordComparator(lhs, rhs, att, descending);
+					function <bool ()> noKeys = [comparator] {return comparator();};
+					vector <string> sorted[2];
+					for (int which = 0; which < 2; which++) {
+						MyDB_TableReaderWriter outTable(make_shared <MyDB_Table>("keysOut", "keysOut.bin", mySchema), myMgr);
+						sort(8, myTable, outTable, which == 0 ? comparator : noKeys, lhs, rhs);
+						MyDB_RecordIteratorAltPtr iter = outTable.getIteratorAlt();
+						while (iter->advance()) {
+							iter->getCurrent(temp);
+							string rec;
+							temp->appendString(rec);
+							sorted[which].push_back(rec);
+						}
+						myMgr->killTable(outTable.getTable());
+					}
+
+					// the keys of the records must come out in order, and the same records must come out
+					bool inOrder = true;
+					MyDB_RecordPtr prev = myTable.getEmptyRecord();
+					function <bool ()> outOfOrder = buildRecordComparator(temp, prev, att, descending);
+					for (size_t i = 0; i < sorted[0].size(); i++) {
+						temp->fromString(sorted[0][i]);
+						if (i > 0 && outOfOrder())
+							inOrder = false;
+						prev->fromString(sorted[0][i]);
+					}
+					std::sort(sorted[0].begin(), sorted[0].end());
+					std::sort(sorted[1].begin(), sorted[1].end());
+					result = result && inOrder && sorted[0].size() == 50000 && sorted[0] == sorted[1];
+				}
+			}
+
+			// and the page sort should put the records in the same order as well
+			MyDB_PageReaderWriter page = myTable[0];
+			function <bool ()> comparator = buildRecordComparator(lhs, rhs, "[d]", true);
+			function <bool ()> noKeys = [comparator] {return comparator();};
+			vector <string> pageSorted[2];
+			for (int which = 0; which < 2; which++) {
+				MyDB_RecordIteratorAltPtr iter = page.sort(which == 0 ? comparator : noKeys, lhs, rhs)->getIteratorAlt();
+				while (iter->advance()) {
+					iter->getCurrent(temp);
+					string rec;
+					temp->appendString(rec);
+					pageSorted[which].push_back(rec);
+				}
+			}
+			result = result && pageSorted[0].size() > 10 && pageSorted[0] == pageSorted[1];
+		}
+		unlink("keysIn.bin");
+		unlink("keysOut.bin");
+		unlink("tempFileKeys");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 25:
+	{
+		// replacement selection should give the same sorted output as sorting runSize pages at a time, with
+		// about half as many runs on random input, and a single run on input that is nearly sorted
+		cout << "TEST 25... " << flush;
+		bool result = true;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("key", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("comment", make_shared <MyDB_StringAttType>()));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 128, "tempFileRuns");
+			MyDB_TableReaderWriter randomTable(make_shared <MyDB_Table>("runsRandom", "runsRandom.bin", mySchema), myMgr);
+			MyDB_TableReaderWriter nearlySorted(make_shared <MyDB_Table>("runsNearly", "runsNearly.bin", mySchema), myMgr);
+			MyDB_RecordPtr temp = randomTable.getEmptyRecord();
+			unsigned seed = 23;
+			for (int i = 0; i < 50000; i++) {
+				seed = seed * 1103515245 + 12345;
+				temp->fromString(to_string((seed >> 8) % 100000) + "|comment " + to_string(i) + "|");
+				randomTable.append(temp);
+				temp->fromString(to_string(i * 2 + (int) ((seed >> 8) % 50)) + "|comment " + to_string(i) + "|");
+				nearlySorted.append(temp);
+			}
+
+			MyDB_RecordPtr lhs = randomTable.getEmptyRecord(), rhs = randomTable.getEmptyRecord();
+			function <bool ()> comparator = buildRecordComparator(lhs, rhs, "[key]");
+			function <bool ()> noKeys = [comparator] {return comparator();};
+
+			// sorts the table, returning the records that come out, and the number of runs built
+			auto sortAndCount = [&](MyDB_TableReaderWriter &sortMe, function <bool ()> comp, MyDB_RunGeneration how, 
+				vector <string> &out) {
+				getSortCounters() = MyDB_SortCounters();
+				MyDB_TableReaderWriter outTable(make_shared <MyDB_Table>("runsOut", "runsOut.bin", mySchema), myMgr);
+				sort(8, sortMe, outTable, comp, lhs, rhs, how);
+				vector <int> keys;
+				MyDB_RecordIteratorAltPtr iter = outTable.getIteratorAlt();
+				while (iter->advance()) {
+					iter->getCurrent(temp);
+					keys.push_back(temp->getAtt(0)->toInt());
+					string rec;
+					temp->appendString(rec);
+					out.push_back(rec);
+				}
+				myMgr->killTable(outTable.getTable());
+				result = result && is_sorted(keys.begin(), keys.end());
+				std::sort(out.begin(), out.end());
+				return getSortCounters().runsBuilt;
+			};
+
+			vector <string> loadSorted, replaced, replacedNoKeys, nearly;
+			size_t loadRuns = sortAndCount(randomTable, comparator, MyDB_RunGeneration :: LoadSort, loadSorted);
+			size_t replacedRuns = sortAndCount(randomTable, comparator, MyDB_RunGeneration :: ReplacementSelection, replaced);
+			sortAndCount(randomTable, noKeys, MyDB_RunGeneration :: ReplacementSelection, replacedNoKeys);
+			size_t nearlyRuns = sortAndCount(nearlySorted, comparator, MyDB_RunGeneration :: ReplacementSelection, nearly);
+			cout << loadRuns << " runs, " << replacedRuns << " with replacement selection, " << nearlyRuns << 
+				" if nearly sorted..." << flush;
+			result = result && loadSorted.size() == 50000 && loadSorted == replaced && replaced == replacedNoKeys &&
+				nearly.size() == 50000 && replacedRuns * 3 < loadRuns * 2 && nearlyRuns == 1;
+
+			// with only a few pages of memory, a sort should pick replacement selection on its own
+			getSortCounters() = MyDB_SortCounters();
+			MyDB_TableReaderWriter outTable(make_shared <MyDB_Table>("runsOut", "runsOut.bin", mySchema), myMgr);
+			sort(4, randomTable, outTable, comparator, lhs, rhs);
+			result = result && getSortCounters().replacementSelections == 1;
+			sort(32, randomTable, outTable, comparator, lhs, rhs);
+			result = result && getSortCounters().replacementSelections == 1;
+		}
+		unlink("runsRandom.bin");
+		unlink("runsNearly.bin");
+		unlink("runsOut.bin");
+		unlink("tempFileRuns");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 26:
+	{
+		// sorting on a date or decimal column should use the radix sort, and give the same order as sorting
+		// with the comparator; and the radix sort should give the same order as a stable sort on the keys
+		// (print the time taken by each, for 1M and 10M keys)
+		cout << "TEST 26... " << flush;
+		bool result = true;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("day", make_shared <MyDB_DateAttType>()));
+			mySchema->appendAtt(make_pair("price", make_shared <MyDB_DecimalAttType>(12, 2)));
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(4096, 64, "tempFileRadix");
+			MyDB_TableReaderWriter myTable(make_shared <MyDB_Table>("radixIn", "radixIn.bin", mySchema), myMgr);
+			MyDB_RecordPtr temp = myTable.getEmptyRecord();
+			unsigned seed = 29;
+			for (int i = 0; i < 20000; i++) {
+				seed = seed * 1103515245 + 12345;
+				int cents = (int) ((seed >> 8) % 200000) - 100000;
+				temp->fromString(MyDB_DateAttVal::format(8000 + (seed >> 12) % 5000) + "|" + (cents < 0 ? "-" : "") + 
+					to_string(abs(cents) / 100) + "." + to_string(abs(cents) % 100 / 10) + to_string(abs(cents) % 10) + "|");
+				myTable.append(temp);
+			}
+
+			MyDB_RecordPtr lhs = myTable.getEmptyRecord(), rhs = myTable.getEmptyRecord();
+			for (string att : {"[day]", "[price]"}) {
+				cout << att << "..." << flush;
+				MyDB_SortKey sortKey(mySchema, att, false);
+				function <bool ()> comparator = buildRecordComparator(lhs, rhs, att);
+				function <bool ()> noKeys = [comparator] {return comparator();};
+				vector <string> sorted[2], keys[2];
+				for (int which = 0; which < 2; which++) {
+					MyDB_TableReaderWriter outTable(make_shared <MyDB_Table>("radixOut", "radixOut.bin", mySchema), myMgr);
+					sort(64, myTable, outTable, which == 0 ? comparator : noKeys, lhs, rhs, MyDB_RunGeneration :: LoadSort);
+					MyDB_RecordIteratorAltPtr iter = outTable.getIteratorAlt();
+					while (iter->advance()) {
+						iter->getCurrent(temp);
+						string rec;
+						temp->appendString(rec);
+						sorted[which].push_back(rec);
+						keys[which].push_back(temp->getAtt(att == "[day]" ? 0 : 1)->toString());
+					}
+					myMgr->killTable(outTable.getTable());
+					std::sort(sorted[which].begin(), sorted[which].end());
+				}
+				result = result && sortKey.isExact() && sorted[0].size() == 20000 && sorted[0] == sorted[1] && keys[0] == keys[1];
+			}
+
+			// and then the microbenchmark, on int keys
+			for (size_t numKeys = 1000000; numKeys <= 10000000; numKeys *= 10) {
+				vector <MyDB_KeyedRecord> keys(numKeys);
+				for (size_t i = 0; i < numKeys; i++) {
+					seed = seed * 1103515245 + 12345;
+					keys[i].key = ((uint64_t) (seed ^ 0x80000000u)) << 32;
+					keys[i].rec = (void *) i;
+				}
+				vector <MyDB_KeyedRecord> radixSorted = keys;
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				radixSort(radixSorted);
+				double radixSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count();
+
+				start = chrono::steady_clock::now();
+				std::stable_sort(keys.begin(), keys.end(), [](const MyDB_KeyedRecord &a, const MyDB_KeyedRecord &b) {
+					return a.key < b.key;
+				});
+				double stableSecs = chrono::duration <double> (chrono::steady_clock::now() - start).count();
+				cout << numKeys << " keys: radix " << radixSecs << "s, stable_sort " << stableSecs << "s..." << flush;
+
+				for (size_t i = 0; i < numKeys; i++)
+					result = result && keys[i].key == radixSorted[i].key && keys[i].rec == radixSorted[i].rec;
+			}
+		}
+		unlink("radixIn.bin");
+		unlink("radixOut.bin");
+		unlink("tempFileRadix");
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
+	case 27:
+	{
+		// a compiled computation has to see attributes that were set directly (and not by loading the record)
+		// since its last evaluation, including through records built from the one that was changed
+		cout << "TEST 27... " << flush;
+		bool result = true;
+		{
+			MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema>();
+			mySchema->appendAtt(make_pair("a", make_shared <MyDB_IntAttType>()));
+			mySchema->appendAtt(make_pair("b", make_shared <MyDB_IntAttType>()));
+			MyDB_RecordPtr temp = make_shared <MyDB_Record>(mySchema);
+			temp->fromString("1|2|");
+
+			// the shared sum is still done only once per evaluation
+			func sum = temp->compileComputation("+ (+ ([a], [b]), + ([a], [b]))");
+			size_t evalsBefore = temp->getNumEvals();
+			result = result && sum()->toInt() == 6 && temp->getNumEvals() - evalsBefore == 2;
+			static_pointer_cast <MyDB_IntAttVal> (temp->getAtt(0))->set(10);
+			result = result && sum()->toInt() == 24;
+			MyDB_IntAttValPtr five = make_shared <MyDB_IntAttVal>();
+			five->set(5);
+			temp->getAtt(1)->set(five);
+			result = result && sum()->toInt() == 30;
+
+			// one record that is part of two others
+			MyDB_SchemaPtr otherSchema = make_shared <MyDB_Schema>();
+			otherSchema->appendAtt(make_pair("c", make_shared <MyDB_IntAttType>()));
+			MyDB_SchemaPtr bothSchema = make_shared <MyDB_Schema>();
+			for (auto &att : mySchema->getAtts())
+				bothSchema->appendAtt(att);
+			bothSchema->appendAtt(make_pair("c", make_shared <MyDB_IntAttType>()));
+			MyDB_RecordPtr right1 = make_shared <MyDB_Record>(otherSchema), right2 = make_shared <MyDB_Record>(otherSchema);
+			right1->fromString("100|");
+			right2->fromString("1000|");
+			MyDB_RecordPtr both1 = make_shared <MyDB_Record>(bothSchema), both2 = make_shared <MyDB_Record>(bothSchema);
+			both1->buildFrom(temp, right1);
+			both2->buildFrom(temp, right2);
+			func sum1 = both1->compileComputation("+ (+ ([a], [c]), + ([a], [c]))");
+			func sum2 = both2->compileComputation("+ (+ ([a], [c]), + ([a], [c]))");
+			result = result && sum1()->toInt() == 220 && sum2()->toInt() == 2020;
+			temp->fromString("3|2|");
+			result = result && sum1()->toInt() == 206 && sum2()->toInt() == 2006;
+			static_pointer_cast <MyDB_IntAttVal> (temp->getAtt(0))->set(4);
+			result = result && sum1()->toInt() == 208 && sum2()->toInt() == 2008;
+		}
+
+		if (result) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(result);
+	}
+	FALLTHROUGH_INTENDED;
 	default:
 		break;
 	}
@@ -20,6 +20,7 @@
 #include "RegularSelection.h"
 #include "ScanJoin.h"
 #include "SortMergeJoin.h"
+#include "TopN.h"
 #include <iostream>
 #include <vector>
 #include <utility>
@@ -425,6 +426,86 @@ int main () {
 		}
 	}
 
+	{
+		// the output has the same schema as the input
+		MyDB_TablePtr myTableOut = make_shared <MyDB_Table> ("supplierOut", "supplierOut.bin", mySchemaL);
+		MyDB_TableReaderWriterPtr supplierTableOut = make_shared <MyDB_TableReaderWriter> (myTableOut, myMgr);
+
+		// This basically runs:
+		//
+		// SELECT *
+		// FROM supplierLeft
+		// ORDER BY supplierLeft.l_acctbal DESC
+		// LIMIT 5
+		//
+		// The five records fit easily in the pinned pages, so nothing is spilled
+		vector <pair <string, bool>> orderBy;
+		orderBy.push_back (make_pair (string ("[l_acctbal]"), true));
+		TopN myOp (supplierTableL, supplierTableOut, orderBy, 5, 4);
+		cout << "running top n\n";
+		myOp.run ();
+
+		cout << "\nThis should have run in memory: " << (myOp.ranInMemory () ? "it did" : "it did not") << "\n";
+		cout << "The output should be the five suppliers with the largest account balances, starting with\n";
+		cout << "the one that a full sort on l_acctbal DESC puts first:\n";
+		MyDB_TablePtr sortedTable = make_shared <MyDB_Table> ("sortedOut", "sortedOut.bin", mySchemaL);
+		MyDB_TableReaderWriter sortedTableOut (sortedTable, myMgr);
+		MyDB_RecordPtr lhs = supplierTableL->getEmptyRecord ();
+		MyDB_RecordPtr rhs = supplierTableL->getEmptyRecord ();
+		sort (4, *supplierTableL, sortedTableOut, buildRecordComparator (lhs, rhs, "[l_acctbal]", true), lhs, rhs);
+                MyDB_RecordPtr temp = supplierTableOut->getEmptyRecord ();
+                MyDB_RecordIteratorAltPtr myIter = sortedTableOut.getIteratorAlt ();
+		if (myIter->advance ()) {
+                        myIter->getCurrent (temp);
+			cout << temp << "\n";
+		}
+		cout << "\nHere goes:\n";
+                myIter = supplierTableOut->getIteratorAlt ();
+                while (myIter->advance ()) {
+                        myIter->getCurrent (temp);
+			cout << temp << "\n";
+		}
+	}
+
+	{
+		MyDB_TablePtr myTableOut = make_shared <MyDB_Table> ("supplierOut", "supplierOut.bin", mySchemaL);
+		MyDB_TableReaderWriterPtr supplierTableOut = make_shared <MyDB_TableReaderWriter> (myTableOut, myMgr);
+
+		// This basically runs:
+		//
+		// SELECT *
+		// FROM supplierLeft
+		// ORDER BY supplierLeft.l_nationkey, supplierLeft.l_acctbal DESC
+		// LIMIT 2000
+		//
+		// Two thousand records do not fit in a single pinned page, so this falls back to the external sort
+		vector <pair <string, bool>> orderBy;
+		orderBy.push_back (make_pair (string ("[l_nationkey]"), false));
+		orderBy.push_back (make_pair (string ("[l_acctbal]"), true));
+		TopN myOp (supplierTableL, supplierTableOut, orderBy, 2000, 2);
+		cout << "running top n\n";
+		myOp.run ();
+
+		cout << "\nThis should not have run in memory: " << (myOp.ranInMemory () ? "it did" : "it did not") << "\n";
+		cout << "Now we check the order.";
+		cout << "\nThe output should be 2000 records, and 0 out of order:\n";
+                MyDB_RecordPtr temp = supplierTableOut->getEmptyRecord ();
+                MyDB_RecordIteratorAltPtr myIter = supplierTableOut->getIteratorAlt ();
+		int count = 0, outOfOrder = 0, lastNation = -1;
+		double lastBal = 0;
+                while (myIter->advance ()) {
+                        myIter->getCurrent (temp);
+			int nation = temp->getAtt (3)->toInt ();
+			double bal = temp->getAtt (5)->toDouble ();
+			if (nation < lastNation || (nation == lastNation && bal > lastBal))
+				outOfOrder++;
+			lastNation = nation;
+			lastBal = bal;
+			count++;
+		}
+		cout << count << " records, " << outOfOrder << " out of order\n";
+	}
+
 	{
 		// get the output schema and table
 		MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
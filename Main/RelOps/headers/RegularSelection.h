@@ -23,8 +23,9 @@ public:
 	RegularSelection (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
 		string selectionPredicate, vector <string> projections);
 	
-	// execute the selection operation
-	void run ();
+	// execute the selection operation; this is a parallel scan, run using the given number of
+	// worker threads (zero means one per core)
+	void run (size_t numThreads = 0);
 
 private:
 
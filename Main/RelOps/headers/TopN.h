@@ -0,0 +1,64 @@
+
+#ifndef TOP_N_H
+#define TOP_N_H
+
+#include "MyDB_TableReaderWriter.h"
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// the limit given to a TopN that is just an ORDER BY
+#define TOP_N_NO_LIMIT SIZE_MAX
+
+// This class encapsulates an ORDER BY ... LIMIT.  The first limit records of the input (in the
+// given order) are kept in a bounded heap, in pinned pages; only a record that beats the worst
+// record in the heap is ever copied.  If the records in the heap do not fit in the pinned pages
+// that the operation is allowed to use, it falls back to an external sort, and only merges the
+// sorted runs until it has the first limit records.
+
+class TopN {
+
+public:
+	//
+	// Records are read from input, and the first limit records are written to output (which has
+	// the same schema as input), in order.
+	//
+	// The parameter orderBy lists the computations to order on, most significant first, each with
+	// true if the order is descending.  For example:
+	//
+	// <("[att1]", false), ("+ ([att2], [att3])", true)>
+	//
+	// corresponds to ORDER BY att1, att2 + att3 DESC.  A limit of TOP_N_NO_LIMIT gives a plain ORDER BY.
+	//
+	// numPages is the number of pinned pages the heap can use; it is also the run size for the
+	// external sort, if there is one.
+	//
+	TopN (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <string, bool>> orderBy, size_t limit, int numPages);
+
+	// execute the operation
+	void run ();
+
+	// true if the last call to run () kept all of the records it needed in memory, and false if
+	// it had to fall back to an external sort
+	bool ranInMemory ();
+
+private:
+
+	// builds a function that returns true if lhs comes before rhs in the order
+	function <bool ()> buildComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
+
+	// tries to find the first limit records using a heap in pinned pages, writing them to the
+	// output; returns false (and writes nothing) if they do not fit
+	bool runInMemory (function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
+
+	MyDB_TableReaderWriterPtr input;
+	MyDB_TableReaderWriterPtr output;
+	vector <pair <string, bool>> orderBy;
+	size_t limit;
+	int numPages;
+	bool inMemory;
+};
+
+#endif
@@ -30,18 +30,34 @@ void Aggregate :: run () {
 		return;
 	}
 
+	// get an input rec, so that we can figure out the types of the aggregates
+	MyDB_RecordPtr inputRec = input->getEmptyRecord ();
+
 	// first, we create a schema for the aggregate records... this is all grouping atts,
-	// followed by all aggregate atts, followed by the count att
+	// followed by all aggregate atts, followed by the count att.  A sum (or average) of
+	// decimals is accumulated exactly, in a wide decimal with the same scale as its input
 	MyDB_SchemaPtr aggSchema = make_shared <MyDB_Schema> ();
+	vector <bool> exactSum;
 	int i = 0;
 	int numGroups = groupings.size ();
 	for (auto &a : output->getTable ()->getSchema ()->getAtts ()) {
-		if (i < numGroups) 
+		if (i < numGroups) {
 			aggSchema->appendAtt (make_pair ("MyDB_GroupAtt" + to_string (i++), a.second));
-		else
+			continue;
+		}
+		auto &agg = aggsToCompute[i - numGroups];
+		MyDB_AttTypePtr inputType = agg.first == MyDB_AggType :: cnt ? nullptr : inputRec->getType (agg.second);
+		exactSum.push_back (inputType != nullptr && inputType->isDecimal ());
+		if (exactSum.back ()) {
+			int scale = static_pointer_cast <MyDB_DecimalAttType> (inputType)->getScale ();
+			aggSchema->appendAtt (make_pair ("MyDB_AggAtt" + to_string (i++ - numGroups), 
+				make_shared <MyDB_DecimalAttType> (MyDB_MAX_WIDE_DIGITS, scale)));
+		} else {
 			aggSchema->appendAtt (make_pair ("MyDB_AggAtt" + to_string (i++ - numGroups), a.second));
+		}
 	}
 	aggSchema->appendAtt (make_pair ("MyDB_CntAtt", make_shared <MyDB_IntAttType> ()));
+	exactSum.push_back (false);
 
 	// now, create the schema for the combined records
 	MyDB_SchemaPtr combinedSchema = make_shared <MyDB_Schema> ();
@@ -50,8 +66,7 @@ void Aggregate :: run () {
 	for (auto &a : aggSchema->getAtts ())
 		combinedSchema->appendAtt (a);
 
-	// now, get an intput rec, an agg rec, and a combined rec
-	MyDB_RecordPtr inputRec = input->getEmptyRecord ();
+	// now, get an agg rec, and a combined rec
 	MyDB_RecordPtr aggRec = make_shared <MyDB_Record> (aggSchema);
 	MyDB_RecordPtr combinedRec = make_shared <MyDB_Record> (combinedSchema);
 	combinedRec->buildFrom (inputRec, aggRec);
@@ -99,7 +114,9 @@ void Aggregate :: run () {
 
 	i = 0;
 	for (auto &s : aggsToCompute) {
-		if (s.first == MyDB_AggType :: sum || s.first == MyDB_AggType :: avg) {
+		if (exactSum[i]) {
+			aggComps.push_back (combinedRec->compileComputation (s.second));
+		} else if (s.first == MyDB_AggType :: sum || s.first == MyDB_AggType :: avg) {
 			aggComps.push_back (combinedRec->compileComputation ("+ (" + s.second + 
 				", [MyDB_AggAtt" + to_string (i) + "])"));
 		} else if (s.first == MyDB_AggType :: cnt) {
@@ -118,80 +135,96 @@ void Aggregate :: run () {
 	// and this runs the selection on the input records
 	func inputPred = inputRec->compileComputation (selectionPredicate);
 
+	// only the attributes used by the predicate, the groupings, and the aggregates are read from each input record
+	vector <string> allComps = groupings;
+	for (auto &s : aggsToCompute)
+		allComps.push_back (s.second);
+	allComps.push_back (selectionPredicate);
+	inputRec->narrowTo (inputRec->getReferencedAtts (allComps));
+
 	// at this point, we are ready to go!!
-	MyDB_RecordIteratorPtr myIter = input->getIterator (inputRec);
+	MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt ();
+	MyDB_RecordBatch batch;
 	MyDB_AttValPtr zero = make_shared <MyDB_IntAttVal> ();
-	while (myIter->hasNext ()) {
+	while (myIter->nextBatch (batch)) {
+		for (size_t r = 0; r < batch.size (); r++) {
 
-		myIter->getNext ();
+			inputRec->fromBinary (batch[r]);
 
-		// see if it is accepted by the preicate
-		if (!inputPred ()->toBool ()) {
-			continue;
-		}
+			// see if it is accepted by the preicate
+			if (!inputPred ()->toBool ()) {
+				continue;
+			}
 
-		// hash the current record
-		size_t hashVal = 0;
-		for (auto &f : groupingComps) {
-			hashVal ^= f ()->hash ();
-		}
+			// hash the current record
+			size_t hashVal = 0;
+			for (auto &f : groupingComps) {
+				hashVal = MyDB_hashCombine (hashVal, f ()->hash ());
+			}
 
-		// if there is a match, then get the list of matches
-		vector <void *> &potentialMatches = myHash [hashVal];
-		void *loc = nullptr;
+			// if there is a match, then get the list of matches
+			vector <void *> &potentialMatches = myHash [hashVal];
+			void *loc = nullptr;
 
-		// and iterate though the potential matches, checking each of them
-		for (auto &v : potentialMatches) {	
+			// and iterate though the potential matches, checking each of them
+			for (auto &v : potentialMatches) {	
 
-			aggRec->fromBinary (v);
+				aggRec->fromBinary (v);
 
-			// check to see if it matches
-			if (!checkGroups ()->toBool ()) {
-				continue;
+				// check to see if it matches
+				if (!checkGroups ()->toBool ()) {
+					continue;
+				}
+
+				loc = v;
+				break;
 			}
 
-			loc = v;
-			break;
-		}
+			// if we did not find a match...
+			if (loc == nullptr) {
 
-		// if we did not find a match...
-		if (loc == nullptr) {
+				// set up the record...
+				i = 0;
+				for (auto &f : groupingComps) {
+					aggRec->getAtt (i++)->set (f ());
+				}
+				for (int j = 0; j < aggComps.size (); j++) {
+					aggRec->getAtt (i++)->set (zero);
+				}
+			}
 
-			// set up the record...
+			// update each of the aggregates; exact sums are added to in place
 			i = 0;
-			for (auto &f : groupingComps) {
-				aggRec->getAtt (i++)->set (f ());
-			}
-			for (int j = 0; j < aggComps.size (); j++) {
-				aggRec->getAtt (i++)->set (zero);
+			for (auto &f : aggComps) {
+				if (exactSum[i]) {
+					MyDB_DecimalAttVal *sum = static_cast <MyDB_DecimalAttVal *> (aggRec->getAtt (numGroups + i).get ());
+					sum->add (static_cast <MyDB_DecimalAttVal *> (f ().get ())->getDecimal ());
+				} else {
+					aggRec->getAtt (numGroups + i)->set (f ());
+				}
+				i++;
 			}
-		}
-
-		// update each of the aggregates
-		i = 0;
-		for (auto &f : aggComps) {
-			aggRec->getAtt (numGroups + i++)->set (f ());
-		}
-
-		// if we did not find a match, write to a new location...
-		aggRec->recordContentHasChanged ();
-		if (loc == nullptr) {
-			loc = lastPage.appendAndReturnLocation (aggRec);
 
-			// if we could not write, then the page was full
+			// if we did not find a match, write to a new location...
+			aggRec->recordContentHasChanged ();
 			if (loc == nullptr) {
-				MyDB_PageReaderWriter nextPage (true, *(input->getBufferMgr ()));
-				lastPage = nextPage;
-				allPages.push_back (lastPage);
-				loc = lastPage.appendAndReturnLocation (aggRec);	
+				loc = lastPage.appendAndReturnLocation (aggRec);
+
+				// if we could not write, then the page was full
+				if (loc == nullptr) {
+					MyDB_PageReaderWriter nextPage (true, *(input->getBufferMgr ()));
+					lastPage = nextPage;
+					allPages.push_back (lastPage);
+					loc = lastPage.appendAndReturnLocation (aggRec);	
+				}
+
+				aggRec->fromBinary (loc);
+				myHash [hashVal].push_back (loc);
+
+			// otherwise, re-write to the old location
+			} else {
+				aggRec->toBinary (loc);
 			}
-
-			aggRec->fromBinary (loc);
-			myHash [hashVal].push_back (loc);
-
-		// otherwise, re-write to the old location
-		} else {
-			aggRec->toBinary (loc);
 		}
 	}
 
@@ -200,21 +233,23 @@ void Aggregate :: run () {
 
 	// loop through all of the aggregate records
 	MyDB_RecordPtr outRec = output->getEmptyRecord ();
-	while (myIterAgain->advance ()) {
+	while (myIterAgain->nextBatch (batch)) {
+		for (size_t r = 0; r < batch.size (); r++) {
 
-		myIterAgain->getCurrent (aggRec);
+			aggRec->fromBinary (batch[r]);
 
-		// set the grouping atts
-		for (i = 0; i < numGroups; i++) {
-			outRec->getAtt (i)->set (aggRec->getAtt (i));
-		}
+			// set the grouping atts
+			for (i = 0; i < numGroups; i++) {
+				outRec->getAtt (i)->set (aggRec->getAtt (i));
+			}
 
-		// set the aggregate atts
-		for (auto &a : finalAggComps) {
-			outRec->getAtt (i++)->set (a ());
+			// set the aggregate atts
+			for (auto &a : finalAggComps) {
+				outRec->getAtt (i++)->set (a ());
+			}
+			outRec->recordContentHasChanged ();
+			output->append (outRec);
 		}
-		outRec->recordContentHasChanged ();
-		output->append (outRec);
 	}
 }
 
@@ -3,6 +3,7 @@
 #define BPLUS_SELECTION_C
 
 #include "BPlusSelection.h"
+#include "MyDB_ParallelScan.h"
 
 BPlusSelection :: BPlusSelection (MyDB_BPlusTreeReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
                 MyDB_AttValPtr lowIn, MyDB_AttValPtr highIn,
@@ -16,38 +17,61 @@ BPlusSelection :: BPlusSelection (MyDB_BPlusTreeReaderWriterPtr inputIn, MyDB_Ta
 	projections = projectionsIn;
 }
 
-void BPlusSelection :: run () {
+void BPlusSelection :: run (size_t numThreads) {
 
-	MyDB_RecordPtr inputRec = input->getEmptyRecord ();
-	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
+	// each worker thread compiles its own copy of the computations, over its own records
+	string keyAtt = "[" + input->getOrderingAtt () + "]";
+	auto buildPipeline = [this, keyAtt] () -> MyDB_MorselPipeline {
+
+		MyDB_RecordPtr inputRec = input->getEmptyRecord ();
+		MyDB_RecordPtr outputRec = output->getEmptyRecord ();
 	
-	// compile all of the coputations that we need here
-	vector <func> finalComputations;
-	for (string s : projections) {
-		finalComputations.push_back (inputRec->compileComputation (s));
-	}
-	func pred = inputRec->compileComputation (selectionPredicate);
-
-	// now, iterate through the B+-tree query results
-	MyDB_RecordIteratorAltPtr myIter = input->getRangeIteratorAlt (low, high);
-	while (myIter->advance ()) {
-
-		myIter->getCurrent (inputRec);
-
-		// see if it is accepted by the predicate
-		if (!pred()->toBool ()) {
-			continue;
+		// compile all of the coputations that we need here
+		vector <func> finalComputations;
+		for (string s : projections) {
+			finalComputations.push_back (inputRec->compileComputation (s));
 		}
+		func pred = inputRec->compileComputation (selectionPredicate);
 
-		// run all of the computations
-		int i = 0;
-		for (auto &f : finalComputations) {
-			outputRec->getAtt (i++)->set (f());
-		}
+		// a leaf page may have records outside of the range, so these are filtered out first
+		function <bool ()> inRange = input->buildRangeCheck (inputRec, low, high);
+
+		// only the attributes that the range check, the predicate, and the projections use are read out of each record
+		vector <string> allComps = projections;
+		allComps.push_back (selectionPredicate);
+		allComps.push_back (keyAtt);
+		inputRec->narrowTo (inputRec->getReferencedAtts (allComps));
+
+		// and this runs the selection over one morsel
+		return [=] (MyDB_Morsel &morsel) {
+			char *end = morsel.records.data () + morsel.records.size ();
+			for (char *pos = morsel.records.data (); pos < end; ) {
+
+				pos = (char *) inputRec->fromBinary (pos);
+
+				// see if it is accepted by the predicate
+				if (!inRange () || !pred()->toBool ()) {
+					continue;
+				}
+
+				// run all of the computations
+				int i = 0;
+				for (auto &f : finalComputations) {
+					outputRec->getAtt (i++)->set (f());
+				}
+
+				outputRec->recordContentHasChanged ();
+				size_t at = morsel.output.size ();
+				morsel.output.resize (at + outputRec->getBinarySize ());
+				outputRec->toBinary (&morsel.output[at]);
+			}
+		};
+	};
 
-		outputRec->recordContentHasChanged ();
-		output->append (outputRec);
-	}
+	// the leaf pages that can hold records in the range are scanned in parallel
+	vector <MyDB_PageReaderWriter> pages = input->getRangePages (low, high);
+	MyDB_ParallelScan myScan (pages);
+	myScan.run (buildPipeline, *output, numThreads);
 }
 
 #endif
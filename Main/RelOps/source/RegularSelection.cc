@@ -3,6 +3,7 @@
 #define REG_SELECTION_C
 
 #include "RegularSelection.h"
+#include "MyDB_ParallelScan.h"
 
 RegularSelection :: RegularSelection (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
                 string selectionPredicateIn, vector <string> projectionsIn) {
@@ -13,38 +14,54 @@ RegularSelection :: RegularSelection (MyDB_TableReaderWriterPtr inputIn, MyDB_Ta
 	projections = projectionsIn;
 }
 
-void RegularSelection :: run () {
+void RegularSelection :: run (size_t numThreads) {
 
-	MyDB_RecordPtr inputRec = input->getEmptyRecord ();
-	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
+	// each worker thread compiles its own copy of the computations, over its own records
+	auto buildPipeline = [this] () -> MyDB_MorselPipeline {
+
+		MyDB_RecordPtr inputRec = input->getEmptyRecord ();
+		MyDB_RecordPtr outputRec = output->getEmptyRecord ();
 	
-	// compile all of the coputations that we need here
-	vector <func> finalComputations;
-	for (string s : projections) {
-		finalComputations.push_back (inputRec->compileComputation (s));
-	}
-	func pred = inputRec->compileComputation (selectionPredicate);
-
-	// now, iterate through the B+-tree query results
-	MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt ();
-	while (myIter->advance ()) {
-
-		myIter->getCurrent (inputRec);
-
-		// see if it is accepted by the predicate
-		if (!pred()->toBool ()) {
-			continue;
+		// compile all of the coputations that we need here
+		vector <func> finalComputations;
+		for (string s : projections) {
+			finalComputations.push_back (inputRec->compileComputation (s));
 		}
+		func pred = inputRec->compileComputation (selectionPredicate);
 
-		// run all of the computations
-		int i = 0;
-		for (auto &f : finalComputations) {
-			outputRec->getAtt (i++)->set (f());
-		}
+		// only the attributes that the predicate and the projections use are read out of each record
+		vector <string> allComps = projections;
+		allComps.push_back (selectionPredicate);
+		inputRec->narrowTo (inputRec->getReferencedAtts (allComps));
+
+		// and this runs the selection over one morsel
+		return [=] (MyDB_Morsel &morsel) {
+			char *end = morsel.records.data () + morsel.records.size ();
+			for (char *pos = morsel.records.data (); pos < end; ) {
+
+				pos = (char *) inputRec->fromBinary (pos);
+
+				// see if it is accepted by the predicate
+				if (!pred()->toBool ()) {
+					continue;
+				}
+
+				// run all of the computations
+				int i = 0;
+				for (auto &f : finalComputations) {
+					outputRec->getAtt (i++)->set (f());
+				}
+
+				outputRec->recordContentHasChanged ();
+				size_t at = morsel.output.size ();
+				morsel.output.resize (at + outputRec->getBinarySize ());
+				outputRec->toBinary (&morsel.output[at]);
+			}
+		};
+	};
 
-		outputRec->recordContentHasChanged ();
-		output->append (outputRec);
-	}
+	MyDB_ParallelScan myScan (*input);
+	myScan.run (buildPipeline, *output, numThreads);
 }
 
 #endif
@@ -76,27 +76,41 @@ void ScanJoin :: run () {
 	// now get the predicate
 	func leftPred = leftInputRec->compileComputation (leftSelectionPredicate);
 
+	// only the attributes that some computation uses are read out of the records on either side
+	vector <string> leftComps = projections;
+	leftComps.push_back (finalSelectionPredicate);
+	vector <string> rightComps = leftComps;
+	for (auto &p : equalityChecks) {
+		leftComps.push_back (p.first);
+		rightComps.push_back (p.second);
+	}
+	leftComps.push_back (leftSelectionPredicate);
+	rightComps.push_back (rightSelectionPredicate);
+	leftInputRec->narrowTo (leftInputRec->getReferencedAtts (leftComps));
+
 	// add all of the records to the hash table
 	MyDB_RecordIteratorAltPtr myIter = getIteratorAlt (allData);
+	MyDB_RecordBatch batch;
+	while (myIter->nextBatch (batch)) {
+		for (size_t r = 0; r < batch.size (); r++) {
 
-	while (myIter->advance ()) {
+			// hash the current record
+			leftInputRec->fromBinary (batch[r]);
 
-		// hash the current record
-		myIter->getCurrent (leftInputRec);
+			// see if it is accepted by the preicate
+			if (!leftPred ()->toBool ()) {
+				continue;
+			}
 
-		// see if it is accepted by the preicate
-		if (!leftPred ()->toBool ()) {
-			continue;
-		}
+			// compute its hash
+			size_t hashVal = 0;
+			for (auto &f : leftEqualities) {
+				hashVal = MyDB_hashCombine (hashVal, f ()->hash ());
+			}
 
-		// compute its hash
-		size_t hashVal = 0;
-		for (auto &f : leftEqualities) {
-			hashVal ^= f ()->hash ();
+			// see if it is in the hash table
+			myHash [hashVal].push_back (batch[r]);
 		}
-
-		// see if it is in the hash table
-		myHash [hashVal].push_back (myIter->getCurrentPointer ());
 	}
 
 	// and now we iterate through the other table
@@ -110,6 +124,7 @@ void ScanJoin :: run () {
 
 	// now get the predicate
 	func rightPred = rightInputRec->compileComputation (rightSelectionPredicate);
+	rightInputRec->narrowTo (rightInputRec->getReferencedAtts (rightComps));
 
 	// and get the schema that results from combining the left and right records
 	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
@@ -135,53 +150,55 @@ void ScanJoin :: run () {
 	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
 	
 	// now, iterate through the right table
-	MyDB_RecordIteratorPtr myIterAgain = rightTable->getIterator (rightInputRec);
-	while (myIterAgain->hasNext ()) {
+	MyDB_RecordIteratorAltPtr myIterAgain = rightTable->getIteratorAlt ();
+	while (myIterAgain->nextBatch (batch)) {
+		for (size_t r = 0; r < batch.size (); r++) {
 
-		myIterAgain->getNext ();
+			rightInputRec->fromBinary (batch[r]);
 
-		// see if it is accepted by the preicate
-		if (!rightPred ()->toBool ()) {
-			continue;
-		}
+			// see if it is accepted by the preicate
+			if (!rightPred ()->toBool ()) {
+				continue;
+			}
 
-		// hash the current record
-		size_t hashVal = 0;
-		for (auto &f : rightEqualities) {
-			hashVal ^= f ()->hash ();
-		}
+			// hash the current record
+			size_t hashVal = 0;
+			for (auto &f : rightEqualities) {
+				hashVal = MyDB_hashCombine (hashVal, f ()->hash ());
+			}
 
-		// get the list of potential matches... first verify that there IS
-		// a match in there
-		if (myHash.count (hashVal) == 0) {
-			continue;
-		}
+			// get the list of potential matches... first verify that there IS
+			// a match in there
+			if (myHash.count (hashVal) == 0) {
+				continue;
+			}
 
-		// if there is a match, then get the list of matches
-		vector <void *> &potentialMatches = myHash [hashVal];
+			// if there is a match, then get the list of matches
+			vector <void *> &potentialMatches = myHash [hashVal];
 		
-		// and iterate though the potential matches, checking each of them
-		for (auto &v : potentialMatches) {
-
-			// build the combined record
-			leftInputRec->fromBinary (v);
-
-			// check to see if it is accepted by the join predicate
-			if (finalPredicate ()->toBool ()) {
-
-				// run all of the computations
-				int i = 0;
-				for (auto &f : finalComputations) {
-					outputRec->getAtt (i++)->set (f());
+			// and iterate though the potential matches, checking each of them
+			for (auto &v : potentialMatches) {
+
+				// build the combined record
+				leftInputRec->fromBinary (v);
+
+				// check to see if it is accepted by the join predicate
+				if (finalPredicate ()->toBool ()) {
+
+					// run all of the computations
+					int i = 0;
+					for (auto &f : finalComputations) {
+						outputRec->getAtt (i++)->set (f());
+					}
+
+					// the record's content has changed because it 
+					// is now a composite of two records whose content
+					// has changed via a read... we have to tell it this,
+					// or else the record's internal buffer may cause it
+					// to write old values
+					outputRec->recordContentHasChanged ();
+					output->append (outputRec);	
 				}
-
-				// the record's content has changed because it 
-				// is now a composite of two records whose content
-				// has changed via a read... we have to tell it this,
-				// or else the record's internal buffer may cause it
-				// to write old values
-				outputRec->recordContentHasChanged ();
-				output->append (outputRec);	
 			}
 		}
 	}
@@ -0,0 +1,195 @@
+
+#ifndef TOP_N_CC
+#define TOP_N_CC
+
+#include <algorithm>
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_SortKey.h"
+#include "MyDB_TableReaderWriter.h"
+#include "Sorting.h"
+#include <string.h>
+#include "TopN.h"
+
+using namespace std;
+
+// the pinned pages that the heap keeps its records in.  The pages are split into two halves; records are
+// copied into one half until it fills, and then the records that are still in the heap are copied over
+// into the other half, leaving behind the ones that have been pushed out
+class TopNArena {
+
+public:
+
+	TopNArena (MyDB_BufferManagerPtr mgr, int numPages) {
+		pageSize = mgr->getPageSize ();
+		for (int i = 0; i < max (1, numPages / 2); i++) {
+			halves[0].push_back (mgr->getPinnedPage ());
+			halves[1].push_back (mgr->getPinnedPage ());
+		}
+		which = 0;
+		page = 0;
+		used = 0;
+	}
+
+	// copies the record at the given address into the arena; the records in the heap are moved if
+	// the arena has to be compacted.  Returns nullptr if there is no room, even after compacting
+	void *copyIn (void *rec, vector <MyDB_KeyedRecord> &heap) {
+		size_t len = *((short *) rec);
+		char *res = allocate (len);
+		if (res == nullptr) {
+			if (!compact (heap))
+				return nullptr;
+			res = allocate (len);
+			if (res == nullptr)
+				return nullptr;
+		}
+		memcpy (res, rec, len);
+		return res;
+	}
+
+private:
+
+	// bump allocates len bytes in the current half, or returns nullptr if it is full
+	char *allocate (size_t len) {
+		if (len > pageSize)
+			return nullptr;
+		if (used + len > pageSize) {
+			page++;
+			used = 0;
+		}
+		if (page == halves[which].size ())
+			return nullptr;
+		char *res = ((char *) halves[which][page]->getBytes ()) + used;
+		used += len;
+		return res;
+	}
+
+	// moves the records in the heap over to the other half; returns false if they do not fit
+	bool compact (vector <MyDB_KeyedRecord> &heap) {
+		which = 1 - which;
+		page = 0;
+		used = 0;
+		for (MyDB_KeyedRecord &rec : heap) {
+			size_t len = *((short *) rec.rec);
+			char *to = allocate (len);
+			if (to == nullptr)
+				return false;
+			memcpy (to, rec.rec, len);
+			rec.rec = to;
+		}
+		return true;
+	}
+
+	vector <MyDB_PageHandle> halves[2];
+	size_t pageSize;
+	int which;
+	size_t page;
+	size_t used;
+};
+
+TopN :: TopN (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+	vector <pair <string, bool>> orderByIn, size_t limitIn, int numPagesIn) {
+
+	input = inputIn;
+	output = outputIn;
+	orderBy = orderByIn;
+	limit = limitIn;
+	numPages = numPagesIn;
+	inMemory = false;
+}
+
+bool TopN :: ranInMemory () {
+	return inMemory;
+}
+
+function <bool ()> TopN :: buildComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	// with one computation to order on, the comparator is one that the sort keys understand
+	if (orderBy.size () == 1)
+		return buildRecordComparator (lhs, rhs, orderBy[0].first, orderBy[0].second);
+
+	// otherwise, each computation is checked in turn, until one of them tells the records apart
+	vector <function <bool ()>> lessThan, greaterThan;
+	for (auto &o : orderBy) {
+		lessThan.push_back (buildRecordComparator (lhs, rhs, o.first, o.second));
+		greaterThan.push_back (buildRecordComparator (rhs, lhs, o.first, o.second));
+	}
+	return [lessThan, greaterThan] () {
+		for (size_t i = 0; i < lessThan.size (); i++) {
+			if (lessThan[i] ())
+				return true;
+			if (greaterThan[i] ())
+				return false;
+		}
+		return false;
+	};
+}
+
+bool TopN :: runInMemory (function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	// the records are keyed on the first computation; with more than one, records with the same key
+	// always have to be compared in full
+	MyDB_SortKeyPtr sortKey = make_shared <MyDB_SortKey> (input->getTable ()->getSchema (), orderBy[0].first,
+		orderBy[0].second);
+	MyDB_KeyedComparator before (orderBy.size () == 1 && sortKey->isExact (), comparator, lhs, rhs);
+
+	// a max heap, so the record at the front is the worst one kept so far
+	TopNArena arena (input->getBufferMgr (), numPages);
+	vector <MyDB_KeyedRecord> heap;
+	MyDB_RecordIteratorAltPtr iter = input->getIteratorAlt ();
+	while (iter->advance ()) {
+
+		MyDB_KeyedRecord next;
+		next.rec = iter->getCurrentPointer ();
+		next.key = sortKey->encode (next.rec);
+
+		// a record that does not beat the worst one in a full heap is not copied at all
+		if (heap.size () == limit) {
+			if (!before (next, heap.front ()))
+				continue;
+			pop_heap (heap.begin (), heap.end (), before);
+			heap.pop_back ();
+		}
+
+		next.rec = arena.copyIn (next.rec, heap);
+		if (next.rec == nullptr)
+			return false;
+		heap.push_back (next);
+		push_heap (heap.begin (), heap.end (), before);
+	}
+
+	sort_heap (heap.begin (), heap.end (), before);
+	vector <char> recs;
+	for (MyDB_KeyedRecord &rec : heap) {
+		char *bytes = (char *) rec.rec;
+		recs.insert (recs.end (), bytes, bytes + *((short *) bytes));
+	}
+	output->appendBinary (recs);
+	return true;
+}
+
+void TopN :: run () {
+
+	inMemory = false;
+	if (limit == 0 || orderBy.size () == 0)
+		return;
+
+	MyDB_RecordPtr lhs = input->getEmptyRecord ();
+	MyDB_RecordPtr rhs = input->getEmptyRecord ();
+	function <bool ()> comparator = buildComparator (lhs, rhs);
+
+	if (runInMemory (comparator, lhs, rhs)) {
+		inMemory = true;
+		return;
+	}
+
+	// the records do not fit, so sort them into runs; the runs are merged lazily, so only as much of
+	// the merge as it takes to get the first limit records is ever done
+	MyDB_RecordIteratorAltPtr iter = buildItertorOverSortedRuns (numPages, *input, comparator, lhs, rhs);
+	MyDB_RecordPtr outRec = output->getEmptyRecord ();
+	for (size_t i = 0; i < limit && iter->advance (); i++) {
+		iter->getCurrent (outRec);
+		output->append (outRec);
+	}
+}
+
+#endif
@@ -125,6 +125,25 @@ public:
 	~StringLiteral () {}
 };
 
+// a date literal, written as DATE "YYYY-MM-DD"
+class DateLiteral : public ExprTree {
+
+private:
+	string myVal;
+public:
+
+	DateLiteral (char *fromMe) {
+		fromMe[strlen (fromMe) - 1] = 0;
+		myVal = string (fromMe + 1);
+	}
+
+	string toString () {
+		return "date[" + myVal + "]";
+	}
+
+	~DateLiteral () {}
+};
+
 class Identifier : public ExprTree {
 
 private:
@@ -2,6 +2,8 @@ friend struct SFWQuery *makeQueryWithGroupBy (struct ValueList *selectClause, st
 	struct CNF *cnf, struct ValueList *grouping);
 friend struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fromClause, struct CNF *cnf);
 friend struct SFWQuery *makeQueryNoWhere (struct ValueList *selectClause, struct FromList *fromClause);
+friend struct SFWQuery *addOrderBy (struct SFWQuery *toMe, struct OrderList *orderBy);
+friend struct SFWQuery *addLimit (struct SFWQuery *toMe, int limit);
 friend struct SQLStatement *makeSelectQuery (struct SFWQuery *fromMe);
 friend struct SQLStatement *makeCreateTable (struct CreateTable *fromMe);
 friend struct CreateTable *makeTableRegular (char *tableName, struct AttList *fromMe);
@@ -29,5 +31,7 @@ friend struct Value *makeInt (int fromMe);
 friend struct Value *makeString (char *fromMe);
 friend struct ValueList *pushBackValue (struct ValueList *addToMe, struct Value *addMe);
 friend struct ValueList *makeValueList (struct Value *addMe);
+friend struct OrderList *pushBackOrdering (struct OrderList *addToMe, struct Value *addMe, int descending);
+friend struct OrderList *makeOrderList (struct Value *addMe, int descending);
 friend struct CNF *makeCNF (struct Value *fromMe);
 friend struct CNF *pushBackDisjunction (struct CNF *ontoMe, struct Value *pushMe);
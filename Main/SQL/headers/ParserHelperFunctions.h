@@ -22,6 +22,9 @@ struct Value;
 // in a GROUP BY or a SELECT clause
 struct ValueList;
 
+// an "OrderList" is a list of values, each ascending or descending... used to hold an ORDER BY clause
+struct OrderList;
+
 // a "CNF" is a list of boolean clauses
 struct CNF;
 
@@ -50,6 +53,10 @@ struct SFWQuery *makeQueryWithGroupBy (struct ValueList *selectClause, struct Fr
 struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fromClause, struct CNF *cnf);
 struct SFWQuery *makeQueryNoWhere (struct ValueList *selectClause, struct FromList *fromClause);
 
+// add an ORDER BY clause or a LIMIT to a select query
+struct SFWQuery *addOrderBy (struct SFWQuery *toMe, struct OrderList *orderBy);
+struct SFWQuery *addLimit (struct SFWQuery *toMe, int limit);
+
 // builds an SQL statement out of a select query
 struct SQLStatement *makeSelectQuery (struct SFWQuery *fromMe);
 
@@ -65,6 +72,9 @@ struct CreateTable *makeTableBPlusTree (char *tableName, struct AttList *fromMe,
 // makes an attribute list out of a single attribute
 struct AttList *makeAttList (char *attName, int whichType);
 
+// makes an attribute list out of a single DECIMAL (precision, scale) attribute
+struct AttList *makeDecimalAttList (char *attName, int precision, int scale);
+
 // makes a from list
 struct FromList *makeFromList (char *tableName, char *aliasName);
 
@@ -102,6 +112,7 @@ struct Value *makeIdentifier (char *tableName, char *attName);
 struct Value *makeDouble (double fromMe);
 struct Value *makeInt (int fromMe);
 struct Value *makeString (char *fromMe);
+struct Value *makeDate (char *fromMe);
 
 // this adds a new value to a value list
 struct ValueList *pushBackValue (struct ValueList *addToMe, struct Value *addMe);
@@ -109,6 +120,12 @@ struct ValueList *pushBackValue (struct ValueList *addToMe, struct Value *addMe)
 // makes a new value list from a value
 struct ValueList *makeValueList (struct Value *addMe);
 
+// this adds a new value, ascending or descending, to an order list
+struct OrderList *pushBackOrdering (struct OrderList *addToMe, struct Value *addMe, int descending);
+
+// makes a new order list from a value, ascending or descending
+struct OrderList *makeOrderList (struct Value *addMe, int descending);
+
 // makes a new CNF from a expression (hopefully a boolean!!)
 struct CNF *makeCNF (struct Value *fromMe);
 
@@ -40,6 +40,7 @@ public:
 	
 	friend struct CNF;
 	friend struct ValueList;
+	friend struct OrderList;
 	friend struct SFWQuery;
 	#include "FriendDecls.h"
 };
@@ -86,6 +87,26 @@ public:
 	#include "FriendDecls.h"
 };
 
+// structure that encapsulates a parsed ORDER BY clause
+struct OrderList {
+
+private:
+
+        // the expression trees to order on, each with true if the order is descending
+        vector <pair <ExprTreePtr, bool>> orderings;
+
+public:
+        ~OrderList () {}
+
+        OrderList (struct Value *useMe, bool descending) {
+              	orderings.push_back (make_pair (useMe->myVal, descending)); 
+        }
+
+        OrderList () {}
+
+	friend struct SFWQuery;
+	#include "FriendDecls.h"
+};
 
 // structure to encapsulate a create table
 struct CreateTable {
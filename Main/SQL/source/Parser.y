@@ -18,6 +18,7 @@
 	struct AttList *myAttList;
 	struct Value *myValue;
 	struct ValueList *allValues;
+	struct OrderList *myOrderList;
 	struct CNF *myCNF;	
 	int myInt;
 	char *myChar;
@@ -44,8 +45,14 @@
 %token SUM
 %token AVG
 %token GROUP
+%token ORDER
+%token LIMIT
+%token ASC
+%token DESC
 %token INT
 %token BOOL
+%token DATE
+%token DECIMAL
 %token BPLUSTREE
 %token CREATE
 %token DOUBLE
@@ -66,6 +73,9 @@
 %type <myAttList> Att
 %type <myFromList> FromList
 %type <mySelectQuery> SelectQuery 
+%type <mySelectQuery> SelectBody
+%type <myOrderList> OrderList
+%type <myInt> Direction
 
 %start SQLStatement
 
@@ -135,9 +145,40 @@ Att : IDENTIFIER INT
 	$$ = makeAttList ($1, BOOL);
 }
 
+| IDENTIFIER DATE
+{
+	$$ = makeAttList ($1, DATE);
+}
+
+| IDENTIFIER DECIMAL '(' INTEGER ',' INTEGER ')'
+{
+	$$ = makeDecimalAttList ($1, $4, $6);
+}
+
 //********* SELECT-FROM-WHERE Query
 
-SelectQuery: SELECT ValueList
+SelectQuery: SelectBody
+{
+	$$ = $1;
+}
+
+| SelectBody ORDER BY OrderList
+{
+	$$ = addOrderBy ($1, $4);
+}
+
+| SelectBody ORDER BY OrderList LIMIT INTEGER
+{
+	$$ = addLimit (addOrderBy ($1, $4), $6);
+}
+
+| SelectBody LIMIT INTEGER
+{
+	$$ = addLimit ($1, $3);
+}
+;
+
+SelectBody: SELECT ValueList
              FROM FromList
 	     WHERE CNF
 	     GROUP BY ValueList
@@ -159,6 +200,33 @@ SelectQuery: SELECT ValueList
 }
 ;
 
+OrderList: OrderList ',' Value Direction
+{
+	$$ = pushBackOrdering ($1, $3, $4);
+}
+
+| Value Direction
+{
+	$$ = makeOrderList ($1, $2);
+}
+;
+
+Direction: ASC
+{
+	$$ = 0;
+}
+
+| DESC
+{
+	$$ = 1;
+}
+
+| /* empty */
+{
+	$$ = 0;
+}
+;
+
 FromList: IDENTIFIER AS IDENTIFIER ',' FromList
 {
 	$$ = appendFromList ($5, $1, $3);
@@ -295,6 +363,11 @@ Literal: IDENTIFIER '.' IDENTIFIER
 	$$ = makeString ($1);	
 }
 
+| DATE STR 
+{
+	$$ = makeDate ($2);	
+}
+
 | INTEGER
 {
 	$$ = makeInt ($1);
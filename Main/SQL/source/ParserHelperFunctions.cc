@@ -37,11 +37,17 @@ struct AttList *makeAttList (char *attName, int whichType) {
 		return new AttList (string (attName), make_shared <MyDB_IntAttType> ());
 	} else if (whichType == STRING) {
 		return new AttList (string (attName), make_shared <MyDB_StringAttType> ());
+	} else if (whichType == DATE) {
+		return new AttList (string (attName), make_shared <MyDB_DateAttType> ());
 	} else {
 		return nullptr;
 	}
 }
 
+struct AttList *makeDecimalAttList (char *attName, int precision, int scale) {
+	return new AttList (string (attName), make_shared <MyDB_DecimalAttType> (precision, scale));
+}
+
 struct FromList *appendFromList (struct FromList *appendToMe, char *tableName, char *aliasName) {
 	appendToMe->aliases.push_back (make_pair (string (tableName), string (aliasName)));
 	free (tableName);
@@ -67,6 +73,18 @@ struct ValueList *pushBackValue (struct ValueList *ontoMe, struct Value *withMe)
 	return ontoMe;
 }
 
+struct OrderList *makeOrderList (struct Value *fromMe, int descending) {
+	auto returnVal = new OrderList (fromMe, descending != 0);
+	delete fromMe;
+	return returnVal;
+}
+
+struct OrderList *pushBackOrdering (struct OrderList *ontoMe, struct Value *withMe, int descending) {
+	ontoMe->orderings.push_back (make_pair (withMe->myVal, descending != 0));
+	delete withMe;
+	return ontoMe;
+}
+
 struct CNF *pushBackDisjunction (struct CNF *ontoMe, struct Value *withMe) {
 	ontoMe->disjunctions.push_back (withMe->myVal);
 	delete withMe;
@@ -114,6 +132,11 @@ struct Value *makeString (char *fromMe) {
 	return returnVal;
 }
 
+struct Value *makeDate (char *fromMe) {
+	Value *returnVal = new Value (make_shared <DateLiteral> (fromMe));
+	return returnVal;
+}
+
 struct Value *makeInt (int fromMe) {
 	Value *returnVal = new Value (make_shared <IntLiteral> (fromMe));
 	return returnVal;
@@ -207,6 +230,17 @@ struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fro
 	return returnVal;
 }
 
+struct SFWQuery *addOrderBy (struct SFWQuery *toMe, struct OrderList *orderBy) {
+	toMe->addOrderBy (orderBy);
+	delete orderBy;
+	return toMe;
+}
+
+struct SFWQuery *addLimit (struct SFWQuery *toMe, int limit) {
+	toMe->addLimit (limit);
+	return toMe;
+}
+
 struct CreateTable *makeTableRegular (char *tableName, struct AttList *fromMe) {
 	auto returnVal = new CreateTable (string (tableName), fromMe->atts);
 	free (tableName);
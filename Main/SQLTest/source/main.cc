@@ -5,6 +5,7 @@
 #include "MyDB_BufferManager.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_BEpsilonTreeReaderWriter.h"
 #include <string>      
 #include <iostream>   
 #include <sstream>
@@ -48,6 +49,9 @@ int main (int numArgs, char **args) {
 		} else if (a.second->getFileType () == "bplustree") {
 			allBPlusReaderWriters[a.first] = make_shared <MyDB_BPlusTreeReaderWriter> (a.second->getSortAtt (), a.second, myMgr);
 			allTableReaderWriters[a.first] = allBPlusReaderWriters[a.first];	
+		} else if (a.second->getFileType () == "bepsilontree") {
+			allBPlusReaderWriters[a.first] = make_shared <MyDB_BEpsilonTreeReaderWriter> (a.second->getSortAtt (), a.second, myMgr);
+			allTableReaderWriters[a.first] = allBPlusReaderWriters[a.first];	
 		}
 	}
 
@@ -101,7 +105,7 @@ int main (int numArgs, char **args) {
 						cout << "OK, loading " << tokens[1] << " from text file.\n";
 
 						// load up the file
-						pair <vector <size_t>, size_t> res = allTableReaderWriters[tokens[1]]->loadFromTextFile (tokens[3]);
+						pair <vector <MyDB_HyperLogLog>, size_t> res = allTableReaderWriters[tokens[1]]->loadFromTextFile (tokens[3]);
 
 						// and record the tuple various counts
 						allTableReaderWriters[tokens[1]]->getTable ()->setDistinctValues (res.first);